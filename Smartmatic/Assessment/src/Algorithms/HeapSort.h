@@ -16,6 +16,7 @@
 #ifndef HEAP_SORT_H
 #define HEAP_SORT_H
 
+#include <utility>
 #include <vector>
 
 
@@ -72,9 +73,9 @@ namespace Algorithms
         /// <param name="r">The right.</param>
         static void SiftDown(std::vector<T> &data, int l, int r)
         {
-            T   a    = data[l];
+            T   a    = std::move(data[l]);
             int jOld = l;
-            int j    = l + 1;
+            int j    = 2*l + 1;
 
             while (j <= r)
             {
@@ -88,13 +89,13 @@ namespace Algorithms
                     break;
                 }
 
-                data[jOld] = data[j];
+                data[jOld] = std::move(data[j]);
                 jOld       = j;
                 j          = 2*j + 1;
             }
 
             // Put "a" into it's slot.
-            data[jOld] = a;
+            data[jOld] = std::move(a);
         }
     };
 }
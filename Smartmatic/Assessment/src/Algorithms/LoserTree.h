@@ -0,0 +1,125 @@
+// =============================================================================================================================================
+// <copyright file="LoserTree.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: LoserTree.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 9:40 PM
+//  Purpose: A tournament (loser) tree, for k-way merging of sorted sequences.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef LOSER_TREE_H
+#define LOSER_TREE_H
+
+#include <utility>
+#include <vector>
+
+
+namespace Algorithms
+{
+    /// <summary>A tournament tree of losers, which picks the smallest head of k sorted sequences.</summary>
+    /// <remarks>
+    ///     Every internal node holds the loser of the match played there; the overall winner is kept on its own.  When the
+    ///     winner's sequence moves on to its next key, only the matches on the path from that leaf up to the root are
+    ///     replayed: log2(k) comparisons per key, against a heap's 2*log2(k), and no sibling ever has to be looked at.
+    ///     Keys are referred to, not copied: the caller keeps each sequence's head alive until it replaces it.  An exhausted
+    ///     sequence (nullptr) loses to everything.  Equal keys go to the lower sequence first, so the merge is stable.
+    /// </remarks>
+    template <typename T> class LoserTree
+    {
+    private:
+        std::vector<const T *> _keys;     // The head of each sequence; nullptr once exhausted.
+        std::vector<int>       _losers;   // Internal nodes 1..k-1, heap layout; leaf i is node k+i.
+        int                    _winner;
+
+    public:
+
+        /// <summary>Initializes a new instance of the <see cref="LoserTree"/> class, and plays the first tournament.</summary>
+        /// <param name="keys">The head of each sequence; nullptr for an empty one.</param>
+        explicit LoserTree(std::vector<const T *> keys)
+            : _keys(std::move(keys)),
+              _losers(_keys.size(), -1),
+              _winner(-1)
+        {
+            const auto k = static_cast<int>(_keys.size());
+            if (k == 0) {
+                return;
+            }
+
+            std::vector<int> winners(2 * k);
+            for (auto i = 0; i < k; ++i) {
+                winners[k + i] = i;
+            }
+
+            for (auto node = k - 1; node >= 1; --node)
+            {
+                const int left  = winners[2 * node];
+                const int right = winners[2 * node + 1];
+                const bool rightWins = Less(right, left);
+
+                winners[node] = rightWins ? right : left;
+                _losers[node] = rightWins ? left : right;
+            }
+
+            _winner = (k == 1) ? 0 : winners[1];
+        }
+
+
+        /// <summary>The sequence holding the smallest head; -1 when every sequence is exhausted.</summary>
+        int Winner() const
+        {
+            return ((_winner < 0) || (nullptr == _keys[_winner])) ? -1 : _winner;
+        }
+
+
+        /// <summary>The smallest head; nullptr when every sequence is exhausted.</summary>
+        const T *WinnerKey() const
+        {
+            return (_winner < 0) ? nullptr : _keys[_winner];
+        }
+
+
+        /// <summary>Moves the winning sequence on to its next key, and replays its matches.</summary>
+        /// <param name="key">The next key of the winning sequence; nullptr if it is exhausted.</param>
+        void ReplaceWinner(const T *key)
+        {
+            const auto k = static_cast<int>(_keys.size());
+
+            int winner = _winner;
+            _keys[winner] = key;
+            for (auto node = (k + winner) / 2; node >= 1; node /= 2)
+            {
+                if (Less(_losers[node], winner)) {
+                    std::swap(_losers[node], winner);
+                }
+            }
+
+            _winner = winner;
+        }
+
+    private:
+
+        /// <summary>Whether sequence a's head goes before sequence b's.</summary>
+        bool Less(const int a, const int b) const
+        {
+            const T *keyA = _keys[a];
+            const T *keyB = _keys[b];
+            if (nullptr == keyA) {
+                return false;
+            }
+
+            if (nullptr == keyB) {
+                return true;
+            }
+
+            return (*keyA < *keyB) || (!(*keyB < *keyA) && (a < b));
+        }
+    };
+}
+
+#endif  // LOSER_TREE_H
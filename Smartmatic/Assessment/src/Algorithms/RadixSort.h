@@ -0,0 +1,145 @@
+// =============================================================================================================================================
+// <copyright file="RadixSort.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: RadixSort.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 9:15 PM
+//  Purpose: The LSD radix sort algorithm.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+
+namespace Algorithms
+{
+    /// <summary>The LSD (least significant digit first) radix sort.</summary>
+    /// <remarks>
+    ///     Not a comparison sort: it distributes integers by one byte ("digit") at a time, from the least significant
+    ///     byte up, each pass stable.  It is an N*sizeof(T) process, for any order of the input data, at the cost of an
+    ///     auxiliary array as large as the data.  Only the digits up to the largest key's top byte are sorted on, so small
+    ///     numbers in a 64-bit type take only as many passes as they have bytes; and a pass in which every key has the
+    ///     same digit moves nothing, and is skipped.
+    ///     The counting passes have a fixed cost, which a few dozen keys do not pay back: short data is insertion sorted.
+    /// </remarks>
+    template <typename T> class RadixSort
+    {
+        static_assert(std::is_integral<T>::value, "RadixSort sorts integers.");
+
+    public:
+        static const int    RADIX            = 256;
+        static const size_t INSERTION_CUTOFF = 32;
+
+        /// <summary>Sorts the specified data.</summary>
+        /// <param name="data">The data.</param>
+        /// <remarks>
+        ///     Sorts a vector into ascending numerical order.
+        ///     <paramref name="data" /> is replaced on output by its sorted rearrangement.
+        /// </remarks>
+        static void Sort(std::vector<T> &data)
+        {
+            const size_t n = data.size();
+            if (n <= INSERTION_CUTOFF)
+            {
+                InsertionSort(data);
+                return;
+            }
+
+            // The positions above the largest key's top byte are all zero.
+            key_t largest = 0;
+            for (const auto value : data) {
+                largest = std::max(largest, Key(value));
+            }
+
+            size_t positions = 1;
+            while ((positions < sizeof(T)) && ((largest >> (positions * 8)) != 0)) {
+                ++positions;
+            }
+
+            // One pass over the data counts the digits of every position at once.
+            size_t counts[sizeof(T)][RADIX];
+            std::fill(&counts[0][0], &counts[0][0] + positions * RADIX, size_t(0));
+            for (const auto value : data)
+            {
+                const key_t key = Key(value);
+                for (size_t position = 0; position < positions; ++position) {
+                    ++counts[position][Digit(key, position)];
+                }
+            }
+
+            std::vector<T> buffer(n);
+            T *from = data.data();
+            T *to   = buffer.data();
+            for (size_t position = 0; position < positions; ++position)
+            {
+                size_t *count = counts[position];
+                if (count[Digit(Key(from[0]), position)] == n) {
+                    continue;
+                }
+
+                // Counts become the starting offsets of their digits.
+                size_t offset = 0;
+                for (auto digit = 0; digit < RADIX; ++digit)
+                {
+                    const size_t digitCount = count[digit];
+                    count[digit] = offset;
+                    offset      += digitCount;
+                }
+
+                for (size_t i = 0; i < n; ++i) {
+                    to[count[Digit(Key(from[i]), position)]++] = from[i];
+                }
+
+                std::swap(from, to);
+            }
+
+            if (from != data.data()) {
+                std::copy(from, from + n, data.data());
+            }
+        }
+
+    private:
+        using key_t = typename std::make_unsigned<T>::type;
+
+        /// <summary>Straight insertion, for short data.</summary>
+        static void InsertionSort(std::vector<T> &data)
+        {
+            const size_t n = data.size();
+            for (size_t i = 1; i < n; ++i)
+            {
+                const T value = data[i];
+                size_t  j     = i;
+                for (; (j > 0) && (value < data[j - 1]); --j) {
+                    data[j] = data[j - 1];
+                }
+
+                data[j] = value;
+            }
+        }
+
+        /// <summary>The unsigned key of a value: signed values have their sign bit flipped, so that negatives come first.</summary>
+        static key_t Key(const T value)
+        {
+            const key_t signBit = std::is_signed<T>::value ? static_cast<key_t>(key_t(1) << (sizeof(T) * 8 - 1)) : key_t(0);
+            return static_cast<key_t>(static_cast<key_t>(value) ^ signBit);
+        }
+
+        /// <summary>The digit (byte) of a key at a position, from the least significant one up.</summary>
+        static size_t Digit(const key_t key, const size_t position)
+        {
+            return static_cast<size_t>((key >> (position * 8)) & 0xFF);
+        }
+    };
+}
+
+#endif  // RADIX_SORT_H
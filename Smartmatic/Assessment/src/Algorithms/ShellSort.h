@@ -16,6 +16,7 @@
 #ifndef SHELL_SORT_H
 #define SHELL_SORT_H
 
+#include <utility>
 #include <vector>
 
 
@@ -75,20 +76,20 @@ namespace Algorithms
                 // Outer loop of straight insertion.
                 for (auto i = inc; i < m; ++i)
                 {
-                    T   v = data[i];
+                    T   v = std::move(data[i]);
                     int j = i;
 
                     // Inner loop of straight insertion.
                     while (data[j - inc] > v)
                     {
-                        data[j] = data[j - inc];
+                        data[j] = std::move(data[j - inc]);
                         j -= inc;
                         if (j < inc) {
                             break;
                         }
                     }
 
-                    data[j] = v;
+                    data[j] = std::move(v);
                 }
             }
             while (inc > 1);
@@ -31,6 +31,32 @@ namespace Algorithms
             return ShellSortAlgorithm;
         }
 
+        if (algorithmName == "RadixSort") {
+            return RadixSortAlgorithm;
+        }
+
         return None;
     }
+
+
+    /// <summary>The name of a sort algorithm, as <see cref="ToSortAlgorithm"/> takes it.</summary>
+    /// <param name="sortAlgorithm">The sort algorithm.</param>
+    /// <returns>The name; empty for None.</returns>
+    std::string ToSortAlgorithmName(const SortAlgorithm sortAlgorithm)
+    {
+        switch (sortAlgorithm)
+        {
+        case HeapSortAlgorithm:
+            return "HeapSort";
+
+        case ShellSortAlgorithm:
+            return "ShellSort";
+
+        case RadixSortAlgorithm:
+            return "RadixSort";
+
+        default:
+            return std::string();
+        }
+    }
 }
@@ -42,7 +42,14 @@ namespace Algorithms
         ///     ordered data, the operations count goes approximately as N^(1.25), at least for N < 60000.
         ///     For N > 50, however, QuickSort is generally faster (and a significantly larger implementation).
         /// </remarks>
-        ShellSortAlgorithm
+        ShellSortAlgorithm,
+
+        /// <summary>The LSD radix sort algorithm.</summary>
+        /// <remarks>
+        ///     Not a comparison sort: integers are distributed by one byte at a time, least significant first.
+        ///     An N*sizeof(T) process for any order of the input data; meant for the 64-bit numbers of token mode.
+        /// </remarks>
+        RadixSortAlgorithm
     };
 
 
@@ -50,7 +57,7 @@ namespace Algorithms
     /// <returns></returns>
     inline std::string SupportedSortAlgorithms()
     {
-        return "HeapSort | ShellSort";
+        return "HeapSort | ShellSort | RadixSort";
     }
 
 
@@ -58,6 +65,11 @@ namespace Algorithms
     /// <param name="algorithmName">The algorithm to use.</param>
     /// <returns>a supported sort algorithm</returns>
     SortAlgorithm ToSortAlgorithm(const std::string &algorithmName);
+
+    /// <summary>The name of a sort algorithm, as <see cref="ToSortAlgorithm"/> takes it.</summary>
+    /// <param name="sortAlgorithm">The sort algorithm.</param>
+    /// <returns>The name; empty for None.</returns>
+    std::string ToSortAlgorithmName(SortAlgorithm sortAlgorithm);
 }
 
 #endif // _SORT_ALGORITHM_H
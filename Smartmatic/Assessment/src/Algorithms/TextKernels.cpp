@@ -0,0 +1,551 @@
+// =============================================================================================================================================
+// <copyright file="TextKernels.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: TextKernels.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 8:40 PM
+//  Purpose: Vectorized (SSE2, AVX2) kernels for filtering the whitespace out of items and formatting the sorted result.
+// </summary>
+// =============================================================================================================================================
+
+#include "TextKernels.h"
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  define TEXT_KERNELS_SSE2
+#  include <emmintrin.h>
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define AVX2_TARGET
+#  else
+#    define AVX2_TARGET __attribute__((target("avx2")))
+#  endif
+#endif
+
+
+namespace Algorithms
+{
+    /// <summary>Whitespace, as isspace() in the "C" locale: space, and '\t' through '\r'.</summary>
+    static inline bool IsWhitespace(const char c)
+    {
+        return (c == ' ') || (static_cast<unsigned char>(c - '\t') < 5);
+    }
+
+
+    /// <summary>Scalar <see cref="CompactWhitespace"/>.</summary>
+    static size_t CompactWhitespaceScalar(const char *input, const size_t length, char *output, size_t &whitespaceCount)
+    {
+        size_t written = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            // Branch-free: always store, only advance past what is kept.
+            const bool isWhitespace = IsWhitespace(input[i]);
+            output[written]  = input[i];
+            written         += isWhitespace ? 0 : 1;
+            whitespaceCount += isWhitespace ? 1 : 0;
+        }
+
+        return written;
+    }
+
+
+    /// <summary>Scalar <see cref="CountBytes"/>.</summary>
+    static void CountBytesScalar(const char *input, const size_t length, uint64_t *histogram)
+    {
+        for (size_t i = 0; i < length; ++i) {
+            ++histogram[static_cast<unsigned char>(input[i])];
+        }
+    }
+
+
+    /// <summary>Scalar <see cref="FormatItem"/>, less the line end: "a,b,c,".</summary>
+    static void InterleaveCommasScalar(const char *input, const size_t length, char *output)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            output[2 * i]     = input[i];
+            output[2 * i + 1] = ',';
+        }
+    }
+
+
+#ifdef TEXT_KERNELS_SSE2
+
+    // Every space costs the worker a second of sleep, so a block with whitespace in it is not worth a shuffle table:
+    // only whitespace-free blocks (the common case) are copied a vector at a time, the rest goes the scalar way.
+
+    /// <summary>The whitespace bytes of a vector, as a bit mask.</summary>
+    static inline int WhitespaceMask(const __m128i bytes)
+    {
+        // '\t' through '\r' is (byte - '\t') <= 4, unsigned; SSE2 has no unsigned compare, but it has an unsigned max.
+        const __m128i four     = _mm_set1_epi8(4);
+        const __m128i controls = _mm_cmpeq_epi8(_mm_max_epu8(_mm_sub_epi8(bytes, _mm_set1_epi8('\t')), four), four);
+        const __m128i spaces   = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+        return _mm_movemask_epi8(_mm_or_si128(controls, spaces));
+    }
+
+
+    /// <summary>SSE2 <see cref="CompactWhitespace"/>.</summary>
+    static size_t CompactWhitespaceSse2(const char *input, const size_t length, char *output, size_t &whitespaceCount)
+    {
+        size_t i       = 0;
+        size_t written = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+            if (WhitespaceMask(bytes) == 0)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(output + written), bytes);
+                written += 16;
+            }
+            else {
+                written += CompactWhitespaceScalar(input + i, 16, output + written, whitespaceCount);
+            }
+        }
+
+        return written + CompactWhitespaceScalar(input + i, length - i, output + written, whitespaceCount);
+    }
+
+
+    /// <summary>SSE2 <see cref="FormatItem"/>, less the line end.</summary>
+    static void InterleaveCommasSse2(const char *input, const size_t length, char *output)
+    {
+        const __m128i commas = _mm_set1_epi8(',');
+
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 2 * i),      _mm_unpacklo_epi8(bytes, commas));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 2 * i + 16), _mm_unpackhi_epi8(bytes, commas));
+        }
+
+        InterleaveCommasScalar(input + i, length - i, output + 2 * i);
+    }
+
+
+    // Items are numeric strings: an all-digit block is counted a vector at a time, with one byte-wide counter per digit
+    // and lane, which are summed into the histogram (psadbw) before they can overflow.  Other blocks go the scalar way.
+    // With SSE2 this measured no faster than the scalar loop (ten compares per 16 bytes); only AVX2 pays off.
+    static const size_t MAX_COUNTED_BLOCKS = 255;
+
+
+    /// <summary>Adds the per-digit byte counters to the histogram, and clears them.</summary>
+    AVX2_TARGET static inline void FlushDigitCountersAvx2(__m256i *counters, uint64_t *histogram)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        for (auto d = 0; d < 10; ++d)
+        {
+            const __m256i sums = _mm256_sad_epu8(counters[d], zero);
+            const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+            histogram['0' + d] += static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_add_epi64(half, _mm_srli_si128(half, 8))));
+            counters[d] = zero;
+        }
+    }
+
+
+    /// <summary>AVX2 <see cref="CountBytes"/>.</summary>
+    AVX2_TARGET static void CountBytesAvx2(const char *input, const size_t length, uint64_t *histogram)
+    {
+        const __m256i nine  = _mm256_set1_epi8(9);
+        const __m256i digit = _mm256_set1_epi8('0');
+
+        __m256i counters[10];
+        for (auto d = 0; d < 10; ++d) {
+            counters[d] = _mm256_setzero_si256();
+        }
+
+        size_t blocks = 0;
+
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32)
+        {
+            const __m256i bytes  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+            const __m256i values = _mm256_sub_epi8(bytes, digit);
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(values, nine), nine)) != -1)
+            {
+                CountBytesScalar(input + i, 32, histogram);
+                continue;
+            }
+
+            for (auto d = 0; d < 10; ++d) {
+                counters[d] = _mm256_sub_epi8(counters[d], _mm256_cmpeq_epi8(values, _mm256_set1_epi8(static_cast<char>(d))));
+            }
+
+            if (++blocks == MAX_COUNTED_BLOCKS)
+            {
+                FlushDigitCountersAvx2(counters, histogram);
+                blocks = 0;
+            }
+        }
+
+        if (blocks > 0) {
+            FlushDigitCountersAvx2(counters, histogram);
+        }
+
+        CountBytesScalar(input + i, length - i, histogram);
+    }
+
+
+    /// <summary>AVX2 <see cref="CompactWhitespace"/>.</summary>
+    AVX2_TARGET static size_t CompactWhitespaceAvx2(const char *input, const size_t length, char *output, size_t &whitespaceCount)
+    {
+        const __m256i four  = _mm256_set1_epi8(4);
+        const __m256i tab   = _mm256_set1_epi8('\t');
+        const __m256i space = _mm256_set1_epi8(' ');
+
+        size_t i       = 0;
+        size_t written = 0;
+        for (; i + 32 <= length; i += 32)
+        {
+            const __m256i bytes    = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+            const __m256i controls = _mm256_cmpeq_epi8(_mm256_max_epu8(_mm256_sub_epi8(bytes, tab), four), four);
+            const __m256i spaces   = _mm256_cmpeq_epi8(bytes, space);
+            if (_mm256_movemask_epi8(_mm256_or_si256(controls, spaces)) == 0)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + written), bytes);
+                written += 32;
+            }
+            else {
+                written += CompactWhitespaceScalar(input + i, 32, output + written, whitespaceCount);
+            }
+        }
+
+        return written + CompactWhitespaceSse2(input + i, length - i, output + written, whitespaceCount);
+    }
+
+
+    /// <summary>AVX2 <see cref="FormatItem"/>, less the line end.</summary>
+    AVX2_TARGET static void InterleaveCommasAvx2(const char *input, const size_t length, char *output)
+    {
+        const __m256i commas = _mm256_set1_epi8(',');
+
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32)
+        {
+            // The unpacks work within 128-bit lanes: low = [a0-a7 | a16-a23], high = [a8-a15 | a24-a31], each with commas.
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+            const __m256i low   = _mm256_unpacklo_epi8(bytes, commas);
+            const __m256i high  = _mm256_unpackhi_epi8(bytes, commas);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + 2 * i),      _mm256_permute2x128_si256(low, high, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + 2 * i + 32), _mm256_permute2x128_si256(low, high, 0x31));
+        }
+
+        InterleaveCommasSse2(input + i, length - i, output + 2 * i);
+    }
+
+
+    /// <summary>Whether this processor, and its operating system, support AVX2.</summary>
+    static bool HasAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+
+        // OSXSAVE and AVX, and the operating system saving the YMM registers; then AVX2 itself.
+        __cpuid(info, 1);
+        if (((info[2] & (1 << 27)) == 0) || ((info[2] & (1 << 28)) == 0) || ((_xgetbv(0) & 6) != 6)) {
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+
+#endif
+
+
+    /// <summary>The best kernel set this processor (and build) has.</summary>
+    TextKernelSet BestTextKernelSet()
+    {
+#ifdef TEXT_KERNELS_SSE2
+        static const TextKernelSet best = HasAvx2() ? Avx2Kernels : Sse2Kernels;
+        return best;
+#else
+        return ScalarKernels;
+#endif
+    }
+
+
+    /// <summary>The kernel set in use.</summary>
+    static std::atomic<int> &ActiveKernels()
+    {
+        static std::atomic<int> active(BestTextKernelSet());
+        return active;
+    }
+
+
+    /// <summary>The kernel set in use; process-wide.</summary>
+    TextKernelSet ActiveTextKernelSet()
+    {
+        return static_cast<TextKernelSet>(ActiveKernels().load(std::memory_order_relaxed));
+    }
+
+
+    /// <summary>Switches every following kernel call, process-wide, to a kernel set.</summary>
+    /// <param name="kernelSet">The kernel set.</param>
+    /// <returns>false if this processor lacks the kernel set.</returns>
+    bool SelectTextKernelSet(const TextKernelSet kernelSet)
+    {
+        if (kernelSet > BestTextKernelSet()) {
+            return false;
+        }
+
+        ActiveKernels() = kernelSet;
+        return true;
+    }
+
+
+    /// <summary>Translate the string to a kernel set; "auto" is the best one this processor has.</summary>
+    /// <param name="kernelSetName">The kernel set name.</param>
+    /// <param name="kernelSet">The kernel set, when recognized.</param>
+    /// <returns>true / false - depending upon success.</returns>
+    bool ToTextKernelSet(const std::string &kernelSetName, TextKernelSet &kernelSet)
+    {
+        if (kernelSetName == "auto") {
+            kernelSet = BestTextKernelSet();
+            return true;
+        }
+
+        if (kernelSetName == "scalar") {
+            kernelSet = ScalarKernels;
+            return true;
+        }
+
+        if (kernelSetName == "sse2") {
+            kernelSet = Sse2Kernels;
+            return true;
+        }
+
+        if (kernelSetName == "avx2") {
+            kernelSet = Avx2Kernels;
+            return true;
+        }
+
+        return false;
+    }
+
+
+    /// <summary>Copies an item without its whitespace (as isspace() in the "C" locale), counting what it dropped.</summary>
+    /// <param name="input">The item.</param>
+    /// <param name="length">The item length.</param>
+    /// <param name="output">The filtered item; room for <paramref name="length" /> characters.  May not overlap the item.</param>
+    /// <param name="whitespaceCount">Incremented by the number of whitespace characters dropped.</param>
+    /// <returns>The filtered item length.</returns>
+    size_t CompactWhitespace(const char *input, const size_t length, char *output, size_t &whitespaceCount)
+    {
+        switch (ActiveTextKernelSet())
+        {
+#ifdef TEXT_KERNELS_SSE2
+        case Avx2Kernels:
+            return CompactWhitespaceAvx2(input, length, output, whitespaceCount);
+
+        case Sse2Kernels:
+            return CompactWhitespaceSse2(input, length, output, whitespaceCount);
+#endif
+
+        default:
+            return CompactWhitespaceScalar(input, length, output, whitespaceCount);
+        }
+    }
+
+
+    /// <summary>Counts the whitespace (as isspace() in the "C" locale) of an item; what <see cref="CompactWhitespace"/> would drop.</summary>
+    /// <remarks>Scalar only: it runs once per line, on the reader thread, well ahead of the work.</remarks>
+    /// <param name="input">The item.</param>
+    /// <param name="length">The item length.</param>
+    /// <returns>The whitespace count.</returns>
+    size_t CountWhitespace(const char *input, const size_t length)
+    {
+        size_t whitespaceCount = 0;
+        for (size_t i = 0; i < length; ++i) {
+            whitespaceCount += IsWhitespace(input[i]) ? 1 : 0;
+        }
+
+        return whitespaceCount;
+    }
+
+
+    /// <summary>Aggregate mode: adds the bytes of an item to a 256-bin histogram, indexed by unsigned byte value.</summary>
+    /// <param name="input">The item.</param>
+    /// <param name="length">The item length.</param>
+    /// <param name="histogram">The histogram; 256 bins.</param>
+    void CountBytes(const char *input, const size_t length, uint64_t *histogram)
+    {
+        switch (ActiveTextKernelSet())
+        {
+#ifdef TEXT_KERNELS_SSE2
+        case Avx2Kernels:
+            CountBytesAvx2(input, length, histogram);
+            break;
+#endif
+
+        default:
+            CountBytesScalar(input, length, histogram);
+        }
+    }
+
+
+    /// <summary>Formats a sorted item as its characters separated by commas, with a line end: "a,b,c\n".</summary>
+    /// <param name="input">The sorted item.</param>
+    /// <param name="length">The item length.</param>
+    /// <param name="output">The formatted item; room for <see cref="FormattedItemLength"/> characters.</param>
+    /// <returns>The formatted item length.</returns>
+    size_t FormatItem(const char *input, const size_t length, char *output)
+    {
+        if (length == 0)
+        {
+            output[0] = '\n';
+            return 1;
+        }
+
+        // "x," pairs, and the last comma becomes the line end.
+        switch (ActiveTextKernelSet())
+        {
+#ifdef TEXT_KERNELS_SSE2
+        case Avx2Kernels:
+            InterleaveCommasAvx2(input, length, output);
+            break;
+
+        case Sse2Kernels:
+            InterleaveCommasSse2(input, length, output);
+            break;
+#endif
+
+        default:
+            InterleaveCommasScalar(input, length, output);
+        }
+
+        output[2 * length - 1] = '\n';
+        return 2 * length;
+    }
+
+
+#if !defined(__BYTE_ORDER__) || (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#  define TEXT_KERNELS_SWAR
+
+    /// <summary>Whether the 8 bytes of a (little-endian) word are all digits.</summary>
+    static inline bool IsEightDigits(const uint64_t chunk)
+    {
+        // Every byte is 0x3?, and stays 0x3? when 6 is added to it: '0' through '9'.
+        return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+    }
+
+
+    /// <summary>The value of 8 digits in a (little-endian) word, first digit most significant.</summary>
+    /// <remarks>SWAR: adjacent digits are combined pairwise, into 2-digit, then 4-digit, then the 8-digit value.</remarks>
+    static inline uint64_t ParseEightDigits(uint64_t chunk)
+    {
+        chunk -= 0x3030303030303030ULL;
+        chunk  = (chunk * 10) + (chunk >> 8);
+        chunk  = (((chunk & 0x000000FF000000FFULL) * 0x000F424000000064ULL) + (((chunk >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+        return chunk;
+    }
+
+#endif
+
+
+    /// <summary>Token mode: parses the whitespace-separated tokens of an item as unsigned 64-bit integers.</summary>
+    /// <param name="input">The item.</param>
+    /// <param name="length">The item length.</param>
+    /// <param name="tokens">The tokens are appended to this.</param>
+    /// <returns>false if a token is not a number, or too large for 64 bits.</returns>
+    bool ParseTokens(const char *input, const size_t length, std::vector<uint64_t> &tokens)
+    {
+        const uint64_t maximum = std::numeric_limits<uint64_t>::max();
+
+        size_t i = 0;
+        for (;;)
+        {
+            while ((i < length) && IsWhitespace(input[i])) {
+                ++i;
+            }
+
+            if (i == length) {
+                return true;
+            }
+
+            uint64_t value = 0;
+
+#ifdef TEXT_KERNELS_SWAR
+            // Eight digits at a time, as long as the rest of the item is long enough to load them.
+            while (i + 8 <= length)
+            {
+                uint64_t chunk;
+                memcpy(&chunk, input + i, sizeof(chunk));
+                if (!IsEightDigits(chunk)) {
+                    break;
+                }
+
+                const uint64_t eightDigits = ParseEightDigits(chunk);
+                if (value > (maximum - eightDigits) / 100000000ULL) {
+                    return false;
+                }
+
+                value  = (value * 100000000ULL) + eightDigits;
+                i     += 8;
+            }
+#endif
+
+            for (; (i < length) && !IsWhitespace(input[i]); ++i)
+            {
+                const auto digit = static_cast<unsigned char>(input[i] - '0');
+                if ((digit > 9) || (value > (maximum - digit) / 10)) {
+                    return false;
+                }
+
+                value = (value * 10) + digit;
+            }
+
+            tokens.push_back(value);
+        }
+    }
+
+
+    /// <summary>Token mode: formats sorted tokens, separated by commas, with a line end: "1,931234,15423123\n".</summary>
+    /// <param name="tokens">The sorted tokens.</param>
+    /// <param name="output">The formatted item is appended to this.</param>
+    void FormatTokens(const std::vector<uint64_t> &tokens, std::string &output)
+    {
+        // At most 20 digits, and a separator, each.
+        output.reserve(output.size() + 21 * tokens.size() + 1);
+
+        char digits[20];
+        for (size_t t = 0; t < tokens.size(); ++t)
+        {
+            if (t > 0) {
+                output += ',';
+            }
+
+            uint64_t value = tokens[t];
+            int      count = 0;
+            do
+            {
+                digits[count++] = static_cast<char>('0' + (value % 10));
+                value          /= 10;
+            }
+            while (value != 0);
+
+            while (count > 0) {
+                output += digits[--count];
+            }
+        }
+
+        output += '\n';
+    }
+}
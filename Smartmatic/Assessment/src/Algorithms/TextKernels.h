@@ -0,0 +1,107 @@
+// =============================================================================================================================================
+// <copyright file="TextKernels.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: TextKernels.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 8:40 PM
+//  Purpose: Vectorized (SSE2, AVX2) kernels for filtering the whitespace out of items and formatting the sorted result.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _TEXT_KERNELS_H
+#define _TEXT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Algorithms
+{
+    /// <summary>The instruction sets the text kernels can run on.</summary>
+    /// <remarks>
+    ///     SSE2 is the x86 baseline; the AVX2 kernels are picked at run time when the processor has AVX2.
+    ///     Other processors get the scalar kernels.
+    /// </remarks>
+    enum TextKernelSet
+    {
+        ScalarKernels = 0,
+        Sse2Kernels,
+        Avx2Kernels
+    };
+
+
+    /// <summary>Returns the supported kernel sets.</summary>
+    inline std::string SupportedTextKernelSets()
+    {
+        return "auto | scalar | sse2 | avx2";
+    }
+
+
+    /// <summary>Translate the string to a kernel set; "auto" is the best one this processor has.</summary>
+    bool ToTextKernelSet(const std::string &kernelSetName, TextKernelSet &kernelSet);
+
+    /// <summary>The best kernel set this processor (and build) has.</summary>
+    TextKernelSet BestTextKernelSet();
+
+    /// <summary>The kernel set in use; process-wide.</summary>
+    TextKernelSet ActiveTextKernelSet();
+
+    /// <summary>Switches every following kernel call, process-wide, to a kernel set; false if this processor lacks it.</summary>
+    bool SelectTextKernelSet(TextKernelSet kernelSet);
+
+
+    /// <summary>The output length of <see cref="FormatItem"/>, for an item of <paramref name="length" /> characters.</summary>
+    inline size_t FormattedItemLength(const size_t length)
+    {
+        return (length > 0) ? 2 * length : 1;
+    }
+
+
+    /// <summary>Copies an item without its whitespace (as isspace() in the "C" locale), counting what it dropped.</summary>
+    /// <param name="input">The item.</param>
+    /// <param name="length">The item length.</param>
+    /// <param name="output">The filtered item; room for <paramref name="length" /> characters.  May not overlap the item.</param>
+    /// <param name="whitespaceCount">Incremented by the number of whitespace characters dropped.</param>
+    /// <returns>The filtered item length.</returns>
+    size_t CompactWhitespace(const char *input, size_t length, char *output, size_t &whitespaceCount);
+
+    /// <summary>Counts the whitespace (as isspace() in the "C" locale) of an item; what <see cref="CompactWhitespace"/> would drop.</summary>
+    /// <param name="input">The item.</param>
+    /// <param name="length">The item length.</param>
+    /// <returns>The whitespace count.</returns>
+    size_t CountWhitespace(const char *input, size_t length);
+
+    /// <summary>Formats a sorted item as its characters separated by commas, with a line end: "a,b,c\n".</summary>
+    /// <param name="input">The sorted item.</param>
+    /// <param name="length">The item length.</param>
+    /// <param name="output">The formatted item; room for <see cref="FormattedItemLength"/> characters.</param>
+    /// <returns>The formatted item length.</returns>
+    size_t FormatItem(const char *input, size_t length, char *output);
+
+    /// <summary>Aggregate mode: adds the bytes of an item to a 256-bin histogram, indexed by unsigned byte value.</summary>
+    /// <param name="input">The item.</param>
+    /// <param name="length">The item length.</param>
+    /// <param name="histogram">The histogram; 256 bins.</param>
+    void CountBytes(const char *input, size_t length, uint64_t *histogram);
+
+
+    /// <summary>Token mode: parses the whitespace-separated tokens of an item as unsigned 64-bit integers.</summary>
+    /// <param name="input">The item.</param>
+    /// <param name="length">The item length.</param>
+    /// <param name="tokens">The tokens are appended to this.</param>
+    /// <returns>false if a token is not a number, or too large for 64 bits.</returns>
+    bool ParseTokens(const char *input, size_t length, std::vector<uint64_t> &tokens);
+
+    /// <summary>Token mode: formats sorted tokens, separated by commas, with a line end: "1,931234,15423123\n".</summary>
+    /// <param name="tokens">The sorted tokens.</param>
+    /// <param name="output">The formatted item is appended to this.</param>
+    void FormatTokens(const std::vector<uint64_t> &tokens, std::string &output);
+}
+
+#endif // _TEXT_KERNELS_H
@@ -0,0 +1,316 @@
+// =============================================================================================================================================
+// <copyright file="AllocationTracker.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: AllocationTracker.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-20, 12:15 AM
+//  Purpose: Counts heap allocations, by pipeline stage; compiled in with the TRACK_ALLOCATIONS option.
+// </summary>
+// =============================================================================================================================================
+
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "PipelineStats.h"
+
+
+const int AllocationCounts::BUCKET_COUNT;
+const int AllocationTracker::UNSTAGED;
+
+static_assert(AllocationCounts::BUCKET_COUNT == STAGE_COUNT + 1, "One allocation bucket per pipeline stage, plus one.");
+
+
+/// <summary>All the allocations.</summary>
+long long AllocationCounts::TotalAllocations() const
+{
+    long long total = 0;
+    for (const auto allocations : Allocations) {
+        total += allocations;
+    }
+
+    return total;
+}
+
+
+/// <summary>The counts since an earlier snapshot.</summary>
+/// <param name="earlier">The earlier snapshot.</param>
+AllocationCounts AllocationCounts::Since(const AllocationCounts &earlier) const
+{
+    AllocationCounts counts;
+    for (auto i = 0; i < BUCKET_COUNT; ++i)
+    {
+        counts.Allocations[i] = Allocations[i] - earlier.Allocations[i];
+        counts.Bytes[i]       = Bytes[i] - earlier.Bytes[i];
+    }
+
+    return counts;
+}
+
+
+#ifdef TRACK_ALLOCATIONS
+
+namespace
+{
+    /// <summary>One thread's counts.  Written only by its own thread; read by <see cref="AllocationTracker::Snapshot"/>.</summary>
+    struct ThreadAllocations
+    {
+        std::atomic<long long> Allocations[AllocationCounts::BUCKET_COUNT];
+        std::atomic<long long> Bytes[AllocationCounts::BUCKET_COUNT];
+
+        ThreadAllocations();
+        ~ThreadAllocations();
+
+        void AddTo(AllocationCounts &counts) const
+        {
+            for (auto i = 0; i < AllocationCounts::BUCKET_COUNT; ++i)
+            {
+                counts.Allocations[i] += Allocations[i].load(std::memory_order_relaxed);
+                counts.Bytes[i]       += Bytes[i].load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /// <summary>The counters of every thread alive, and the totals of those gone.</summary>
+    struct AllocationRegistry
+    {
+        std::mutex                             Mutex;
+        std::vector<const ThreadAllocations *> Live;
+        AllocationCounts                       Retired;
+    };
+
+    /// <summary>The registry; never destroyed, so that threads exiting after main() can still retire into it.</summary>
+    AllocationRegistry &Registry()
+    {
+        static AllocationRegistry *registry = new AllocationRegistry();
+        return *registry;
+    }
+
+    // The stage the current thread is in; and whether it is inside the tracker itself, whose own allocations (the
+    // registry's) are not counted, and must not recurse.
+    thread_local int  t_stage     = AllocationTracker::UNSTAGED;
+    thread_local bool t_inTracker = false;
+
+    ThreadAllocations::ThreadAllocations()
+        : Allocations(),
+          Bytes()
+    {
+        auto &registry = Registry();
+
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+
+        registry.Live.push_back(this);
+    }
+
+    ThreadAllocations::~ThreadAllocations()
+    {
+        t_inTracker = true;
+        auto &registry = Registry();
+
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+
+        AddTo(registry.Retired);
+        registry.Live.erase(std::find(registry.Live.begin(), registry.Live.end(), this));
+    }
+
+    /// <summary>Counts an allocation against the calling thread's current stage.</summary>
+    void CountAllocation(const std::size_t size)
+    {
+        if (t_inTracker) {
+            return;
+        }
+
+        // The first use constructs, and registers, the thread's counters.
+        t_inTracker = true;
+        static thread_local ThreadAllocations counts;
+        t_inTracker = false;
+
+        counts.Allocations[t_stage].store(counts.Allocations[t_stage].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counts.Bytes[t_stage].store(counts.Bytes[t_stage].load(std::memory_order_relaxed) + static_cast<long long>(size), std::memory_order_relaxed);
+    }
+
+    /// <summary>Allocates, as the standard operator new does: call the new handler until it works, or throw.</summary>
+    void *Allocate(std::size_t size)
+    {
+        CountAllocation(size);
+
+        size = std::max<std::size_t>(size, 1);
+        for (;;)
+        {
+            void *memory = std::malloc(size);
+            if (nullptr != memory) {
+                return memory;
+            }
+
+            const std::new_handler handler = std::get_new_handler();
+            if (nullptr == handler) {
+                throw std::bad_alloc();
+            }
+
+            handler();
+        }
+    }
+}
+
+
+void *operator new(std::size_t size) { return Allocate(size); }
+void *operator new[](std::size_t size) { return Allocate(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try {
+        return Allocate(size);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept { std::free(memory); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { std::free(memory); }
+
+
+/// <summary>Whether allocations are counted at all: TRACK_ALLOCATIONS builds only.</summary>
+bool AllocationTracker::IsCompiledIn()
+{
+    return true;
+}
+
+
+/// <summary>Charges the calling thread's allocations to a stage, from now on.</summary>
+/// <param name="stage">The stage.</param>
+/// <returns>The stage they were charged to, to go back to.</returns>
+int AllocationTracker::EnterStage(const int stage)
+{
+    const int previousStage = t_stage;
+    t_stage = ((stage >= 0) && (stage < UNSTAGED)) ? stage : UNSTAGED;
+    return previousStage;
+}
+
+
+/// <summary>Charges the calling thread's allocations to the stage it was in before.</summary>
+/// <param name="previousStage">The stage, as returned by <see cref="EnterStage"/>.</param>
+void AllocationTracker::LeaveStage(const int previousStage)
+{
+    t_stage = previousStage;
+}
+
+
+/// <summary>The counts of every thread so far.</summary>
+/// <param name="counts">The counts.</param>
+/// <remarks>Live threads are read without stopping them; the numbers are only exact once the workers are idle.</remarks>
+void AllocationTracker::Snapshot(AllocationCounts &counts)
+{
+    auto &registry = Registry();
+
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+
+    counts = registry.Retired;
+    for (auto thread : registry.Live) {
+        thread->AddTo(counts);
+    }
+}
+
+#else
+
+/// <summary>Whether allocations are counted at all: TRACK_ALLOCATIONS builds only.</summary>
+bool AllocationTracker::IsCompiledIn()
+{
+    return false;
+}
+
+
+/// <summary>The counts of every thread so far: none, in this build.</summary>
+/// <param name="counts">The counts.</param>
+void AllocationTracker::Snapshot(AllocationCounts &counts)
+{
+    counts = AllocationCounts();
+}
+
+#endif  // TRACK_ALLOCATIONS
+
+
+/// <summary>Writes the counts, and the counts per line: a table, or a single JSON object.  Writes nothing if there are none.</summary>
+/// <param name="stream">The stream.</param>
+/// <param name="counts">The counts.</param>
+/// <param name="lines">The lines the counts are for.</param>
+/// <param name="json">JSON, rather than a table.</param>
+void AllocationTracker::Report(std::ostream &stream, const AllocationCounts &counts, const long long lines, const bool json)
+{
+    if (!IsCompiledIn()) {
+        return;
+    }
+
+    const double perLine      = 1.0 / static_cast<double>(std::max(lines, 1LL));
+    const auto   oldFlags     = stream.flags();
+    const auto   oldPrecision = stream.precision();
+    stream << std::fixed << std::setprecision(2);
+
+    const auto bucketName = [](const int bucket) {
+        return (bucket == UNSTAGED) ? "unstaged" : StageName(static_cast<PipelineStage>(bucket));
+    };
+
+    if (json)
+    {
+        stream << "{\"allocations\":{\"lines\":" << lines << ",\"perLine\":" << static_cast<double>(counts.TotalAllocations()) * perLine
+               << ",\"stages\":{";
+        auto first = true;
+        for (auto bucket = 0; bucket < AllocationCounts::BUCKET_COUNT; ++bucket)
+        {
+            if (counts.Allocations[bucket] == 0) {
+                continue;
+            }
+
+            stream << (first ? "" : ",") << "\"" << bucketName(bucket) << "\":{\"allocations\":" << counts.Allocations[bucket]
+                   << ",\"bytes\":" << counts.Bytes[bucket] << ",\"perLine\":" << static_cast<double>(counts.Allocations[bucket]) * perLine
+                   << ",\"bytesPerLine\":" << static_cast<double>(counts.Bytes[bucket]) * perLine << "}";
+            first = false;
+        }
+
+        stream << "}}}" << std::endl;
+    }
+    else
+    {
+        stream << "  Allocations      allocations         bytes  per line  bytes/line" << std::endl;
+
+        long long totalBytes = 0;
+        for (auto bucket = 0; bucket < AllocationCounts::BUCKET_COUNT; ++bucket)
+        {
+            totalBytes += counts.Bytes[bucket];
+            if (counts.Allocations[bucket] == 0) {
+                continue;
+            }
+
+            stream << "  " << std::left << std::setw(15) << bucketName(bucket) << std::right << std::setw(12) << counts.Allocations[bucket]
+                   << std::setw(14) << counts.Bytes[bucket] << std::setw(10) << static_cast<double>(counts.Allocations[bucket]) * perLine
+                   << std::setw(12) << static_cast<double>(counts.Bytes[bucket]) * perLine << std::endl;
+        }
+
+        stream << "  " << std::left << std::setw(15) << "total" << std::right << std::setw(12) << counts.TotalAllocations()
+               << std::setw(14) << totalBytes << std::setw(10) << static_cast<double>(counts.TotalAllocations()) * perLine
+               << std::setw(12) << static_cast<double>(totalBytes) * perLine << "  (" << lines << " lines, steady state)" << std::endl;
+    }
+
+    stream.flags(oldFlags);
+    stream.precision(oldPrecision);
+}
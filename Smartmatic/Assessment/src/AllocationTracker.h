@@ -0,0 +1,87 @@
+// =============================================================================================================================================
+// <copyright file="AllocationTracker.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: AllocationTracker.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-20, 12:15 AM
+//  Purpose: Counts heap allocations, by pipeline stage; compiled in with the TRACK_ALLOCATIONS option.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _ALLOCATION_TRACKER_H
+#define _ALLOCATION_TRACKER_H
+
+#include <ostream>
+
+
+/// <summary>Heap allocations, and the bytes asked for, by pipeline stage; the last bucket is outside any stage.</summary>
+struct AllocationCounts
+{
+    static const int BUCKET_COUNT = 10;   // STAGE_COUNT, plus one.
+
+    long long Allocations[BUCKET_COUNT] = {};
+    long long Bytes[BUCKET_COUNT]       = {};
+
+    /// <summary>All the allocations.</summary>
+    long long TotalAllocations() const;
+
+    /// <summary>The counts since an earlier snapshot.</summary>
+    AllocationCounts Since(const AllocationCounts &earlier) const;
+};
+
+
+/// <summary>Counts heap allocations, by pipeline stage.</summary>
+/// <remarks>
+///     A TRACK_ALLOCATIONS build replaces the global operator new and operator delete: every allocation is counted,
+///     against the stage the calling thread is in (see <see cref="AllocationScope"/>; every <see cref="StageScope"/>
+///     is one), in counters of the thread's own.  A thread's counters are folded into the totals when it exits.
+///     In any other build, nothing is counted, and the stage tracking compiles away.
+/// </remarks>
+class AllocationTracker
+{
+public:
+    static const int UNSTAGED = AllocationCounts::BUCKET_COUNT - 1;
+
+    /// <summary>Whether allocations are counted at all: TRACK_ALLOCATIONS builds only.</summary>
+    static bool IsCompiledIn();
+
+#ifdef TRACK_ALLOCATIONS
+    /// <summary>Charges the calling thread's allocations to a stage, from now on.</summary>
+    /// <returns>The stage they were charged to, to go back to.</returns>
+    static int EnterStage(int stage);
+
+    /// <summary>Charges the calling thread's allocations to the stage it was in before.</summary>
+    static void LeaveStage(int previousStage);
+#else
+    static int EnterStage(int) { return UNSTAGED; }
+    static void LeaveStage(int) { }
+#endif
+
+    /// <summary>The counts of every thread so far.</summary>
+    static void Snapshot(AllocationCounts &counts);
+
+    /// <summary>Writes the counts, and the counts per line: a table, or a single JSON object.</summary>
+    static void Report(std::ostream &stream, const AllocationCounts &counts, long long lines, bool json);
+};
+
+
+/// <summary>Charges the calling thread's allocations to a stage, from construction to destruction.</summary>
+class AllocationScope
+{
+private:
+    int _previousStage;
+
+public:
+    explicit AllocationScope(const int stage) : _previousStage(AllocationTracker::EnterStage(stage)) { }
+    ~AllocationScope() { AllocationTracker::LeaveStage(_previousStage); }
+
+    AllocationScope(AllocationScope &) = delete;
+    AllocationScope operator =(AllocationScope &) = delete;
+};
+
+#endif  // _ALLOCATION_TRACKER_H
@@ -43,18 +43,36 @@
 // </summary>
 // =============================================================================================================================================
 
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 
 #include "Algorithms/HeapSort.h"
 #include "Algorithms/SortAlgorithm.h"
+#include "Algorithms/TextKernels.h"
+#include "AllocationTracker.h"
+#include "Clock.h"
+#include "Compatibility.h"
+#include "JobServer.h"
+#include "IncrementalRun.h"
 #include "ProcessInputFile.h"
+#include "ProcessOptions.h"
+#include "ShardedRun.h"
 
 
 // Local/Static Method prototypes:
 static int  CheckApplicationArguments(char *argv[], Algorithms::SortAlgorithm &sortAlgorithm);
+static int  CheckApplicationOptions(int argc, char *argv[], int firstOption, ProcessOptions &options);
 static void QuickTest(char *argv[]);
+static int  Serve(int argc, char *argv[]);
+static void StopServer(int signalNumber);
+static size_t ToByteSize(const std::string &value);
 static void Usage(char *argv[]);
 
+// "--serve" mode only; for StopServer().
+static JobServer *s_server = nullptr;
+
 
 /// <summary>Main method.</summary>
 /// <param name="argc">The argument count.</param>
@@ -62,6 +80,11 @@ static void Usage(char *argv[]);
 /// <returns>Exit status</returns>
 int main(const int argc, char *argv[])
 {
+    // Daemon mode takes its jobs over a socket, rather than from the command line.
+    if ((argc >= 2) && (std::string(argv[1]).compare(0, 7, "--serve") == 0)) {
+        exit(Serve(argc, argv));
+    }
+
     // Do we have a correctly formatted command line?
     if (argc < 3)
     {
@@ -75,13 +98,50 @@ int main(const int argc, char *argv[])
         exit (errorCode);
     }
 
+    ProcessOptions options;
+    errorCode = CheckApplicationOptions(argc, argv, 4, options);
+    if (errorCode < 0) {
+        exit (errorCode);
+    }
+
     const char *pPathToInputFile  = argv[1];
     const char *pPathToOutputFile = argv[2];
 
-    // Process the input file.
-    auto processor = new ProcessInputFile(pPathToInputFile, pPathToOutputFile, sortAlgorithm);
-    errorCode      = processor->Process();
-    delete processor;
+    // Virtual time: every sleep is skipped, and the time it would have taken is reported instead.
+    VirtualClock virtualClock;
+    if (options.VirtualTime) {
+        Clock::Use(&virtualClock);
+    }
+
+    const long long startedAt = Clock::Current().Now();
+
+    // Process the input file; only its new and changed lines, in incremental mode; in slices, in sharded mode.
+    if (!options.ManifestFile.empty())
+    {
+        IncrementalRun incrementalRun(pPathToInputFile, pPathToOutputFile, sortAlgorithm, options);
+        errorCode = incrementalRun.Process();
+    }
+    else if (options.ShardCount > 1)
+    {
+        ShardedRun shardedRun(pPathToInputFile, pPathToOutputFile, sortAlgorithm, options);
+        errorCode = shardedRun.Process();
+    }
+    else
+    {
+        auto processor = new ProcessInputFile(pPathToInputFile, pPathToOutputFile, sortAlgorithm, options);
+        errorCode      = processor->Process();
+        delete processor;
+    }
+
+    if (options.VirtualTime)
+    {
+        const double simulatedSeconds = static_cast<double>(Clock::Current().Now() - startedAt) / 1e9;
+        const double skippedSeconds   = static_cast<double>(virtualClock.SkippedNanoseconds()) / 1e9;
+        Clock::Use(nullptr);
+
+        std::cout << "Simulated wall time " << simulatedSeconds << " s, of which " << skippedSeconds << " s skipped." << std::endl;
+    }
+
     if (errorCode < 0) {
         exit (errorCode);
     }
@@ -129,6 +189,437 @@ static int CheckApplicationArguments(char *argv[], Algorithms::SortAlgorithm &so
 }
 
 
+/// <summary>Checks the optional "--name=value" arguments following the positional arguments.</summary>
+/// <param name="argc">The argument count.</param>
+/// <param name="argv">The argv.</param>
+/// <param name="firstOption">The index of the first option.</param>
+/// <param name="options">The options.</param>
+/// <returns>Exit/Error Code if less than 0.</returns>
+static int CheckApplicationOptions(const int argc, char *argv[], const int firstOption, ProcessOptions &options)
+{
+    for (auto i = firstOption; i < argc; ++i)
+    {
+        const std::string            argument = argv[i];
+        const std::string::size_type equals   = argument.find('=');
+        const std::string            name     = argument.substr(0, equals);
+        const std::string            value    = (equals != std::string::npos) ? argument.substr(equals + 1) : "";
+
+        if (name == "--queue")
+        {
+            if (!ToQueueBackend(value, options.Queue))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Queue backend '" << value << "' is not available." << std::endl;
+                return -4;
+            }
+        }
+        else if (name == "--ring-capacity")
+        {
+            const long capacity = strtol(value.c_str(), nullptr, 10);
+            if (capacity <= 0)
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Ring capacity '" << value << "' is not a positive number." << std::endl;
+                return -4;
+            }
+
+            options.RingCapacity = static_cast<size_t>(capacity);
+        }
+        else if (name == "--scheduler")
+        {
+            if (!ToScheduler(value, options.Scheduler))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Scheduler '" << value << "' is not available." << std::endl;
+                return -4;
+            }
+        }
+        else if (name == "--threads")
+        {
+            const long threadCount = (value == "auto") ? AvailableProcessorCount() : strtol(value.c_str(), nullptr, 10);
+            if (threadCount <= 0)
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Thread count '" << value << "' is neither a positive number nor 'auto'." << std::endl;
+                return -4;
+            }
+
+            options.ThreadCount = static_cast<int>(threadCount);
+        }
+        else if (name == "--external-sort")
+        {
+            options.ExternalSortMemory = value.empty() ? ProcessOptions::DEFAULT_EXTERNAL_SORT_MEMORY : ToByteSize(value);
+            if (options.ExternalSortMemory == 0)
+            {
+                std::cerr << "Error:" << std::endl
+                          << "External sort memory '" << value << "' is not a positive size." << std::endl;
+                return -4;
+            }
+        }
+        else if (name == "--sort-temp")
+        {
+            if (value.empty())
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '--sort-temp' needs a directory." << std::endl;
+                return -4;
+            }
+
+            options.SortTempDirectory = value;
+        }
+        else if (name == "--index")
+        {
+            options.WriteIndex = true;
+            options.IndexFile  = value;
+        }
+        else if (name == "--incremental")
+        {
+            if (value.empty())
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '--incremental' needs a manifest file name." << std::endl;
+                return -4;
+            }
+
+            options.ManifestFile = value;
+        }
+        else if (name == "--positional") {
+            options.Positional = true;
+        }
+        else if (name == "--unordered") {
+            options.Unordered = true;
+        }
+        else if (name == "--shards")
+        {
+            const long shardCount = strtol(value.c_str(), nullptr, 10);
+            if ((shardCount <= 0) || (shardCount > ShardedRun::MAX_SHARDS))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Shard count '" << value << "' is not a number from 1 to " << ShardedRun::MAX_SHARDS << "." << std::endl;
+                return -4;
+            }
+
+#ifdef _MSC_VER
+            if (shardCount > 1)
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '--shards' needs fork(), which this platform does not have." << std::endl;
+                return -4;
+            }
+#endif
+
+            options.ShardCount = static_cast<int>(shardCount);
+        }
+        else if (name == "--kernels")
+        {
+            Algorithms::TextKernelSet kernelSet;
+            if (!Algorithms::ToTextKernelSet(value, kernelSet) || !Algorithms::SelectTextKernelSet(kernelSet))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Text kernels '" << value << "' are not available on this processor." << std::endl;
+                return -4;
+            }
+        }
+        else if (name == "--tokens") {
+            options.Tokens = true;
+        }
+        else if (name == "--aggregate")
+        {
+            if (!ToAggregateMode(value, options.Aggregate))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Aggregate mode '" << value << "' is not available." << std::endl;
+                return -4;
+            }
+        }
+        else if (name == "--max-allocations-per-line")
+        {
+            char *end = nullptr;
+            options.MaxAllocationsPerLine = strtod(value.c_str(), &end);
+            if (value.empty() || (*end != '\0') || (options.MaxAllocationsPerLine < 0.0))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '--max-allocations-per-line' needs a number, not '" << value << "'." << std::endl;
+                return -4;
+            }
+
+            if (!AllocationTracker::IsCompiledIn())
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '--max-allocations-per-line' needs a build with the TRACK_ALLOCATIONS option." << std::endl;
+                return -4;
+            }
+        }
+        else if (name == "--virtual-time") {
+            options.VirtualTime = true;
+        }
+        else if (name == "--elastic") {
+            options.ElasticThreads = true;
+        }
+        else if (name == "--stats")
+        {
+            if (value.empty() || (value == "text")) {
+                options.Stats = TextStats;
+            }
+            else if (value == "json") {
+                options.Stats = JsonStats;
+            }
+            else
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Statistics format '" << value << "' is not available." << std::endl;
+                return -4;
+            }
+        }
+        else if (name == "--trace")
+        {
+            if (value.empty())
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '--trace' needs a file name." << std::endl;
+                return -4;
+            }
+
+            options.TraceFile = value;
+        }
+        else if (name == "--progress") {
+            options.Progress = true;
+        }
+        else if (name == "--metrics-file")
+        {
+            if (value.empty())
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '--metrics-file' needs a file name." << std::endl;
+                return -4;
+            }
+
+            options.MetricsFile = value;
+        }
+        else if (name == "--progress-interval")
+        {
+            const long intervalMs = strtol(value.c_str(), nullptr, 10);
+            if (intervalMs <= 0)
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Progress interval '" << value << "' is not a positive number." << std::endl;
+                return -4;
+            }
+
+            options.ProgressIntervalMs = static_cast<int>(intervalMs);
+        }
+        else if (name == "--batch-size")
+        {
+            const long batchSize = strtol(value.c_str(), nullptr, 10);
+            if (batchSize <= 0)
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Batch size '" << value << "' is not a positive number." << std::endl;
+                return -4;
+            }
+
+            options.BatchSize = static_cast<int>(batchSize);
+        }
+        else
+        {
+            std::cerr << "Error:" << std::endl
+                      << "Option '" << argument << "' is not recognized." << std::endl;
+            return -4;
+        }
+    }
+
+    if (options.Tokens && (options.Aggregate != NoAggregate))
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Options '--tokens' and '--aggregate' cannot be combined." << std::endl;
+        return -4;
+    }
+
+    if ((options.ExternalSortMemory > 0) && (options.Aggregate != NoAggregate))
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Options '--external-sort' and '--aggregate' cannot be combined." << std::endl;
+        return -4;
+    }
+
+    // The external sort runs on the queue consumers (see ProcessInputFile); no other scheduler would be used.
+    if ((options.ExternalSortMemory > 0) && (options.Scheduler != QueueScheduler))
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--external-sort' needs the queue scheduler." << std::endl;
+        return -4;
+    }
+
+    if (!options.ManifestFile.empty() && ((options.ExternalSortMemory > 0) || (options.Aggregate != NoAggregate)))
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--incremental' cannot be combined with '--external-sort' or '--aggregate'." << std::endl;
+        return -4;
+    }
+
+    // The results go out in no particular order, with tags of their own.
+    if (options.Unordered && (options.WriteIndex || !options.ManifestFile.empty() || (options.ExternalSortMemory > 0) ||
+                              (options.Aggregate != NoAggregate)))
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--unordered' cannot be combined with '--index', '--incremental', '--external-sort' or '--aggregate'." << std::endl;
+        return -4;
+    }
+
+    // The place of a result is worked out from the length of the line; a token result's length depends on its numbers.
+    // An incremental run processes its changed lines through a stream.
+    if (options.Positional && (options.Tokens || options.Unordered || !options.ManifestFile.empty() || (options.ExternalSortMemory > 0) ||
+                               (options.Aggregate != NoAggregate)))
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--positional' cannot be combined with '--tokens', '--unordered', '--incremental', '--external-sort' or '--aggregate'."
+                  << std::endl;
+        return -4;
+    }
+
+    // Every shard is a process of its own, with its own clock, writing a file of its own; nothing else may be shared.
+    if ((options.ShardCount > 1) && (options.Unordered || options.WriteIndex || !options.ManifestFile.empty() ||
+                                     (options.ExternalSortMemory > 0) || (options.Aggregate != NoAggregate) ||
+                                     !options.TraceFile.empty() || !options.MetricsFile.empty() || options.VirtualTime))
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--shards' cannot be combined with '--unordered', '--index', '--incremental', '--external-sort', '--aggregate',"
+                  << " '--trace', '--metrics-file' or '--virtual-time'." << std::endl;
+        return -4;
+    }
+
+    // Neither writes a result per input line.
+    if (options.WriteIndex && ((options.ExternalSortMemory > 0) || (options.Aggregate != NoAggregate)))
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--index' cannot be combined with '--external-sort' or '--aggregate'." << std::endl;
+        return -4;
+    }
+
+    return 0;
+}
+
+
+/// <summary>"--serve=&lt;socket&gt;": runs jobs sent over a Unix domain socket, on a warm worker pool, until stopped.</summary>
+/// <param name="argc">The argument count.</param>
+/// <param name="argv">The argument vector.</param>
+/// <returns>Exit/Error Code if less than 0.</returns>
+static int Serve(const int argc, char *argv[])
+{
+    const std::string            argument = argv[1];
+    const std::string::size_type equals   = argument.find('=');
+    const std::string            path     = (equals != std::string::npos) ? argument.substr(equals + 1) : "";
+    if ((argument.substr(0, equals) != "--serve") || path.empty())
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--serve' needs a socket path." << std::endl;
+        return -4;
+    }
+
+    ProcessOptions options;
+    const int errorCode = CheckApplicationOptions(argc, argv, 2, options);
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    // The jobs share the process, and its clock.
+    if (options.VirtualTime)
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--virtual-time' is for a command line run only, not for '--serve'." << std::endl;
+        return -4;
+    }
+
+    // Every job would write the very same trace, metrics and index files, at the same time.
+    if (!options.TraceFile.empty() || !options.MetricsFile.empty() || options.WriteIndex)
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Options '--trace', '--metrics-file' and '--index' are for a command line run only, not for '--serve'." << std::endl;
+        return -4;
+    }
+
+    // The jobs are streams, not files; there is no previous output to copy from.
+    if (!options.ManifestFile.empty())
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--incremental' is for a command line run only, not for '--serve'." << std::endl;
+        return -4;
+    }
+
+    if (options.ShardCount > 1)
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--shards' is for a command line run only, not for '--serve'." << std::endl;
+        return -4;
+    }
+
+    // The jobs run on the shared work-stealing pool; an external sort would start consumer threads of its own.
+    if (options.ExternalSortMemory > 0)
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Option '--external-sort' is for a command line run only, not for '--serve'." << std::endl;
+        return -4;
+    }
+
+    JobServer server(path, options);
+    s_server = &server;
+    signal(SIGINT,  &StopServer);
+    signal(SIGTERM, &StopServer);
+
+    const int result = server.Run();
+
+    signal(SIGINT,  SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    s_server = nullptr;
+    return result;
+}
+
+
+/// <summary>SIGINT/SIGTERM handler of "--serve" mode: lets the running jobs finish, then exits.</summary>
+/// <param name="signalNumber">The signal number.</param>
+static void StopServer(int /*signalNumber*/)
+{
+    if (nullptr != s_server) {
+        s_server->Stop();
+    }
+}
+
+
+/// <summary>Translate a size, in bytes, with an optional K, M or G (binary) suffix.</summary>
+/// <param name="value">The size, e.g.: "512K", "64M".</param>
+/// <returns>The size in bytes; 0 if it is not a positive size.</returns>
+static size_t ToByteSize(const std::string &value)
+{
+    char            *end  = nullptr;
+    const long long  size = strtoll(value.c_str(), &end, 10);
+    if ((size <= 0) || (end == value.c_str())) {
+        return 0;
+    }
+
+    const std::string suffix(end);
+    int               shift = 0;
+    if ((suffix == "K") || (suffix == "k")) {
+        shift = 10;
+    }
+    else if ((suffix == "M") || (suffix == "m")) {
+        shift = 20;
+    }
+    else if ((suffix == "G") || (suffix == "g")) {
+        shift = 30;
+    }
+    else if (!suffix.empty()) {
+        return 0;
+    }
+
+    // Too big to count in bytes is no size at all.
+    if (static_cast<unsigned long long>(size) > (SIZE_MAX >> shift)) {
+        return 0;
+    }
+
+    return static_cast<size_t>(size) << shift;
+}
+
+
 /// <summary>Output the progam usage information to stdout.</summary>
 /// <param name="argv">The argument vector.</param>
 static void Usage(char *argv[])
@@ -145,8 +636,34 @@ static void Usage(char *argv[])
     const std::string programName = (off != std::string::npos) ? fullProgamPath.substr(off + 1) : fullProgamPath;
 
     std::cout << "Usage:" << std::endl
-              << programName << " <pathToInputFile> <pathToOutputFile> <algorithmToSort>" << std::endl
-              << "    <algorithmToSort>::= [" << Algorithms::SupportedSortAlgorithms() << "]" << std::endl;
+              << programName << " <pathToInputFile> <pathToOutputFile> <algorithmToSort> [options]" << std::endl
+              << programName << " --serve=<socketPath> [options]" << std::endl
+              << "    --serve=<socketPath>::= run as a daemon, taking jobs over a Unix domain socket (see JobServer.h)" << std::endl
+              << "    <algorithmToSort>::= [" << Algorithms::SupportedSortAlgorithms() << "]" << std::endl
+              << "    [options]:" << std::endl
+              << "        --queue=<backend>         Producer queue storage, <backend>::= [" << SupportedQueueBackends() << "]" << std::endl
+              << "        --ring-capacity=<n>       Ring backend capacity (rounded up to a power of two)" << std::endl
+              << "        --scheduler=<scheduler>   Worker scheduling, <scheduler>::= [" << SupportedSchedulers() << "]" << std::endl
+              << "        --batch-size=<n>          Lines per batch handed to the work-stealing scheduler" << std::endl
+              << "        --threads=<n>|auto        Worker threads (default " << ProcessOptions::DEFAULT_THREAD_COUNT << "); 'auto' sizes to the usable processors" << std::endl
+              << "        --tokens                  Sort each item's whitespace-separated numbers, rather than its characters" << std::endl
+              << "        --aggregate=<form>        One result for the whole input, <form>::= [" << SupportedAggregateModes() << "]" << std::endl
+              << "        --external-sort[=<size>]  Sort the output lines, in at most <size> of memory (default 64M; K, M, G suffixes); queue scheduler only" << std::endl
+              << "        --sort-temp=<dir>         Where the external sort spills its runs (default: TMPDIR)" << std::endl
+              << "        --index[=<file>]          Index the output by input line number, for IndexLookup (default <pathToOutputFile>.idx)" << std::endl
+              << "        --incremental=<manifest>  Reprocess only the lines changed since the run which wrote <manifest>; copy the rest" << std::endl
+              << "        --positional              Write every result straight to its place in the output file (not with --tokens)" << std::endl
+              << "        --shards=<n>              Split the input across <n> processes, and join their outputs in order" << std::endl
+              << "        --unordered               Write \"<line>\\t<result>\" records as they finish, in any order (see RestoreOrder)" << std::endl
+              << "        --kernels=<kernels>       Whitespace filter and formatting kernels, <kernels>::= [" << Algorithms::SupportedTextKernelSets() << "]" << std::endl
+              << "        --elastic                 Queue and hol schedulers: add and park workers (up to --threads) with the load" << std::endl
+              << "        --max-allocations-per-line=<n>  Fail if the lines average more heap allocations (TRACK_ALLOCATIONS builds)" << std::endl
+              << "        --virtual-time            Skip the whitespace sleeps, and report the wall time they would have taken" << std::endl
+              << "        --stats[=text|json]       Report per-stage latencies, per-thread busy/idle time and throughput" << std::endl
+              << "        --trace=<file.json>       Write a timeline of the run in Chrome trace event format (Perfetto, chrome://tracing)" << std::endl
+              << "        --progress                Report progress to stderr while running" << std::endl
+              << "        --metrics-file=<file>     Keep Prometheus text-format progress metrics in <file> while running" << std::endl
+              << "        --progress-interval=<ms>  How often to report progress (default 1000)" << std::endl;
 }
 
 
@@ -0,0 +1,190 @@
+// =============================================================================================================================================
+// <copyright file="BoundedRingQueue.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: BoundedRingQueue.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 9:12 AM
+//   Purpose: Lock-free bounded multi-producer / multi-consumer ring buffer.
+// Reference: http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _BOUNDED_RING_QUEUE_H
+#define _BOUNDED_RING_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+/// <summary>Lock-free bounded multi-producer / multi-consumer ring buffer.</summary>
+/// <remarks>
+///     Dmitry Vyukov's design:  every cell carries a sequence number which tells a producer whether the cell is free for
+///     the current lap, and tells a consumer whether the cell has been filled for the current lap.  Producers and consumers
+///     only ever contend on their own position counter (one CAS each), and those counters live on separate cache lines.
+///     The capacity is rounded up to a power of two so that the position to cell mapping is a mask.
+///     <code> http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue </code>
+/// </remarks>
+template<typename TWorkItem> class BoundedRingQueue
+{
+public:
+    static const size_t CACHE_LINE_SIZE = 64;
+
+private:
+
+    struct Cell
+    {
+        std::atomic<size_t> Sequence;
+        TWorkItem           Data;
+    };
+
+    using pad_t = char[CACHE_LINE_SIZE];
+
+    pad_t                   _pad0;
+    std::unique_ptr<Cell[]> _buffer;
+    size_t                  _bufferMask;
+    pad_t                   _pad1;
+    std::atomic<size_t>     _enqueuePosition;
+    pad_t                   _pad2;
+    std::atomic<size_t>     _dequeuePosition;
+    pad_t                   _pad3;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="BoundedRingQueue"/> class.</summary>
+    /// <param name="capacity">The requested capacity, rounded up to the next power of two.</param>
+    explicit BoundedRingQueue(const size_t capacity)
+        : _pad0(),
+          _bufferMask(RoundUpToPowerOfTwo(capacity) - 1),
+          _pad1(),
+          _enqueuePosition(0),
+          _pad2(),
+          _dequeuePosition(0),
+          _pad3()
+    {
+        _buffer.reset(new Cell[_bufferMask + 1]);
+        for (size_t i = 0; i <= _bufferMask; ++i) {
+            _buffer[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+
+    /// <summary>The number of cells in the ring.</summary>
+    size_t Capacity() const { return _bufferMask + 1; }
+
+
+    /// <summary>Determines whether this queue is empty.</summary>
+    /// <returns> true or false as appropriate; only a snapshot while other threads are active.</returns>
+    bool IsEmpty() const
+    {
+        return _dequeuePosition.load(std::memory_order_acquire) >= _enqueuePosition.load(std::memory_order_acquire);
+    }
+
+
+    /// <summary>The number of items in the ring.</summary>
+    /// <returns>Only a snapshot while other threads are active.</returns>
+    size_t Size() const
+    {
+        const size_t dequeuePosition = _dequeuePosition.load(std::memory_order_acquire);
+        const size_t enqueuePosition = _enqueuePosition.load(std::memory_order_acquire);
+        return (enqueuePosition > dequeuePosition) ? (enqueuePosition - dequeuePosition) : 0;
+    }
+
+
+    /// <summary>Tries to push an item into the ring.</summary>
+    /// <param name="item">The item; left untouched if the ring is full.</param>
+    /// <returns>true / false - false when the ring is full.</returns>
+    bool TryPush(TWorkItem && item)
+    {
+        Cell  *cell;
+        size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &_buffer[position & _bufferMask];
+            const size_t   sequence   = cell->Sequence.load(std::memory_order_acquire);
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0)
+            {
+                if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = _enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->Data = std::move(item);
+        cell->Sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+
+    /// <summary>Tries to pop an item from the ring.</summary>
+    /// <param name="workItem">The work item.</param>
+    /// <returns>true / false - false when the ring is empty.</returns>
+    bool TryPop(TWorkItem & workItem)
+    {
+        Cell  *cell;
+        size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &_buffer[position & _bufferMask];
+            const size_t   sequence   = cell->Sequence.load(std::memory_order_acquire);
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0)
+            {
+                if (_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = _dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        workItem = std::move(cell->Data);
+        cell->Sequence.store(position + _bufferMask + 1, std::memory_order_release);
+        return true;
+    }
+
+
+    /// Block the copy constructor.
+    BoundedRingQueue(BoundedRingQueue &) = delete;
+
+    /// Block the move constructor.
+    BoundedRingQueue(BoundedRingQueue &&) = delete;
+
+    /// Block the copy assignment operator.
+    BoundedRingQueue operator =(BoundedRingQueue &) = delete;
+
+    /// Block the move assignment operator.
+    BoundedRingQueue operator =(BoundedRingQueue &&) = delete;
+
+private:
+
+    /// <summary>Rounds up to the next power of two (minimum of two cells).</summary>
+    static size_t RoundUpToPowerOfTwo(const size_t value)
+    {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+
+        return result;
+    }
+};
+
+#endif  // _BOUNDED_RING_QUEUE_H
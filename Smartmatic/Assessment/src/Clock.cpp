@@ -0,0 +1,110 @@
+// =============================================================================================================================================
+// <copyright file="Clock.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: Clock.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 11:40 PM
+//  Purpose: The time source of the pipeline: the system clock, or a virtual clock which skips the sleeps.
+// </summary>
+// =============================================================================================================================================
+
+#include "Clock.h"
+
+#include <algorithm>
+
+#include "Compatibility.h"
+
+
+const long long VirtualClock::SETTLE_NANOSECONDS;
+
+static SystemClock          s_systemClock;
+static std::atomic<Clock *> s_currentClock(&s_systemClock);
+
+
+/// <summary>The process-wide clock.</summary>
+/// <returns>The clock.</returns>
+Clock &Clock::Current()
+{
+    return *s_currentClock.load(std::memory_order_acquire);
+}
+
+
+/// <summary>Puts a clock in place of the current one; nullptr for the system clock.  Only while no job is running.</summary>
+/// <param name="clock">The clock; the caller keeps ownership, and keeps it alive while it is in use.</param>
+void Clock::Use(Clock *clock)
+{
+    s_currentClock.store((nullptr != clock) ? clock : &s_systemClock, std::memory_order_release);
+}
+
+
+/// <summary>Monotonic time, in nanoseconds.</summary>
+long long SystemClock::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/// <summary>Sleeps the calling thread.</summary>
+/// <param name="nanoseconds">How long.</param>
+void SystemClock::Sleep(const long long nanoseconds)
+{
+    NanosecondSleep(nanoseconds);
+}
+
+
+/// <summary>Initializes a new instance of the <see cref="VirtualClock"/> class.</summary>
+VirtualClock::VirtualClock()
+    : _skipped(0),
+      _activity(0)
+{ }
+
+
+/// <summary>Monotonic time, in nanoseconds: the real time, plus the time skipped.</summary>
+long long VirtualClock::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() + _skipped;
+}
+
+
+/// <summary>Sleeps the calling thread, in virtual time.</summary>
+/// <param name="nanoseconds">How long.</param>
+void VirtualClock::Sleep(const long long nanoseconds)
+{
+    // Lock will be released as soon as it goes out of scope.
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    const long long wakeAt = Now() + nanoseconds;
+    const auto      wakeup = _wakeups.insert(wakeAt);
+    ++_activity;
+
+    for (long long now = Now(); now < wakeAt; now = Now())
+    {
+        const unsigned activity = _activity;
+        const bool     timedOut = _wakeCV.wait_for(lock, std::chrono::nanoseconds(std::min(wakeAt - now, SETTLE_NANOSECONDS))) == std::cv_status::timeout;
+
+        // Everybody who has a sleep to do is in it: skip ahead to whoever wakes up first.
+        now = Now();
+        if (timedOut && (activity == _activity) && (*_wakeups.begin() > now))
+        {
+            _skipped += *_wakeups.begin() - now;
+            ++_activity;
+            _wakeCV.notify_all();
+        }
+    }
+
+    _wakeups.erase(wakeup);
+    ++_activity;
+}
+
+
+/// <summary>How long to block for at a time, in real time: never so long as to miss the clock moving on.</summary>
+/// <param name="remaining">The virtual time left to wait.</param>
+long long VirtualClock::WaitSlice(const long long remaining) const
+{
+    return std::min(remaining, SETTLE_NANOSECONDS);
+}
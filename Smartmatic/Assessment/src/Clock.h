@@ -0,0 +1,136 @@
+// =============================================================================================================================================
+// <copyright file="Clock.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: Clock.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 11:40 PM
+//  Purpose: The time source of the pipeline: the system clock, or a virtual clock which skips the sleeps.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _CLOCK_H
+#define _CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+
+/// <summary>The time source of the pipeline: every sleep, timed wait and duration measurement goes through here.</summary>
+/// <remarks>
+///     There is one clock per process, <see cref="Current"/>; the system clock unless another one is put in its place,
+///     before any job starts.
+/// </remarks>
+class Clock
+{
+public:
+    virtual ~Clock() = default;
+
+    /// <summary>The process-wide clock.</summary>
+    static Clock &Current();
+
+    /// <summary>Puts a clock in place of the current one; nullptr for the system clock.  Only while no job is running.</summary>
+    static void Use(Clock *clock);
+
+    /// <summary>Monotonic time, in nanoseconds.</summary>
+    virtual long long Now() = 0;
+
+    /// <summary>Sleeps the calling thread.</summary>
+    /// <param name="nanoseconds">How long.</param>
+    virtual void Sleep(long long nanoseconds) = 0;
+
+
+    /// <summary>Waits on a condition for a predicate, for at most a while of this clock's time.</summary>
+    /// <param name="condition">The condition variable.</param>
+    /// <param name="lock">The lock, held.</param>
+    /// <param name="nanoseconds">The longest time to wait.</param>
+    /// <param name="predicate">What to wait for.</param>
+    /// <returns>The predicate, as of the end of the wait; false on timeout.</returns>
+    template<typename TCondition, typename TLock, typename TPredicate>
+    bool WaitFor(TCondition &condition, TLock &lock, const long long nanoseconds, TPredicate predicate)
+    {
+        const long long deadline = Now() + nanoseconds;
+        while (!predicate())
+        {
+            const long long remaining = deadline - Now();
+            if (remaining <= 0) {
+                return predicate();
+            }
+
+            condition.wait_for(lock, std::chrono::nanoseconds(WaitSlice(remaining)));
+        }
+
+        return true;
+    }
+
+protected:
+
+    /// <summary>How long to block for at a time, in real time, while waiting for <paramref name="remaining" /> of this clock's.</summary>
+    virtual long long WaitSlice(long long remaining) const = 0;
+};
+
+
+/// <summary>Real time: std::chrono::steady_clock, and real sleeps.</summary>
+class SystemClock : public Clock
+{
+public:
+    long long Now() override;
+    void Sleep(long long nanoseconds) override;
+
+protected:
+    long long WaitSlice(const long long remaining) const override { return remaining; }
+};
+
+
+/// <summary>Virtual time: sleeps return as soon as every sleeper is asleep, with the clock moved on by the time skipped.</summary>
+/// <remarks>
+///     The virtual time is the real time plus all the time skipped so far.  Once no thread has gone to sleep or woken
+///     up for <see cref="SETTLE_NANOSECONDS"/>, every thread with a sleep to do is taken to be in it, and the clock
+///     skips ahead to the earliest wake-up among them.  Sleeps on different threads overlap, just as they would in real
+///     time, so the simulated wall time is what the run would have taken, give or take the work between the sleeps,
+///     which is done at real speed.  That is a fair model when the sleeps dominate, which is what it is for: a run
+///     whose whitespace would cost hours of sleep takes seconds.
+///     Timed waits see the skipped time, in steps of at most <see cref="SETTLE_NANOSECONDS"/>; they never skip any.
+/// </remarks>
+class VirtualClock : public Clock
+{
+public:
+    static const long long SETTLE_NANOSECONDS = 2000000;
+
+private:
+    std::atomic<long long>   _skipped;
+    std::mutex               _mutex;
+    std::condition_variable  _wakeCV;
+    std::multiset<long long> _wakeups;    // Of the sleepers, in virtual time.
+    unsigned                 _activity;   // Sleeps begun or ended; the clock only moves on while this stands still.
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="VirtualClock"/> class.</summary>
+    VirtualClock();
+
+    long long Now() override;
+    void Sleep(long long nanoseconds) override;
+
+    /// <summary>The time skipped so far.</summary>
+    long long SkippedNanoseconds() const { return _skipped; }
+
+
+    /// Block the copy constructor.
+    VirtualClock(VirtualClock &) = delete;
+
+    /// Block the copy assignment operator.
+    VirtualClock operator =(VirtualClock &) = delete;
+
+protected:
+    long long WaitSlice(long long remaining) const override;
+};
+
+#endif  // _CLOCK_H
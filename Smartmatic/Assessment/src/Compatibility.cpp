@@ -19,8 +19,13 @@
 #  include <windows.h>  // NOLINT(llvm-include-order)
 #  include <synchapi.h>
 #  include <corecrt_io.h>
+#  include <fcntl.h>
+#  include <process.h>
+#  include <sys/stat.h>
 #else
-#  include <io.h>
+#  include <fcntl.h>
+#  include <sys/stat.h>
+#  include <time.h>
 #  include <unistd.h>
 #endif
 
@@ -28,6 +33,15 @@
 
 #include "Compatibility.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <vector>
+
 
 bool FileExists(const std::string &filename)
 {
@@ -46,6 +60,352 @@ void MillisecondSleep(int milliseconds)
 #ifdef _MSC_VER
     Sleep(milliseconds);
 #else
-    usleep(milliseconds * 1000);
+    NanosecondSleep(milliseconds * 1000000LL);
+#endif
+}
+
+
+/// <summary>Nanoseconds sleep, against the monotonic clock where the platform has one.</summary>
+/// <param name="nanoseconds">The nanoseconds.</param>
+void NanosecondSleep(const long long nanoseconds)
+{
+    if (nanoseconds <= 0) {
+        return;
+    }
+
+#if defined(_MSC_VER)
+    // Whole milliseconds only; rounded up, so as never to wake early.
+    Sleep(static_cast<DWORD>((nanoseconds + 999999) / 1000000));
+#elif defined(__linux__)
+    // To an absolute deadline: a signal does not stretch the sleep (usleep() starts over), nor does a change of the
+    // wall clock shorten it.
+    static const long long NANOSECONDS_PER_SECOND = 1000000000;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    const long long nanosecond = deadline.tv_nsec + nanoseconds % NANOSECONDS_PER_SECOND;
+    deadline.tv_sec  += static_cast<time_t>(nanoseconds / NANOSECONDS_PER_SECOND + nanosecond / NANOSECONDS_PER_SECOND);
+    deadline.tv_nsec  = static_cast<long>(nanosecond % NANOSECONDS_PER_SECOND);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) { }
+#else
+    std::this_thread::sleep_for(std::chrono::nanoseconds(nanoseconds));
+#endif
+}
+
+
+#ifndef _MSC_VER
+/// <summary>Reads a cgroup CPU quota, in processors, rounded up.</summary>
+/// <returns>The quota, or 0 when there is none (or no cgroup file to read).</returns>
+static int CgroupProcessorQuota()
+{
+    // cgroup v2: "<quota> <period>" or "max <period>" in cpu.max, below the path named in /proc/self/cgroup ("0::<path>").
+    std::string   cgroupPath;
+    std::ifstream selfCgroup("/proc/self/cgroup");
+    for (std::string line; std::getline(selfCgroup, line); )
+    {
+        if (line.compare(0, 3, "0::") == 0) {
+            cgroupPath = line.substr(3);
+        }
+    }
+
+    long long quota  = -1;
+    long long period = 0;
+
+    std::ifstream cpuMax("/sys/fs/cgroup" + cgroupPath + "/cpu.max");
+    if (!cpuMax.is_open()) {
+        cpuMax.open("/sys/fs/cgroup/cpu.max");
+    }
+
+    std::string quotaText;
+    if (cpuMax >> quotaText >> period)
+    {
+        if (quotaText == "max") {
+            return 0;
+        }
+
+        quota = strtoll(quotaText.c_str(), nullptr, 10);
+    }
+    else
+    {
+        // cgroup v1.
+        std::ifstream quotaFile("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+        std::ifstream periodFile("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+        if (!(quotaFile >> quota) || !(periodFile >> period)) {
+            return 0;
+        }
+    }
+
+    if ((quota <= 0) || (period <= 0)) {
+        return 0;
+    }
+
+    return static_cast<int>((quota + period - 1) / period);
+}
+#endif
+
+
+/// <summary>The number of processors this process may actually use.</summary>
+/// <returns>std::thread::hardware_concurrency(), capped by any cgroup CPU quota; at least 1.</returns>
+int AvailableProcessorCount()
+{
+    int processors = static_cast<int>(std::thread::hardware_concurrency());
+    if (processors <= 0) {
+        processors = 1;
+    }
+
+#ifndef _MSC_VER
+    const int quota = CgroupProcessorQuota();
+    if ((quota > 0) && (quota < processors)) {
+        processors = quota;
+    }
+#endif
+
+    return processors;
+}
+
+
+/// <summary>Renames a file, replacing any file already at the new name in one step.</summary>
+/// <param name="from">The file.</param>
+/// <param name="to">The new name.</param>
+/// <returns>true / false - depending upon success.</returns>
+bool RenameFileOver(const std::string &from, const std::string &to)
+{
+#ifdef _MSC_VER
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    // POSIX rename() replaces the target atomically.
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+
+/// <summary>The directory for temporary files.</summary>
+/// <returns>TMPDIR (TEMP on Windows) if set, otherwise the platform default.</returns>
+std::string TemporaryDirectory()
+{
+#ifdef _MSC_VER
+    const char *directory = std::getenv("TEMP");
+    return ((nullptr != directory) && (*directory != '\0')) ? directory : ".";
+#else
+    const char *directory = std::getenv("TMPDIR");
+    return ((nullptr != directory) && (*directory != '\0')) ? directory : "/tmp";
+#endif
+}
+
+
+/// <summary>The id of this process, to keep temporary file names apart.</summary>
+int CurrentProcessId()
+{
+#ifdef _MSC_VER
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+}
+
+
+/// <summary>Tells the platform that a file is about to be read from start to end, so that it can read ahead.</summary>
+/// <param name="filename">The file.</param>
+/// <returns>true if the advice was given; nothing depends on it.</returns>
+bool AdviseSequentialRead(const std::string &filename)
+{
+    if (filename.empty()) {
+        return false;
+    }
+
+#ifdef __linux__
+    // Start pulling the head of the file into the page cache now, while the pipeline is still being set up; the rest
+    // follows by the kernel's own read-ahead.  Not the whole file: that may be bigger than the cache.
+    static const off_t PREFETCH_BYTES = 64 * 1024 * 1024;
+
+    const int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+
+    const bool advised = posix_fadvise(descriptor, 0, PREFETCH_BYTES, POSIX_FADV_WILLNEED) == 0;
+    close(descriptor);
+    return advised;
+#else
+    return false;
+#endif
+}
+
+
+/// <summary>Opens a file for reading, as a file descriptor.</summary>
+/// <param name="filename">The file.</param>
+/// <returns>The file descriptor; -1 on failure.</returns>
+int OpenFileForReading(const std::string &filename)
+{
+#ifdef _MSC_VER
+    return _open(filename.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return open(filename.c_str(), O_RDONLY);
+#endif
+}
+
+
+/// <summary>Creates (or truncates) a file for writing, as a file descriptor.</summary>
+/// <param name="filename">The file.</param>
+/// <returns>The file descriptor; -1 on failure.</returns>
+int CreateFileForWriting(const std::string &filename)
+{
+#ifdef _MSC_VER
+    return _open(filename.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+
+/// <summary>Closes a file descriptor.</summary>
+/// <param name="descriptor">The file descriptor.</param>
+/// <returns>true / false - depending upon success.</returns>
+bool CloseFile(const int descriptor)
+{
+#ifdef _MSC_VER
+    return _close(descriptor) == 0;
+#else
+    return close(descriptor) == 0;
 #endif
 }
+
+
+/// <summary>Writes a buffer at an offset in a file, without moving (or sharing) a file position: safe from any thread.</summary>
+/// <param name="descriptor">The file descriptor.</param>
+/// <param name="data">The data.</param>
+/// <param name="length">The data length.</param>
+/// <param name="offset">Where to write it.</param>
+/// <returns>true / false - depending upon success.</returns>
+bool WriteFileAt(const int descriptor, const char *data, size_t length, long long offset)
+{
+    while (length > 0)
+    {
+#ifdef _MSC_VER
+        OVERLAPPED position = {};
+        position.Offset     = static_cast<DWORD>(offset);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        DWORD written = 0;
+        const auto chunk = static_cast<DWORD>(std::min<size_t>(length, 1024 * 1024 * 1024));
+        if (!WriteFile(reinterpret_cast<HANDLE>(_get_osfhandle(descriptor)), data, chunk, &written, &position) || (written == 0)) {
+            return false;
+        }
+#else
+        const ssize_t written = pwrite(descriptor, data, length, static_cast<off_t>(offset));
+        if (written < 0)
+        {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+#endif
+
+        data   += written;
+        offset += written;
+        length -= static_cast<size_t>(written);
+    }
+
+    return true;
+}
+
+
+/// <summary>Sets aside disk space for a byte range of a file, growing it as need be (fallocate).</summary>
+/// <param name="descriptor">The file descriptor.</param>
+/// <param name="offset">The beginning of the range.</param>
+/// <param name="length">The length of the range.</param>
+/// <returns>true if the space was set aside; nothing depends on it, the writes themselves still get the space.</returns>
+bool PreallocateFile(const int descriptor, const long long offset, const long long length)
+{
+    if ((descriptor < 0) || (offset < 0) || (length <= 0)) {
+        return false;
+    }
+
+#ifdef __linux__
+    // In one piece where the file system can; and a file system that cannot does not pretend to (posix_fallocate() would
+    // write zeroes instead).
+    return fallocate(descriptor, 0, static_cast<off_t>(offset), static_cast<off_t>(length)) == 0;
+#else
+    // Not on this platform: the writes get their space as they go.
+    return false;
+#endif
+}
+
+
+/// <summary>Cuts a file to a length.</summary>
+/// <param name="descriptor">The file descriptor.</param>
+/// <param name="length">The length.</param>
+/// <returns>true / false - depending upon success.</returns>
+bool TruncateFile(const int descriptor, const long long length)
+{
+#ifdef _MSC_VER
+    return _chsize_s(descriptor, length) == 0;
+#else
+    return ftruncate(descriptor, static_cast<off_t>(length)) == 0;
+#endif
+}
+
+
+/// <summary>Copies a byte range of one file into another, inside the kernel where the platform can (copy_file_range).</summary>
+/// <param name="fromDescriptor">The file to copy from.</param>
+/// <param name="fromOffset">Where to copy from.</param>
+/// <param name="toDescriptor">The file to copy to.</param>
+/// <param name="toOffset">Where to copy to.</param>
+/// <param name="length">The number of bytes.</param>
+/// <returns>true / false - depending upon success.</returns>
+bool CopyFileRange(const int fromDescriptor, long long fromOffset, const int toDescriptor, long long toOffset, long long length)
+{
+#if defined(__linux__) && defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 27)))
+    // No copy through user space; on a file system with reflinks, not even a copy of the data.
+    while (length > 0)
+    {
+        loff_t from = fromOffset;
+        loff_t to   = toOffset;
+        const ssize_t copied = copy_file_range(fromDescriptor, &from, toDescriptor, &to, static_cast<size_t>(length), 0);
+        if (copied <= 0)
+        {
+            // Across file systems on older kernels, or not supported at all: fall back to reading and writing.
+            if ((copied < 0) && ((errno == EXDEV) || (errno == ENOSYS) || (errno == EINVAL) || (errno == EOPNOTSUPP))) {
+                break;
+            }
+
+            return false;
+        }
+
+        fromOffset += copied;
+        toOffset   += copied;
+        length     -= copied;
+    }
+
+    if (length == 0) {
+        return true;
+    }
+#endif
+
+    static const long long BUFFER_SIZE = 1024 * 1024;
+    std::vector<char> buffer(static_cast<size_t>(std::min(length, BUFFER_SIZE)));
+    while (length > 0)
+    {
+        const auto chunk = static_cast<unsigned>(std::min(length, BUFFER_SIZE));
+#ifdef _MSC_VER
+        if ((_lseeki64(fromDescriptor, fromOffset, SEEK_SET) < 0) || (_read(fromDescriptor, buffer.data(), chunk) != static_cast<int>(chunk)) ||
+            (_lseeki64(toDescriptor, toOffset, SEEK_SET) < 0) || (_write(toDescriptor, buffer.data(), chunk) != static_cast<int>(chunk))) {
+            return false;
+        }
+#else
+        if ((pread(fromDescriptor, buffer.data(), chunk, fromOffset) != static_cast<ssize_t>(chunk)) ||
+            (pwrite(toDescriptor, buffer.data(), chunk, toOffset) != static_cast<ssize_t>(chunk))) {
+            return false;
+        }
+#endif
+
+        fromOffset += chunk;
+        toOffset   += chunk;
+        length     -= chunk;
+    }
+
+    return true;
+}
@@ -24,5 +24,56 @@ bool FileExists(const std::string &filename);
 /// <param name="milliseconds">The milliseconds.</param>
 void MillisecondSleep(int milliseconds);
 
+/// <summary>Nanoseconds sleep, against the monotonic clock where the platform has one.</summary>
+/// <param name="nanoseconds">The nanoseconds.</param>
+void NanosecondSleep(long long nanoseconds);
+
+/// <summary>The number of processors this process may actually use.</summary>
+/// <returns>std::thread::hardware_concurrency(), capped by any cgroup CPU quota; at least 1.</returns>
+int AvailableProcessorCount();
+
+/// <summary>Renames a file, replacing any file already at the new name in one step.</summary>
+/// <returns>true / false - depending upon success.</returns>
+bool RenameFileOver(const std::string &from, const std::string &to);
+
+/// <summary>The directory for temporary files.</summary>
+/// <returns>TMPDIR (TEMP on Windows) if set, otherwise the platform default.</returns>
+std::string TemporaryDirectory();
+
+/// <summary>The id of this process, to keep temporary file names apart.</summary>
+int CurrentProcessId();
+
+/// <summary>Tells the platform that a file is about to be read from start to end, so that it can read ahead.</summary>
+/// <returns>true if the advice was given; nothing depends on it.</returns>
+bool AdviseSequentialRead(const std::string &filename);
+
+/// <summary>Opens a file for reading, as a file descriptor.</summary>
+/// <returns>The file descriptor; -1 on failure.</returns>
+int OpenFileForReading(const std::string &filename);
+
+/// <summary>Creates (or truncates) a file for writing, as a file descriptor.</summary>
+/// <returns>The file descriptor; -1 on failure.</returns>
+int CreateFileForWriting(const std::string &filename);
+
+/// <summary>Closes a file descriptor.</summary>
+/// <returns>true / false - depending upon success.</returns>
+bool CloseFile(int descriptor);
+
+/// <summary>Writes a buffer at an offset in a file, without moving (or sharing) a file position: safe from any thread.</summary>
+/// <returns>true / false - depending upon success.</returns>
+bool WriteFileAt(int descriptor, const char *data, size_t length, long long offset);
+
+/// <summary>Sets aside disk space for a byte range of a file, growing it as need be (fallocate).</summary>
+/// <returns>true if the space was set aside; nothing depends on it, the writes themselves still get the space.</returns>
+bool PreallocateFile(int descriptor, long long offset, long long length);
+
+/// <summary>Cuts a file to a length.</summary>
+/// <returns>true / false - depending upon success.</returns>
+bool TruncateFile(int descriptor, long long length);
+
+/// <summary>Copies a byte range of one file into another, inside the kernel where the platform can (copy_file_range).</summary>
+/// <returns>true / false - depending upon success.</returns>
+bool CopyFileRange(int fromDescriptor, long long fromOffset, int toDescriptor, long long toOffset, long long length);
+
 
 #endif  // _COMPATIBILITY_H
@@ -17,37 +17,190 @@
 #ifndef _ITEM_PRODCER_QUEUE_H
 #define _ITEM_PRODCER_QUEUE_H
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BoundedRingQueue.h"
+#include "Clock.h"
+#include "ProfiledMutex.h"
+#include "SlabArena.h"
+#include "WaitWord.h"
+
+
+/// <summary>The storage behind a <see cref="ConcurrentQueue"/>.</summary>
+enum QueueBackend
+{
+    /// <summary>A std::mutex around an unbounded std::queue.</summary>
+    MutexBackend = 0,
+
+    /// <summary>A lock-free bounded ring; see <see cref="BoundedRingQueue"/>.</summary>
+    RingBackend,
+
+    /// <summary>A std::mutex around a binary heap; the item with the lowest <see cref="QueuePriority"/> comes out first.</summary>
+    PriorityBackend
+};
+
+// The compile-time default backend; overridden at startup with "--queue=".
+#ifndef DEFAULT_QUEUE_BACKEND
+#  define DEFAULT_QUEUE_BACKEND MutexBackend
+#endif
+
+
+/// <summary>The priority of an item in a <see cref="PriorityBackend"/> queue; lower comes out first.</summary>
+/// <remarks>Item types with a priority provide an overload, found by argument-dependent lookup.  Everything else is FIFO.</remarks>
+template<typename TWorkItem> long long QueuePriority(const TWorkItem & /*workItem*/)
+{
+    return 0;
+}
+
+
+/// <summary>Returns the supported queue backends.</summary>
+inline std::string SupportedQueueBackends()
+{
+    return "mutex | ring";
+}
+
+
+/// <summary>Translate the string to a queue backend.</summary>
+/// <remarks>The priority backend is not offered here; it comes with the head-of-line scheduler.</remarks>
+/// <param name="backendName">The backend name.</param>
+/// <param name="backend">The backend, when recognized.</param>
+/// <returns>true / false - depending upon success.</returns>
+inline bool ToQueueBackend(const std::string &backendName, QueueBackend &backend)
+{
+    if (backendName == "mutex") {
+        backend = MutexBackend;
+        return true;
+    }
+
+    if (backendName == "ring") {
+        backend = RingBackend;
+        return true;
+    }
+
+    return false;
+}
 
 
 /// <summary> The Producer portion of the requisite asynchronous Producer / Consumer design pattern. </summary>
 /// <remarks>
 ///     <code> https://codereview.stackexchange.com/questions/177650/a-simple-implementation-of-the-producer-consumer-pattern </code>
+///     The storage is chosen once, at construction.  The ring backend is bounded, so a producer that outruns the
+///     consumers by more than the ring capacity waits until a cell frees up.
+///     The mutex backend's std::deque draws its blocks from a slab arena owned by the queue, so that a steady flow of
+///     items through the queue does not keep going back to the system allocator.
+///     The priority backend pops the lowest <see cref="QueuePriority"/> first, FIFO among equals.
+///     Consumers that find the queue empty (and producers that find the ring full) spin briefly and then park on a
+///     <see cref="WaitWord"/>, without holding the queue's lock; the other side only wakes them when somebody is
+///     actually parked, and never takes the lock to do it.
 /// </remarks>
 template<typename TWorkItem> class ConcurrentQueue
 {
+public:
+    static const size_t DEFAULT_RING_CAPACITY = 1024;
+    static const int    SPIN_COUNT            = 64;
+
 private:
 
-    std::mutex            _mutex;
-    std::queue<TWorkItem> _queue;
+    const QueueBackend _backend;
+
+    /// <summary>An item in the priority backend's heap.</summary>
+    struct PrioritizedItem
+    {
+        long long          Priority;
+        unsigned long long Sequence;   // Push order, to keep items of equal priority FIFO.
+        TWorkItem          Item;
+
+        /// <summary>Heap order: std::push_heap() keeps the greatest on top, so "greater" here means "comes out later".</summary>
+        static bool ComesOutLater(const PrioritizedItem &lhs, const PrioritizedItem &rhs)
+        {
+            return (lhs.Priority != rhs.Priority) ? (lhs.Priority > rhs.Priority) : (lhs.Sequence > rhs.Sequence);
+        }
+    };
+
+    using deque_t = std::deque<TWorkItem, SlabAllocator<TWorkItem>>;
+
+    pipeline_mutex_t               _mutex;
+    SlabArena                      _arena;   // Has to be initialized before _queue.
+    std::queue<TWorkItem, deque_t> _queue;
+    std::vector<PrioritizedItem>   _heap;
+    unsigned long long             _pushSequence;
+
+    std::unique_ptr<BoundedRingQueue<TWorkItem>> _ring;
+
+    // Parked consumers, parked producers (ring backend only), and threads waiting for the queue to drain.
+    WaitWord             _itemsPushed;   // Event counts: a change only says "look again".
+    WaitWord             _itemsPopped;
+    pipeline_condition_t _emptyCV;
+    std::atomic<int>     _itemWaiters;
+    std::atomic<int>     _spaceWaiters;
+    std::atomic<int>     _emptyWaiters;
 
 public:
 
     /// <summary>Initializes a new instance of the <see cref="ConcurrentQueue"/> class.</summary>
-    ConcurrentQueue()
-        : _queue()
-    { }
+    /// <param name="backend">The storage backend.</param>
+    /// <param name="ringCapacity">The ring capacity, for the ring backend only.</param>
+    explicit ConcurrentQueue(const QueueBackend backend = DEFAULT_QUEUE_BACKEND, const size_t ringCapacity = DEFAULT_RING_CAPACITY)
+        : _backend(backend),
+          _queue(deque_t(SlabAllocator<TWorkItem>(&_arena))),
+          _pushSequence(0),
+          _itemWaiters(0),
+          _spaceWaiters(0),
+          _emptyWaiters(0)
+    {
+        NameMutex(_mutex, "queue");
+        if (_backend == RingBackend) {
+            _ring = std::make_unique<BoundedRingQueue<TWorkItem>>(ringCapacity);
+        }
+    }
+
+
+    /// <summary>The storage backend in use.</summary>
+    QueueBackend Backend() const { return _backend; }
+
+
+    /// <summary>Names the queue's lock in the lock profile (PROFILE_LOCKS builds); "queue" by default.</summary>
+    /// <param name="name">The name.</param>
+    void ProfileAs(const char *name) { NameMutex(_mutex, name); }
 
 
     /// <summary>Determines whether this queue is empty.</summary>
     /// <returns> true or false as appropriate.</returns>
     bool IsEmpty()
     {
+        if (_backend == RingBackend) {
+            return _ring->IsEmpty();
+        }
+
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<pipeline_mutex_t> lock(_mutex);
+
+        return IsEmptyLocked();
+    }
+
+
+    /// <summary>The number of items in the queue.</summary>
+    /// <returns>Only a snapshot while other threads are active.</returns>
+    size_t ApproximateSize()
+    {
+        if (_backend == RingBackend) {
+            return _ring->Size();
+        }
+
         // Lock will be released as soon as it goes out of scope.
-        std::lock_guard<std::mutex> lock(_mutex);
+        std::lock_guard<pipeline_mutex_t> lock(_mutex);
 
-        return _queue.empty();
+        return (_backend == PriorityBackend) ? _heap.size() : _queue.size();
     }
 
 
@@ -55,9 +208,155 @@ public:
     /// <param name="workItem">The work item.</param>
     /// <returns>true / false - depending upon success.</returns>
     bool TryPop(TWorkItem & workItem)
+    {
+        bool popped;
+        if (_backend == RingBackend) {
+            popped = _ring->TryPop(workItem);
+        }
+        else
+        {
+            // Lock will be released as soon as it goes out of scope.
+            std::lock_guard<pipeline_mutex_t> lock(_mutex);
+
+            popped = PopLocked(workItem);
+        }
+
+        if (popped) {
+            NotifyAfterPop();
+        }
+
+        return popped;
+    }
+
+
+    /// <summary>Pops an item from the producer queue, parking the calling thread until one is available.</summary>
+    /// <param name="workItem">The work item.</param>
+    /// <param name="keepWaiting">Checked while parked; once false, give up.  Change it, then call <see cref="WakeAll"/>.</param>
+    /// <returns>true if an item was popped; false if <paramref name="keepWaiting" /> went false first.</returns>
+    bool WaitAndPop(TWorkItem & workItem, const std::atomic<bool> &keepWaiting)
+    {
+        // Spin first: an item is often only a moment away, and parking costs two context switches.
+        for (auto spin = 0; spin < SPIN_COUNT; ++spin)
+        {
+            if (TryPop(workItem)) {
+                return true;
+            }
+
+            if (!keepWaiting) {
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+
+        for (;;)
+        {
+            // Announce ourselves before the final check, so that a producer either sees us or we see its item.
+            const int pushes = _itemsPushed.Load();
+            ++_itemWaiters;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            const bool popped = TryPop(workItem);
+            if (popped || !keepWaiting)
+            {
+                --_itemWaiters;
+                return popped;
+            }
+
+            _itemsPushed.WaitWhileEqual(pushes);
+            --_itemWaiters;
+        }
+    }
+
+
+    /// <summary>Pushes the specified item into the producer queue.</summary>
+    /// <param name="item">The item.</param>
+    void Push(TWorkItem && item)
+    {
+        if (_backend == RingBackend) {
+            PushRing(std::move(item));
+        }
+        else
+        {
+            // Lock will be released as soon as it goes out of scope.
+            std::lock_guard<pipeline_mutex_t> lock(_mutex);
+
+            if (_backend == PriorityBackend)
+            {
+                const long long priority = QueuePriority(item);
+                _heap.push_back(PrioritizedItem { priority, _pushSequence++, std::move(item) });
+                std::push_heap(_heap.begin(), _heap.end(), &PrioritizedItem::ComesOutLater);
+            }
+            else {
+                _queue.push(std::move(item));
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_itemWaiters > 0) {
+            _itemsPushed.Increment(false);
+        }
+    }
+
+
+    /// <summary>Wakes every parked consumer so that it re-checks its keepWaiting flag.</summary>
+    void WakeAll()
+    {
+        _itemsPushed.Increment(true);
+    }
+
+
+    /// <summary>Waits for the queue to empty.</summary>
+    /// <param name="timeout">The longest time to wait.</param>
+    /// <returns>true if the queue emptied; false on timeout.</returns>
+    bool WaitUntilEmpty(const std::chrono::milliseconds timeout)
     {
         // Lock will be released as soon as it goes out of scope.
-        std::lock_guard<std::mutex> lock(_mutex);
+        std::unique_lock<pipeline_mutex_t> lock(_mutex);
+
+        // Counted as a waiter throughout, so that every change of the queue is announced to us.
+        ++_emptyWaiters;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const long long timeoutNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+        const bool      isEmpty            = Clock::Current().WaitFor(_emptyCV, lock, timeoutNanoseconds, [this]{ return IsEmptyLocked(); });
+        --_emptyWaiters;
+        return isEmpty;
+    }
+
+private:
+
+    /// <summary>Determines whether this queue is empty; for the mutex and priority backends, the caller holds <see cref="_mutex"/>.</summary>
+    bool IsEmptyLocked() const
+    {
+        switch (_backend)
+        {
+        case RingBackend:
+            return _ring->IsEmpty();
+
+        case PriorityBackend:
+            return _heap.empty();
+
+        default:
+            return _queue.empty();
+        }
+    }
+
+
+    /// <summary>Pops from the mutex or priority backend; the caller holds <see cref="_mutex"/>.</summary>
+    bool PopLocked(TWorkItem & workItem)
+    {
+        if (_backend == PriorityBackend)
+        {
+            if (_heap.empty()) {
+                return false;
+            }
+
+            std::pop_heap(_heap.begin(), _heap.end(), &PrioritizedItem::ComesOutLater);
+            workItem = std::move(_heap.back().Item);
+            _heap.pop_back();
+            return true;
+        }
 
         if (_queue.empty()) {
             return false;
@@ -69,14 +368,56 @@ public:
     }
 
 
-    /// <summary>Pushes the specified item into the producer queue.</summary>
-    /// <param name="item">The item.</param>
-    void Push(TWorkItem && item)
+    /// <summary>Pushes into the ring, parking the calling thread while the ring is full.</summary>
+    void PushRing(TWorkItem && item)
     {
-        // Lock will be released as soon as it goes out of scope.
-        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto spin = 0; spin < SPIN_COUNT; ++spin)
+        {
+            if (_ring->TryPush(std::move(item))) {
+                return;
+            }
+
+            std::this_thread::yield();
+        }
 
-        _queue.push(std::move(item));
+        for (;;)
+        {
+            const int pops = _itemsPopped.Load();
+            ++_spaceWaiters;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (_ring->TryPush(std::move(item)))
+            {
+                --_spaceWaiters;
+                return;
+            }
+
+            _itemsPopped.WaitWhileEqual(pops);
+            --_spaceWaiters;
+        }
+    }
+
+
+    /// <summary>
+    ///     Wakes a producer parked on a full ring, and anybody waiting in <see cref="WaitUntilEmpty"/> once the
+    ///     last item has been taken.
+    /// </summary>
+    void NotifyAfterPop()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_spaceWaiters > 0) {
+            _itemsPopped.Increment(false);
+        }
+
+        if (_emptyWaiters > 0)
+        {
+            // Lock will be released as soon as it goes out of scope.
+            std::lock_guard<pipeline_mutex_t> lock(_mutex);
+
+            if (IsEmptyLocked()) {
+                _emptyCV.notify_all();
+            }
+        }
     }
 };
 
@@ -0,0 +1,322 @@
+// =============================================================================================================================================
+// <copyright file="ExternalSorter.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: ExternalSorter.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 9:40 PM
+//  Purpose: Sorts more lines than fit in memory: sorted runs spilled to temporary files, then a k-way merge.
+// </summary>
+// =============================================================================================================================================
+
+#include "ExternalSorter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "Algorithms/LoserTree.h"
+#include "Compatibility.h"
+
+
+const size_t ExternalSorter::MIN_IO_BUFFER;
+const size_t ExternalSorter::MAX_IO_BUFFER;
+const size_t ExternalSorter::MAX_MERGE_WIDTH;
+
+// Numbers the sorters of this process, for their run file names.
+static std::atomic<int> s_sorterCount(0);
+
+
+/// <summary>Reads back a sorted run, from its file or from memory, one line at a time.</summary>
+class ExternalSorter::RunReader
+{
+private:
+    std::unique_ptr<char[]>   _buffer;
+    std::ifstream             _file;
+    std::string               _line;
+    std::vector<std::string> *_lines;   // A run still in memory; nullptr for a file.
+    size_t                    _next;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="RunReader"/> class, for a run file.</summary>
+    /// <param name="path">The run file.</param>
+    /// <param name="bufferSize">The read buffer size.</param>
+    RunReader(const std::string &path, const size_t bufferSize)
+        : _buffer(new char[bufferSize]),
+          _lines(nullptr),
+          _next(0)
+    {
+        // The buffer has to be in place before the file is opened.
+        _file.rdbuf()->pubsetbuf(_buffer.get(), static_cast<std::streamsize>(bufferSize));
+        _file.open(path, std::ios::binary);
+    }
+
+
+    /// <summary>Initializes a new instance of the <see cref="RunReader"/> class, for a sorted run in memory.</summary>
+    /// <param name="lines">The run.</param>
+    explicit RunReader(std::vector<std::string> &lines)
+        : _lines(&lines),
+          _next(0)
+    { }
+
+
+    /// <summary>Whether the run can be read.</summary>
+    bool IsOpen() const { return (nullptr != _lines) || _file.is_open(); }
+
+    /// <summary>Whether reading the run failed, rather than just ran out.</summary>
+    bool Failed() const { return (nullptr == _lines) && _file.bad(); }
+
+
+    /// <summary>The next line of the run.</summary>
+    /// <returns>The line, valid until the next call; nullptr at the end of the run.</returns>
+    const std::string *Next()
+    {
+        if (nullptr != _lines) {
+            return (_next < _lines->size()) ? &(*_lines)[_next++] : nullptr;
+        }
+
+        return std::getline(_file, _line) ? &_line : nullptr;
+    }
+
+
+    RunReader(RunReader &) = delete;
+    RunReader operator =(RunReader &) = delete;
+};
+
+
+/// <summary>Initializes a new instance of the <see cref="ExternalSorter"/> class.</summary>
+/// <param name="memoryBudget">The memory to keep the runs in, in bytes.</param>
+/// <param name="addingThreads">The most threads adding lines at the same time.</param>
+/// <param name="tempDirectory">Where to put the run files.</param>
+/// <param name="sortRun">Sorts a run.</param>
+/// <param name="sortContext">The context of <paramref name="sortRun"/>.</param>
+ExternalSorter::ExternalSorter(const size_t memoryBudget, const int addingThreads, const std::string &tempDirectory,
+                               const run_sort_t sortRun, void *sortContext)
+    : _memoryBudget(memoryBudget),
+      _runLimit(std::max<size_t>(memoryBudget / (std::max(addingThreads, 1) + 1), 1)),   // Every thread may be sorting one, while one fills.
+      _tempDirectory(tempDirectory),
+      _sortRun(sortRun),
+      _sortContext(sortContext),
+      _sorterId(++s_sorterCount),
+      _runBytes(0),
+      _runsCreated(0),
+      _failed(false)
+{ }
+
+
+/// <summary>Finalizes an instance of the <see cref="ExternalSorter"/> class, removing its run files.</summary>
+ExternalSorter::~ExternalSorter()
+{
+    for (const auto &path : _runFiles) {
+        std::remove(path.c_str());
+    }
+}
+
+
+/// <summary>Adds a line; spilling the current run, sorted, if the line fills it.</summary>
+/// <param name="line">The line, without its line end.</param>
+/// <returns>true / false - false if a run could not be spilled; <see cref="Merge"/> reports that too.</returns>
+bool ExternalSorter::Add(std::string &&line)
+{
+    // The sort is lost already; don't hold on to the rest of the input.
+    if (_failed) {
+        return false;
+    }
+
+    std::vector<std::string> run;
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _runBytes += line.size() + sizeof(std::string);
+        _run.push_back(std::move(line));
+        if (_runBytes < _runLimit) {
+            return true;
+        }
+
+        run.swap(_run);
+        _runBytes = 0;
+    }
+
+    // Sorted and written by the thread that filled it, while the other threads go on filling the next one.
+    return SpillRun(run);
+}
+
+
+/// <summary>Merges every line added, in order, into the output; each followed by '\n'.</summary>
+/// <param name="output">The output stream.</param>
+/// <param name="bytesWritten">The bytes written to the output.</param>
+/// <returns>If less than zero, any associated error code: -12 for the output, -15 for a run file.</returns>
+/// <remarks>Call once, after the last <see cref="Add"/> has returned.</remarks>
+int ExternalSorter::Merge(std::ostream &output, size_t &bytesWritten)
+{
+    bytesWritten = 0;
+    if (_failed) {
+        return -15;
+    }
+
+    _sortRun(_sortContext, _run);
+
+    // Too many runs for one pass: merge the oldest ones into a run of their own, until the rest fit.
+    while (_runFiles.size() + 1 > MAX_MERGE_WIDTH)
+    {
+        std::vector<std::unique_ptr<RunReader>> readers;
+        for (size_t i = 0; i < MAX_MERGE_WIDTH; ++i)
+        {
+            // A run that cannot be read must not be merged as an empty one, and then deleted.
+            readers.emplace_back(new RunReader(_runFiles[i], IoBufferSize(MAX_MERGE_WIDTH + 1)));
+            if (!readers.back()->IsOpen())
+            {
+                std::cerr << "Error opening sort run file '" << _runFiles[i] << "'." << std::endl;
+                return -15;
+            }
+        }
+
+        const std::string path = NewRunPath();
+        std::ofstream     runFile(path, std::ios::binary);
+        if (!runFile.is_open())
+        {
+            std::cerr << "Error creating sort run file '" << path << "'." << std::endl;
+            return -15;
+        }
+
+        size_t runBytes = 0;
+        if (!MergeRuns(readers, runFile, runBytes))
+        {
+            std::cerr << "Error merging sort run files into '" << path << "'." << std::endl;
+            runFile.close();
+            std::remove(path.c_str());
+            return -15;
+        }
+
+        readers.clear();
+        for (size_t i = 0; i < MAX_MERGE_WIDTH; ++i) {
+            std::remove(_runFiles[i].c_str());
+        }
+
+        _runFiles.erase(_runFiles.begin(), _runFiles.begin() + MAX_MERGE_WIDTH);
+        _runFiles.push_back(path);
+    }
+
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (const auto &path : _runFiles)
+    {
+        readers.emplace_back(new RunReader(path, IoBufferSize(_runFiles.size())));
+        if (!readers.back()->IsOpen())
+        {
+            std::cerr << "Error opening sort run file '" << path << "'." << std::endl;
+            return -15;
+        }
+    }
+
+    readers.emplace_back(new RunReader(_run));
+    if (MergeRuns(readers, output, bytesWritten)) {
+        return 0;
+    }
+
+    return output.bad() ? -12 : -15;
+}
+
+
+/// <summary>The size of each I/O buffer, when this many files are open at the same time.</summary>
+/// <param name="openFiles">The number of files open at the same time.</param>
+size_t ExternalSorter::IoBufferSize(const size_t openFiles) const
+{
+    return std::min(std::max(_memoryBudget / std::max<size_t>(openFiles, 1), MIN_IO_BUFFER), MAX_IO_BUFFER);
+}
+
+
+/// <summary>Merges sorted runs into a stream.</summary>
+/// <param name="readers">The runs.</param>
+/// <param name="output">The output stream.</param>
+/// <param name="bytesWritten">The bytes written to the output.</param>
+/// <returns>true / false - depending upon success.</returns>
+bool ExternalSorter::MergeRuns(std::vector<std::unique_ptr<RunReader>> &readers, std::ostream &output, size_t &bytesWritten) const
+{
+    std::vector<const std::string *> heads;
+    for (auto &reader : readers) {
+        heads.push_back(reader->Next());
+    }
+
+    // The output goes out in large writes, whatever the stream's own buffer.
+    const size_t chunkSize = IoBufferSize(readers.size() + 1);
+    std::string  chunk;
+    chunk.reserve(chunkSize + MIN_IO_BUFFER);
+
+    Algorithms::LoserTree<std::string> tree(std::move(heads));
+    for (auto winner = tree.Winner(); winner >= 0; winner = tree.Winner())
+    {
+        chunk += *tree.WinnerKey();
+        chunk += '\n';
+        if (chunk.size() >= chunkSize)
+        {
+            output.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            bytesWritten += chunk.size();
+            chunk.clear();
+        }
+
+        tree.ReplaceWinner(readers[winner]->Next());
+    }
+
+    output.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    output.flush();
+    bytesWritten += chunk.size();
+
+    const bool readFailed = std::any_of(readers.begin(), readers.end(), [](const std::unique_ptr<RunReader> &reader){ return reader->Failed(); });
+    return !readFailed && !output.bad();
+}
+
+
+/// <summary>The path of a new run file.</summary>
+std::string ExternalSorter::NewRunPath()
+{
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return _tempDirectory + "/assessment-" + std::to_string(CurrentProcessId()) + "-" + std::to_string(_sorterId) + "-"
+         + std::to_string(++_runsCreated) + ".run";
+}
+
+
+/// <summary>Sorts a run, and writes it to a new run file.</summary>
+/// <param name="run">The run.</param>
+/// <returns>true / false - depending upon success.</returns>
+bool ExternalSorter::SpillRun(std::vector<std::string> &run)
+{
+    _sortRun(_sortContext, run);
+
+    const std::string path = NewRunPath();
+    std::ofstream     runFile(path, std::ios::binary);
+    if (!runFile.is_open())
+    {
+        std::cerr << "Error creating sort run file '" << path << "'." << std::endl;
+        _failed = true;
+        return false;
+    }
+
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _runFiles.push_back(path);
+    }
+
+    std::vector<std::unique_ptr<RunReader>> readers;
+    readers.emplace_back(new RunReader(run));
+
+    size_t runBytes = 0;
+    if (!MergeRuns(readers, runFile, runBytes))
+    {
+        std::cerr << "Error writing sort run file '" << path << "'." << std::endl;
+        _failed = true;
+        return false;
+    }
+
+    return true;
+}
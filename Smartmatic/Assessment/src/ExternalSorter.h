@@ -0,0 +1,114 @@
+// =============================================================================================================================================
+// <copyright file="ExternalSorter.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: ExternalSorter.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 9:40 PM
+//  Purpose: Sorts more lines than fit in memory: sorted runs spilled to temporary files, then a k-way merge.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _EXTERNAL_SORTER_H
+#define _EXTERNAL_SORTER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+/// <summary>Sorts more lines than fit in memory: sorted runs spilled to temporary files, then a k-way merge.</summary>
+/// <remarks>
+///     Any number of threads add lines.  The thread whose line fills the current run takes the run out, sorts it and
+///     writes it to a temporary file, while the other threads go on filling the next run; so runs are sorted in parallel,
+///     and at most one run per adding thread, plus the one being filled, is ever held in memory.
+///     The merge streams the output: the runs are read back with large buffers, and the smallest head among them is
+///     picked by a <see cref="Algorithms::LoserTree"/>.  More than <see cref="MAX_MERGE_WIDTH"/> runs take intermediate
+///     passes, each merging that many runs into one.  The last run is never spilled; it is merged straight from memory.
+///     Lines are compared byte by byte (std::string order).
+/// </remarks>
+class ExternalSorter
+{
+public:
+    using run_sort_t = void (*)(void *context, std::vector<std::string> &run);
+
+    // The I/O buffer of each run file being read, and of each chunk written, is the memory budget shared out, within these.
+    static const size_t MIN_IO_BUFFER = 64 * 1024;
+    static const size_t MAX_IO_BUFFER = 4 * 1024 * 1024;
+
+    // The most runs merged in one pass; there is an open file for each.
+    static const size_t MAX_MERGE_WIDTH = 128;
+
+private:
+    /// <summary>Reads back a sorted run, from its file or from memory, one line at a time.</summary>
+    class RunReader;
+
+    const size_t _memoryBudget;
+    const size_t _runLimit;        // Bytes of lines (and their bookkeeping) per run.
+    const std::string _tempDirectory;
+    const run_sort_t  _sortRun;
+    void       *const _sortContext;
+    const int         _sorterId;   // Keeps the run files of several sorters in one process apart.
+
+    std::mutex               _mutex;
+    std::vector<std::string> _run;        // The run being filled.
+    size_t                   _runBytes;
+    std::vector<std::string> _runFiles;   // The sorted runs spilled so far.
+    int                      _runsCreated;
+    std::atomic<bool>        _failed;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="ExternalSorter"/> class.</summary>
+    /// <param name="memoryBudget">The memory to keep the runs in, in bytes.</param>
+    /// <param name="addingThreads">The most threads adding lines at the same time.</param>
+    /// <param name="tempDirectory">Where to put the run files.</param>
+    /// <param name="sortRun">Sorts a run.</param>
+    /// <param name="sortContext">The context of <paramref name="sortRun"/>.</param>
+    ExternalSorter(size_t memoryBudget, int addingThreads, const std::string &tempDirectory, run_sort_t sortRun, void *sortContext);
+
+    /// <summary>Finalizes an instance of the <see cref="ExternalSorter"/> class, removing its run files.</summary>
+    ~ExternalSorter();
+
+    /// <summary>Adds a line; spilling the current run, sorted, if the line fills it.</summary>
+    bool Add(std::string &&line);
+
+    /// <summary>Merges every line added, in order, into the output; each followed by '\n'.</summary>
+    int Merge(std::ostream &output, size_t &bytesWritten);
+
+
+    /// Block the copy constructor.
+    ExternalSorter(ExternalSorter &) = delete;
+
+    /// Block the move constructor.
+    ExternalSorter(ExternalSorter &&) = delete;
+
+    /// Block the copy assignment operator.
+    ExternalSorter operator =(ExternalSorter &) = delete;
+
+    /// Block the move assignment operator.
+    ExternalSorter operator =(ExternalSorter &&) = delete;
+
+private:
+
+    /// <summary>The size of each I/O buffer, when this many files are open at the same time.</summary>
+    size_t IoBufferSize(size_t openFiles) const;
+
+    /// <summary>Merges sorted runs into a stream.</summary>
+    bool MergeRuns(std::vector<std::unique_ptr<RunReader>> &readers, std::ostream &output, size_t &bytesWritten) const;
+
+    /// <summary>The path of a new run file.</summary>
+    std::string NewRunPath();
+
+    /// <summary>Sorts a run, and writes it to a new run file.</summary>
+    bool SpillRun(std::vector<std::string> &run);
+};
+
+#endif  // _EXTERNAL_SORTER_H
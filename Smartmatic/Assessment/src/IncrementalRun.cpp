@@ -0,0 +1,363 @@
+// =============================================================================================================================================
+// <copyright file="IncrementalRun.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: IncrementalRun.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 10:30 PM
+//  Purpose: "--incremental": reprocesses only the lines which changed since the previous run, and copies the rest.
+// </summary>
+// =============================================================================================================================================
+
+#include "IncrementalRun.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+#include "Compatibility.h"
+#include "OutputIndex.h"
+#include "ProcessInputFile.h"
+
+
+const uint32_t IncrementalRun::VERSION;
+const uint32_t IncrementalRun::MODE_TOKENS;
+
+static_assert(sizeof(IncrementalManifestHeader) == 32, "The manifest file header is 32 bytes.");
+static_assert(sizeof(IncrementalManifestEntry) == 16, "A manifest file entry is 16 bytes.");
+
+
+/// <param name="inputFile">The input file.</param>
+/// <param name="outputFile">The output file; also the previous output.</param>
+/// <param name="sortAlgorithm">The sort algorithm.</param>
+/// <param name="options">The run-time options; <see cref="ProcessOptions::ManifestFile"/> names the manifest.</param>
+IncrementalRun::IncrementalRun(const std::string &inputFile, const std::string &outputFile, const Algorithms::SortAlgorithm sortAlgorithm,
+                               const ProcessOptions &options)
+    : _inputFile(inputFile),
+      _outputFile(outputFile),
+      _sortAlgorithm(sortAlgorithm),
+      _options(options),
+      _previousOutputSize(0),
+      _linesReprocessed(0)
+{ }
+
+
+/// <summary>Processes this instance.</summary>
+/// <returns>Error Code if less than 0.</returns>
+int IncrementalRun::Process()
+{
+    int errorCode = ReadInput();
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    LoadManifest();
+
+    // Any line seen in the previous run, wherever it was, has its result there already.
+    std::unordered_map<uint64_t, size_t> previousLines;
+    for (size_t i = 0; i < _previous.size(); ++i) {
+        previousLines.emplace(_previous[i].Hash, i);
+    }
+
+    std::vector<ResultSpan> spans(_lines.size());
+    std::vector<size_t>     changed;
+    for (size_t i = 0; i < _lines.size(); ++i)
+    {
+        const auto previous = previousLines.find(_hashes[i]);
+        if (previous == previousLines.end())
+        {
+            spans[i].FromPrevious = false;
+            changed.push_back(i);
+            continue;
+        }
+
+        const size_t   j   = previous->second;
+        const uint64_t end = (j + 1 < _previous.size()) ? _previous[j + 1].Offset : _previousOutputSize;
+        spans[i] = ResultSpan { true, _previous[j].Offset, end - _previous[j].Offset };
+    }
+
+    _linesReprocessed = changed.size();
+
+    const std::string deltaFile = _outputFile + ".delta";
+    if (!changed.empty())
+    {
+        std::vector<uint64_t> deltaOffsets;
+        errorCode = ProcessChangedLines(changed, deltaFile, deltaOffsets);
+        if (errorCode < 0) {
+            return errorCode;
+        }
+
+        for (size_t k = 0; k < changed.size(); ++k) {
+            spans[changed[k]] = ResultSpan { false, deltaOffsets[k], deltaOffsets[k + 1] - deltaOffsets[k] };
+        }
+    }
+
+    errorCode = AssembleOutput(spans, deltaFile);
+    std::remove(deltaFile.c_str());
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    errorCode = WriteManifest(spans);
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    if (_options.ConsoleReports) {
+        std::cout << "Incremental: " << _linesReprocessed << " of " << _lines.size() << " lines reprocessed, the rest copied." << std::endl;
+    }
+
+    return 0;
+}
+
+
+/// <summary>Puts the new output together from the result spans.</summary>
+/// <param name="spans">Where each line's result comes from.</param>
+/// <param name="deltaFile">The results of the changed lines.</param>
+/// <returns>Error Code if less than 0.</returns>
+int IncrementalRun::AssembleOutput(const std::vector<ResultSpan> &spans, const std::string &deltaFile)
+{
+    // The previous output is read while the new one is written; the new one takes its place when it is complete.
+    const std::string temporaryFile = _outputFile + ".incremental";
+    const int previous  = _previous.empty() ? -1 : OpenFileForReading(_outputFile);
+    const int delta     = (_linesReprocessed > 0) ? OpenFileForReading(deltaFile) : -1;
+    const int assembled = CreateFileForWriting(temporaryFile);
+
+    bool succeeded = (assembled >= 0) && (_previous.empty() || (previous >= 0)) && ((_linesReprocessed == 0) || (delta >= 0));
+
+    // Adjacent spans of the same file are copied in one go: unchanged stretches of the input, and runs of changed lines.
+    uint64_t written = 0;
+    for (size_t i = 0; succeeded && (i < spans.size()); )
+    {
+        const bool fromPrevious = spans[i].FromPrevious;
+        const auto offset       = spans[i].Offset;
+        uint64_t   length       = spans[i].Length;
+        for (++i; (i < spans.size()) && (spans[i].FromPrevious == fromPrevious) && (spans[i].Offset == offset + length); ++i) {
+            length += spans[i].Length;
+        }
+
+        succeeded = CopyFileRange(fromPrevious ? previous : delta, static_cast<long long>(offset), assembled,
+                                  static_cast<long long>(written), static_cast<long long>(length));
+        written  += length;
+    }
+
+    for (const int descriptor : { previous, delta })
+    {
+        if (descriptor >= 0) {
+            CloseFile(descriptor);
+        }
+    }
+
+    succeeded = (assembled >= 0) && CloseFile(assembled) && succeeded;
+
+    // The previous manifest describes the output about to be replaced, and a changed output can have the same size; it goes
+    // first, so that a run cut short from here on leaves no manifest at all, and the next run is a full one.
+    if (succeeded && (std::remove(_options.ManifestFile.c_str()) != 0) && (errno != ENOENT))
+    {
+        std::cerr << "Error removing manifest file '" << _options.ManifestFile << "'." << std::endl;
+        std::remove(temporaryFile.c_str());
+        return -17;
+    }
+
+    if (!succeeded || !RenameFileOver(temporaryFile, _outputFile))
+    {
+        std::cerr << "Error writing output file '" << _outputFile << "'." << std::endl;
+        std::remove(temporaryFile.c_str());
+        return -12;
+    }
+
+    return 0;
+}
+
+
+/// <summary>The content hash of a line (64-bit FNV-1a).</summary>
+/// <param name="line">The line.</param>
+/// <returns>The hash.</returns>
+uint64_t IncrementalRun::HashLine(const std::string &line)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto c : line)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
+/// <summary>Loads the previous run's manifest, if there is a usable one.</summary>
+void IncrementalRun::LoadManifest()
+{
+    _previous.clear();
+
+    std::ifstream manifest(_options.ManifestFile, std::ios::binary);
+    IncrementalManifestHeader header;
+    if (!manifest.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        return;
+    }
+
+    const uint32_t mode = _options.Tokens ? MODE_TOKENS : 0;
+    if ((memcmp(header.Magic, Magic(), sizeof(header.Magic)) != 0) || (header.Version != VERSION) || (header.Mode != mode) ||
+        (header.LineCount > ProcessInputFile::MAX_LINES)) {
+        return;
+    }
+
+    // The previous output has to be the very one the manifest describes.
+    std::ifstream previousOutput(_outputFile, std::ios::binary | std::ios::ate);
+    if (!previousOutput.is_open() || (static_cast<uint64_t>(previousOutput.tellg()) != header.OutputSize)) {
+        return;
+    }
+
+    std::vector<IncrementalManifestEntry> entries(static_cast<size_t>(header.LineCount));
+    if (!manifest.read(reinterpret_cast<char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(IncrementalManifestEntry)))) {
+        return;
+    }
+
+    _previous.swap(entries);
+    _previousOutputSize = header.OutputSize;
+}
+
+
+/// <summary>Runs the changed lines through the pipeline, into the delta file.</summary>
+/// <param name="changed">The changed lines.</param>
+/// <param name="deltaFile">The delta file.</param>
+/// <param name="offsets">The offset of each changed line's result in the delta file, and the end of the last.</param>
+/// <returns>Error Code if less than 0.</returns>
+int IncrementalRun::ProcessChangedLines(const std::vector<size_t> &changed, const std::string &deltaFile, std::vector<uint64_t> &offsets)
+{
+    std::string changedLines;
+    for (const auto i : changed) {
+        changedLines.append(_lines[i]).append(1, '\n');
+    }
+
+    // The delta file is indexed, so that its results can be told apart, empty ones included.
+    ProcessOptions options = _options;
+    options.ManifestFile.clear();
+    options.WriteIndex = true;
+    options.IndexFile  = deltaFile + ".idx";
+
+    int errorCode;
+    {
+        std::istringstream input(changedLines);
+        std::ofstream      output(deltaFile, std::ios::binary | std::ios::trunc);
+        if (!output.is_open())
+        {
+            std::cerr << "Error opening output file '" << deltaFile << "'." << std::endl;
+            return -12;
+        }
+
+        ProcessInputFile processor(input, output, _sortAlgorithm, options);
+        errorCode = processor.Process();
+    }
+
+    std::ifstream index(options.IndexFile, std::ios::binary);
+    OutputIndexHeader header = {};
+    offsets.resize(changed.size() + 1);
+    const bool indexRead = (errorCode >= 0) && index.read(reinterpret_cast<char *>(&header), sizeof(header)) &&
+                           ((header.Flags & OutputIndex::FLAG_COMPLETE) != 0) && (header.LineCount == changed.size()) &&
+                           index.read(reinterpret_cast<char *>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+    index.close();
+    std::remove(options.IndexFile.c_str());
+
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    if (!indexRead)
+    {
+        std::cerr << "Error reading index file '" << options.IndexFile << "'." << std::endl;
+        return -16;
+    }
+
+    return 0;
+}
+
+
+/// <summary>Reads the input, and hashes every line.</summary>
+/// <returns>Error Code if less than 0.</returns>
+int IncrementalRun::ReadInput()
+{
+    std::ifstream input(_inputFile);
+    if (!input.is_open())
+    {
+        std::cerr << "Error opening input file '" << _inputFile << "'." << std::endl;
+        return -11;
+    }
+
+    AdviseSequentialRead(_inputFile);
+
+    // The same lines, and the same limit, as a full run.
+    std::string line;
+    while ((_lines.size() < ProcessInputFile::MAX_LINES) && ProcessInputFile::ReadItemString(input, line))
+    {
+        _hashes.push_back(HashLine(line));
+        _lines.push_back(line);
+    }
+
+    return 0;
+}
+
+
+/// <summary>Writes this run's manifest, and the index if one was asked for.</summary>
+/// <param name="spans">Where each line's result came from; its length is all that matters now.</param>
+/// <returns>Error Code if less than 0.</returns>
+int IncrementalRun::WriteManifest(const std::vector<ResultSpan> &spans)
+{
+    std::vector<IncrementalManifestEntry> entries(spans.size());
+    uint64_t offset = 0;
+    for (size_t i = 0; i < spans.size(); ++i)
+    {
+        entries[i] = IncrementalManifestEntry { _hashes[i], offset };
+        offset += spans[i].Length;
+    }
+
+    IncrementalManifestHeader header = {};
+    memcpy(header.Magic, Magic(), sizeof(header.Magic));
+    header.Version    = VERSION;
+    header.Mode       = _options.Tokens ? MODE_TOKENS : 0;
+    header.LineCount  = entries.size();
+    header.OutputSize = offset;
+
+    // The previous manifest is gone already (see AssembleOutput); a run cut short leaves none, so the next run is a full one.
+    const std::string temporaryFile = _options.ManifestFile + ".tmp";
+    {
+        std::ofstream manifest(temporaryFile, std::ios::binary | std::ios::trunc);
+        manifest.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        manifest.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(IncrementalManifestEntry)));
+        manifest.close();
+
+        if (manifest.fail() || !RenameFileOver(temporaryFile, _options.ManifestFile))
+        {
+            std::cerr << "Error writing manifest file '" << _options.ManifestFile << "'." << std::endl;
+            std::remove(temporaryFile.c_str());
+            return -17;
+        }
+    }
+
+    if (!_options.WriteIndex) {
+        return 0;
+    }
+
+    const std::string indexFile = _options.IndexFile.empty() ? OutputIndex::DefaultPath(_outputFile) : _options.IndexFile;
+    OutputIndex index(indexFile);
+    for (const auto &span : spans) {
+        index.Record(static_cast<size_t>(span.Length));
+    }
+
+    if (!index.IsOpen() || !index.Finish())
+    {
+        std::cerr << "Error writing index file '" << indexFile << "'." << std::endl;
+        return -16;
+    }
+
+    return 0;
+}
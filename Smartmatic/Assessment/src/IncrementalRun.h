@@ -0,0 +1,139 @@
+// =============================================================================================================================================
+// <copyright file="IncrementalRun.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: IncrementalRun.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 10:30 PM
+//  Purpose: "--incremental": reprocesses only the lines which changed since the previous run, and copies the rest.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _INCREMENTAL_RUN_H
+#define _INCREMENTAL_RUN_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Algorithms/SortAlgorithm.h"
+#include "ProcessOptions.h"
+
+
+/// <summary>The header of a manifest file.</summary>
+/// <remarks>
+///     A manifest is this header, followed by LineCount entries: each input line's content hash, and the offset of its
+///     result in the output file; the result ends where the next line's starts, or at OutputSize.  Little-endian.
+/// </remarks>
+struct IncrementalManifestHeader
+{
+    char     Magic[4];     // "AINC"
+    uint32_t Version;
+    uint32_t Mode;         // What else decides a line's result: MODE_TOKENS, or 0.
+    uint32_t Reserved;
+    uint64_t LineCount;
+    uint64_t OutputSize;   // A changed (or missing) output file does not match its manifest.
+};
+
+
+/// <summary>One input line of a manifest file.</summary>
+struct IncrementalManifestEntry
+{
+    uint64_t Hash;
+    uint64_t Offset;
+};
+
+
+/// <summary>"--incremental": reprocesses only the lines which changed since the previous run, and copies the rest.</summary>
+/// <remarks>
+///     A line's result depends on nothing but its content (and the token mode), so a line seen in the previous run, at
+///     any line number, has its result in the previous output already.  The manifest of the previous run maps the
+///     content hash of every line to the span of its result.
+///     The new and changed lines go through the pipeline as usual, into a delta file with an index of its own.  The new
+///     output is then put together from spans of the previous output and of the delta file, adjacent spans coalesced,
+///     with copy_file_range() where the platform has it, and replaces the previous output in one rename; the result is
+///     the same as a full run, byte for byte.  No usable manifest (none yet, another mode, or an output file which does
+///     not match it) simply makes for a full run.
+/// </remarks>
+class IncrementalRun
+{
+public:
+    static const uint32_t VERSION     = 1;
+    static const uint32_t MODE_TOKENS = 1;
+
+    /// <summary>The "magic" number at the start of a manifest file.</summary>
+    static const char *Magic() { return "AINC"; }
+
+private:
+    /// <summary>Where a line's result comes from: the previous output, or this run's delta file.</summary>
+    struct ResultSpan
+    {
+        bool     FromPrevious;
+        uint64_t Offset;
+        uint64_t Length;
+    };
+
+    std::string               _inputFile;
+    std::string               _outputFile;
+    Algorithms::SortAlgorithm _sortAlgorithm;
+    ProcessOptions            _options;
+
+    std::vector<std::string> _lines;    // This run's input.
+    std::vector<uint64_t>    _hashes;
+
+    std::vector<IncrementalManifestEntry> _previous;   // The previous run's manifest; empty if there is no usable one.
+    uint64_t                              _previousOutputSize;
+
+    size_t _linesReprocessed;
+
+public:
+
+    /// <param name="inputFile">The input file.</param>
+    /// <param name="outputFile">The output file; also the previous output.</param>
+    /// <param name="sortAlgorithm">The sort algorithm.</param>
+    /// <param name="options">The run-time options; <see cref="ProcessOptions::ManifestFile"/> names the manifest.</param>
+    IncrementalRun(const std::string &inputFile, const std::string &outputFile, Algorithms::SortAlgorithm sortAlgorithm,
+                   const ProcessOptions &options);
+
+    /// <summary>Processes this instance.</summary>
+    int Process();
+
+    /// <summary>The number of input lines.</summary>
+    size_t LineCount() const { return _lines.size(); }
+
+    /// <summary>The number of lines which went through the pipeline; the others were copied.</summary>
+    size_t LinesReprocessed() const { return _linesReprocessed; }
+
+
+    /// Block the copy constructor.
+    IncrementalRun(IncrementalRun &) = delete;
+
+    /// Block the copy assignment operator.
+    IncrementalRun operator =(IncrementalRun &) = delete;
+
+private:
+
+    /// <summary>Puts the new output together from the result spans.</summary>
+    int AssembleOutput(const std::vector<ResultSpan> &spans, const std::string &deltaFile);
+
+    /// <summary>The content hash of a line (64-bit FNV-1a).</summary>
+    static uint64_t HashLine(const std::string &line);
+
+    /// <summary>Loads the previous run's manifest, if there is a usable one.</summary>
+    void LoadManifest();
+
+    /// <summary>Runs the changed lines through the pipeline, into the delta file.</summary>
+    int ProcessChangedLines(const std::vector<size_t> &changed, const std::string &deltaFile, std::vector<uint64_t> &offsets);
+
+    /// <summary>Reads the input, and hashes every line.</summary>
+    int ReadInput();
+
+    /// <summary>Writes this run's manifest, and the index if one was asked for.</summary>
+    int WriteManifest(const std::vector<ResultSpan> &spans);
+};
+
+#endif  // _INCREMENTAL_RUN_H
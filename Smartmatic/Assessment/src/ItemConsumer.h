@@ -18,8 +18,12 @@
 #define _ITEM_CONSUMER_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
+#include "Clock.h"
 #include "Compatibility.h"
 #include "ConcurrentQueue.h"
 #include "WorkItem.h"
@@ -28,6 +32,8 @@
 /// <summary> The Consumer portion of the requisite asynchronous Producer / Consumer design pattern. </summary>
 /// <remarks>
 ///     <code> https://codereview.stackexchange.com/questions/177650/a-simple-implementation-of-the-producer-consumer-pattern </code>
+///     A consumer can be parked (it stops taking items until it is unparked), and it keeps track of how long it has
+///     spent waiting for items, so that the number of active consumers can follow the load.
 /// </remarks>
 template<typename TWorkItem> class ItemConsumer
 {
@@ -36,9 +42,14 @@ private:
     using item_t     = TWorkItem;
 
     std::atomic<bool>        _isRunning = ATOMIC_VAR_INIT(true);
+    std::atomic<bool>        _isActive  = ATOMIC_VAR_INIT(true);   // Running, and not parked.
     consumer_t               _consumer;
     ConcurrentQueue<item_t> &_queue;
 
+    std::mutex              _parkMutex;
+    std::condition_variable _parkCV;
+    std::atomic<long long>  _idleNanoseconds;
+
     std::thread _thread;  // Has to be initialized last.
 
 
@@ -50,6 +61,7 @@ public:
     ItemConsumer(ConcurrentQueue<item_t> &queue, consumer_t consumer)
         : _consumer(consumer),
           _queue(queue),
+          _idleNanoseconds(0),
           _thread([&]()
           {
               Run();
@@ -62,20 +74,64 @@ public:
     bool IsRunning() const { return _isRunning; }
 
 
+    /// <summary>Is this Consumer currently parked?</summary>
+    /// <returns> true or false as appropriate.</returns>
+    bool IsParked() const { return _isRunning && !_isActive; }
+
+
+    /// <summary>The total time this Consumer has spent waiting for an item.</summary>
+    long long IdleNanoseconds() const { return _idleNanoseconds; }
+
+
+    /// <summary>Stops this Consumer taking items, once it is done with the current one.</summary>
+    void Park()
+    {
+        {
+            // Lock will be released as soon as it goes out of scope.
+            std::lock_guard<std::mutex> lock(_parkMutex);
+
+            _isActive = false;
+        }
+
+        // Get it out of the queue wait.
+        _queue.WakeAll();
+    }
+
+
+    /// <summary>Lets a parked Consumer take items again.</summary>
+    void Unpark()
+    {
+        {
+            // Lock will be released as soon as it goes out of scope.
+            std::lock_guard<std::mutex> lock(_parkMutex);
+
+            _isActive = _isRunning.load();
+        }
+
+        _parkCV.notify_all();
+    }
+
+
     /// <summary>Runs the specified consumer.</summary>
     void Run()
     {
         while (_isRunning)
         {
-            TWorkItem item;
-            while (_isRunning && !_queue.TryPop(item))
+            if (!_isActive)
             {
-                // Do nothing
-                MillisecondSleep(100);
+                // Lock will be released as soon as it goes out of scope.
+                std::unique_lock<std::mutex> lock(_parkMutex);
+
+                _parkCV.wait(lock, [this]{ return _isActive || !_isRunning; });
+                continue;
             }
 
-            if (!_isRunning) {
-                return;
+            TWorkItem  item;
+            const long long waitStart = Clock::Current().Now();
+            const bool      popped    = _queue.WaitAndPop(item, _isActive);
+            _idleNanoseconds += Clock::Current().Now() - waitStart;
+            if (!popped) {
+                continue;
             }
 
             _consumer(std::move(item));
@@ -88,9 +144,19 @@ public:
 
 
     /// <summary>Finalizes an instance of the <see cref="ItemConsumer{TWorkItem}"/> class.</summary>
+    /// <remarks>Parked consumers are woken so that they see the stop request right away.</remarks>
     ~ItemConsumer()
     {
-        _isRunning = false;
+        {
+            // Lock will be released as soon as it goes out of scope.
+            std::lock_guard<std::mutex> lock(_parkMutex);
+
+            _isRunning = false;
+            _isActive  = false;
+        }
+
+        _parkCV.notify_all();
+        _queue.WakeAll();
         _thread.join();
     }
 
@@ -0,0 +1,434 @@
+// =============================================================================================================================================
+// <copyright file="JobServer.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: JobServer.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 7:55 PM
+//  Purpose: "--serve" mode: a long-running daemon, taking jobs over a Unix domain socket and running them on a warm pool.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _MSC_VER
+#  include <sys/socket.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+#endif
+
+#include "JobServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "Algorithms/SortAlgorithm.h"
+#include "Compatibility.h"
+
+
+const size_t JobServer::MAX_REQUEST_LINE;
+const size_t JobServer::MAX_DATA_LENGTH;
+const size_t JobServer::READ_BUFFER_SIZE;
+
+
+/// <summary>Initializes a new instance of the <see cref="JobServer"/> class, and starts the worker pool.</summary>
+/// <param name="socketPath">The path of the Unix domain socket to listen on.</param>
+/// <param name="options">The run-time options of every job.</param>
+JobServer::JobServer(const std::string &socketPath, const ProcessOptions &options)
+    : _socketPath(socketPath),
+      _processor(options),
+      _isRunning(true),
+      _listener(-1)
+{
+}
+
+
+/// <summary>Stops accepting connections; <see cref="Run"/> returns once the running jobs are done.</summary>
+void JobServer::Stop()
+{
+    _isRunning = false;
+
+#ifndef _MSC_VER
+    // Wakes Run() out of accept().
+    const int listener = _listener;
+    if (listener >= 0) {
+        shutdown(listener, SHUT_RDWR);
+    }
+#endif
+}
+
+
+#ifdef _MSC_VER
+
+/// <summary>Serves jobs until <see cref="Stop"/> is called, or a client asks for a shutdown.</summary>
+/// <returns>Error Code if less than 0.</returns>
+int JobServer::Run()
+{
+    std::cerr << "Error:" << std::endl
+              << "Option '--serve' needs Unix domain sockets, which this build does not support." << std::endl;
+    return -14;
+}
+
+#else
+
+/// <summary>Buffered reads of request lines and data from a socket.</summary>
+class JobServer::SocketReader
+{
+private:
+    int               _socket;
+    std::vector<char> _buffer;
+    size_t            _begin;
+    size_t            _end;
+
+    /// <summary>Refills the (empty) buffer.</summary>
+    /// <returns>false at the end of the stream, or on an error.</returns>
+    bool Fill()
+    {
+        _begin = 0;
+        _end   = 0;
+        for (;;)
+        {
+            const ssize_t count = read(_socket, _buffer.data(), _buffer.size());
+            if (count > 0)
+            {
+                _end = static_cast<size_t>(count);
+                return true;
+            }
+
+            if ((count < 0) && (errno == EINTR)) {
+                continue;
+            }
+
+            return false;
+        }
+    }
+
+public:
+    explicit SocketReader(const int socket)
+        : _socket(socket),
+          _buffer(READ_BUFFER_SIZE),
+          _begin(0),
+          _end(0)
+    { }
+
+
+    /// <summary>Reads a line, without its line end.</summary>
+    /// <param name="line">The line.</param>
+    /// <returns>false at the end of the stream, or if the line is too long.</returns>
+    bool ReadLine(std::string &line)
+    {
+        line.clear();
+        for (;;)
+        {
+            const auto begin   = _buffer.data() + _begin;
+            const auto end     = _buffer.data() + _end;
+            const auto newline = std::find(begin, end, '\n');
+
+            line.append(begin, newline);
+            if (newline != end)
+            {
+                _begin += static_cast<size_t>(newline - begin) + 1;
+                if (!line.empty() && (line.back() == '\r')) {
+                    line.pop_back();
+                }
+
+                return true;
+            }
+
+            if ((line.size() > MAX_REQUEST_LINE) || !Fill()) {
+                return false;
+            }
+        }
+    }
+
+
+    /// <summary>Reads exactly <paramref name="length" /> bytes.</summary>
+    /// <param name="data">The data.</param>
+    /// <param name="length">The length.</param>
+    /// <returns>false if the stream ended first.</returns>
+    bool Read(std::string &data, const size_t length)
+    {
+        data.clear();
+        data.reserve(length);
+        while (data.size() < length)
+        {
+            if ((_begin == _end) && !Fill()) {
+                return false;
+            }
+
+            const size_t count = std::min(length - data.size(), _end - _begin);
+            data.append(_buffer.data() + _begin, count);
+            _begin += count;
+        }
+
+        return true;
+    }
+};
+
+
+/// <summary>Writes all of a buffer to a socket.</summary>
+/// <returns>true / false - depending upon success.</returns>
+static bool WriteAll(const int socket, const char *data, size_t length)
+{
+    while (length > 0)
+    {
+        const ssize_t count = write(socket, data, length);
+        if (count < 0)
+        {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        data   += count;
+        length -= static_cast<size_t>(count);
+    }
+
+    return true;
+}
+
+
+/// <summary>Writes an "OK" response.</summary>
+/// <returns>true / false - depending upon success.</returns>
+static bool WriteResponse(const int socket, const std::string &output)
+{
+    const std::string header = "OK\t" + std::to_string(output.size()) + "\n";
+    return WriteAll(socket, header.data(), header.size()) && WriteAll(socket, output.data(), output.size());
+}
+
+
+/// <summary>Writes an "ERROR" response.</summary>
+/// <returns>true / false - depending upon success.</returns>
+static bool WriteError(const int socket, const int errorCode, const std::string &message)
+{
+    const std::string response = "ERROR\t" + std::to_string(errorCode) + "\t" + message + "\n";
+    return WriteAll(socket, response.data(), response.size());
+}
+
+
+/// <summary>Serves jobs until <see cref="Stop"/> is called, or a client asks for a shutdown.</summary>
+/// <returns>Error Code if less than 0.</returns>
+int JobServer::Run()
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (_socketPath.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Socket path '" << _socketPath << "' is too long." << std::endl;
+        return -14;
+    }
+
+    memcpy(address.sun_path, _socketPath.c_str(), _socketPath.size());
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        std::cerr << "Error opening socket: " << strerror(errno) << std::endl;
+        return -14;
+    }
+
+    // A socket file left behind by an earlier server would make bind() fail.
+    unlink(_socketPath.c_str());
+    if ((bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) || (listen(listener, SOMAXCONN) < 0))
+    {
+        std::cerr << "Error listening on socket '" << _socketPath << "': " << strerror(errno) << std::endl;
+        close(listener);
+        return -14;
+    }
+
+    // A client that hangs up before its response is written is that connection's problem only.
+    signal(SIGPIPE, SIG_IGN);
+
+    _listener = listener;
+    std::cout << "Serving on '" << _socketPath << "' with " << _processor.WorkerCount() << " worker(s)." << std::endl;
+
+    while (_isRunning)
+    {
+        const int client = accept(listener, nullptr, nullptr);
+        if (client < 0)
+        {
+            if ((errno == EINTR) || (errno == ECONNABORTED)) {
+                continue;
+            }
+
+            if (_isRunning) {
+                std::cerr << "Error accepting connection: " << strerror(errno) << std::endl;
+            }
+
+            break;
+        }
+
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_connectionsMutex);
+
+        ReapConnections();
+
+        auto connection = new Connection();
+        connection->Socket = client;
+        connection->IsDone = false;
+        _connections.emplace_back(connection);
+        connection->Thread = std::thread(&JobServer::ServeConnection, this, connection);
+    }
+
+    // Idle connections would wait for their next request forever; running jobs still finish, and get their responses.
+    std::list<std::unique_ptr<Connection>> connections;
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_connectionsMutex);
+
+        for (auto &connection : _connections)
+        {
+            if (connection->Socket >= 0) {
+                shutdown(connection->Socket, SHUT_RD);
+            }
+        }
+
+        connections.swap(_connections);
+    }
+
+    for (auto &connection : connections) {
+        connection->Thread.join();
+    }
+
+    _listener = -1;
+    close(listener);
+    unlink(_socketPath.c_str());
+
+    std::cout << "Server stopped." << std::endl;
+    return 0;
+}
+
+
+/// <summary>Joins the threads of the connections which have closed.</summary>
+/// <remarks>The caller holds _connectionsMutex.</remarks>
+void JobServer::ReapConnections()
+{
+    auto connection = _connections.begin();
+    while (connection != _connections.end())
+    {
+        if ((*connection)->IsDone)
+        {
+            (*connection)->Thread.join();
+            connection = _connections.erase(connection);
+        }
+        else {
+            ++connection;
+        }
+    }
+}
+
+
+/// <summary>Runs one request, and writes its response.</summary>
+/// <param name="socket">The client socket.</param>
+/// <param name="request">The request line.</param>
+/// <param name="reader">The client socket reader, for the request data.</param>
+/// <returns>false if the connection has to be closed.</returns>
+bool JobServer::RunJob(const int socket, const std::string &request, SocketReader &reader)
+{
+    std::vector<std::string> fields;
+    std::string::size_type   start = 0;
+    for (;;)
+    {
+        const std::string::size_type tab = request.find('\t', start);
+        fields.push_back(request.substr(start, tab - start));
+        if (tab == std::string::npos) {
+            break;
+        }
+
+        start = tab + 1;
+    }
+
+    const std::string &command = fields[0];
+    if (command == "SHUTDOWN")
+    {
+        Stop();
+        WriteResponse(socket, std::string());
+        return false;
+    }
+
+    const Algorithms::SortAlgorithm sortAlgorithm = (fields.size() > 1) ? Algorithms::ToSortAlgorithm(fields[1]) : Algorithms::SortAlgorithm::None;
+
+    if ((command == "DATA") && (fields.size() == 3))
+    {
+        char *end = nullptr;
+        const unsigned long long length = strtoull(fields[2].c_str(), &end, 10);
+        if (fields[2].empty() || (*end != '\0') || (length > MAX_DATA_LENGTH))
+        {
+            // Without a length, the rest of the stream cannot be framed.
+            WriteError(socket, -4, "Data length '" + fields[2] + "' is not valid.");
+            return false;
+        }
+
+        std::string input;
+        if (!reader.Read(input, static_cast<size_t>(length))) {
+            return false;
+        }
+
+        if (sortAlgorithm == Algorithms::SortAlgorithm::None) {
+            return WriteError(socket, -3, "Sort Algorithm '" + fields[1] + "' is not available.");
+        }
+
+        std::string output;
+        const int errorCode = _processor.Process(input, output, sortAlgorithm);
+        return (errorCode < 0) ? WriteError(socket, errorCode, "Job failed.") : WriteResponse(socket, output);
+    }
+
+    if ((command == "FILE") && (fields.size() == 4))
+    {
+        if (sortAlgorithm == Algorithms::SortAlgorithm::None) {
+            return WriteError(socket, -3, "Sort Algorithm '" + fields[1] + "' is not available.");
+        }
+
+        if (!FileExists(fields[2])) {
+            return WriteError(socket, -2, "Input file '" + fields[2] + "' is not found or accessible.");
+        }
+
+        const int errorCode = _processor.ProcessFile(fields[2], fields[3], sortAlgorithm);
+        return (errorCode < 0) ? WriteError(socket, errorCode, "Job failed.") : WriteResponse(socket, std::string());
+    }
+
+    return WriteError(socket, -4, "Request '" + command + "' is not recognized.");
+}
+
+
+/// <summary>The thread serving a connection: one job after the other, until the client hangs up.</summary>
+/// <param name="connection">The connection.</param>
+void JobServer::ServeConnection(Connection *connection)
+{
+    SocketReader reader(connection->Socket);
+
+    std::string request;
+    while (reader.ReadLine(request))
+    {
+        if (request.empty()) {
+            continue;
+        }
+
+        if (!RunJob(connection->Socket, request, reader)) {
+            break;
+        }
+    }
+
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_connectionsMutex);
+
+        close(connection->Socket);
+        connection->Socket = -1;
+    }
+
+    connection->IsDone = true;
+}
+
+#endif
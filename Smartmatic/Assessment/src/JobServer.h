@@ -0,0 +1,109 @@
+// =============================================================================================================================================
+// <copyright file="JobServer.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: JobServer.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 7:55 PM
+//  Purpose: "--serve" mode: a long-running daemon, taking jobs over a Unix domain socket and running them on a warm pool.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _JOB_SERVER_H
+#define _JOB_SERVER_H
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "LineProcessor.h"
+#include "ProcessOptions.h"
+
+
+/// <summary>A long-running daemon, taking jobs over a Unix domain socket and running them on a warm worker pool.</summary>
+/// <remarks>
+///     Every connection gets a thread of its own, and may send any number of jobs, one after the other; jobs on
+///     different connections run concurrently, on the one pool.  Each job's output keeps its input order.
+///     Requests are a single line of tab-separated fields:
+///         FILE    &lt;algorithm&gt;  &lt;inputFile&gt;  &lt;outputFile&gt;
+///         DATA    &lt;algorithm&gt;  &lt;length&gt;        followed by &lt;length&gt; bytes of input lines
+///         SHUTDOWN                                 stop accepting connections, and exit once the running jobs are done
+///     The response comes back when the job is complete:
+///         OK      &lt;length&gt;                         followed by &lt;length&gt; bytes of output lines (0 for FILE)
+///         ERROR   &lt;code&gt;  &lt;message&gt;
+/// </remarks>
+class JobServer
+{
+public:
+    // Requests longer than this are refused rather than buffered.
+    static const size_t MAX_REQUEST_LINE = 8192;
+    static const size_t MAX_DATA_LENGTH  = 64 * 1024 * 1024;
+    static const size_t READ_BUFFER_SIZE = 64 * 1024;
+
+private:
+    /// <summary>Buffered reads of request lines and data from a socket.</summary>
+    class SocketReader;
+
+    /// <summary>A client connection, and the thread serving it.</summary>
+    struct Connection
+    {
+        int               Socket;
+        std::thread       Thread;
+        std::atomic<bool> IsDone;
+    };
+
+    std::string   _socketPath;
+    LineProcessor _processor;
+
+    std::atomic<bool> _isRunning;
+    std::atomic<int>  _listener;
+
+    std::mutex                              _connectionsMutex;
+    std::list<std::unique_ptr<Connection>>  _connections;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="JobServer"/> class, and starts the worker pool.</summary>
+    /// <param name="socketPath">The path of the Unix domain socket to listen on.</param>
+    /// <param name="options">The run-time options of every job.</param>
+    JobServer(const std::string &socketPath, const ProcessOptions &options);
+
+    /// <summary>Serves jobs until <see cref="Stop"/> is called, or a client asks for a shutdown.</summary>
+    int Run();
+
+    /// <summary>Stops accepting connections; <see cref="Run"/> returns once the running jobs are done.</summary>
+    /// <remarks>Async-signal-safe: may be called from a SIGINT or SIGTERM handler.</remarks>
+    void Stop();
+
+
+    /// Block the copy constructor.
+    JobServer(JobServer &) = delete;
+
+    /// Block the move constructor.
+    JobServer(JobServer &&) = delete;
+
+    /// Block the copy assignment operator.
+    JobServer operator =(JobServer &) = delete;
+
+    /// Block the move assignment operator.
+    JobServer operator =(JobServer &&) = delete;
+
+private:
+    /// <summary>Runs one request, and writes its response.</summary>
+    bool RunJob(int socket, const std::string &request, SocketReader &reader);
+
+    /// <summary>Joins the threads of the connections which have closed.</summary>
+    void ReapConnections();
+
+    /// <summary>The thread serving a connection: one job after the other, until the client hangs up.</summary>
+    void ServeConnection(Connection *connection);
+};
+
+#endif  // _JOB_SERVER_H
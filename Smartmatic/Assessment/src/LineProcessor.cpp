@@ -0,0 +1,189 @@
+// =============================================================================================================================================
+// <copyright file="LineProcessor.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: LineProcessor.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 7:20 PM
+//  Purpose: The in-process API of the AssessmentCore library: sorts and formats streams or buffers in memory.
+// </summary>
+// =============================================================================================================================================
+
+#include "LineProcessor.h"
+
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+
+#include "ProcessInputFile.h"
+
+
+namespace
+{
+    /// <summary>Reads straight out of a caller's buffer, without copying it.</summary>
+    class MemoryReadBuffer : public std::streambuf
+    {
+    public:
+        MemoryReadBuffer(const char *data, const size_t length)
+        {
+            const auto begin = const_cast<char *>(data);   // Never written through: this buffer has no put area.
+            setg(begin, begin, begin + length);
+        }
+    };
+
+
+    /// <summary>Appends straight onto a caller's string.</summary>
+    class StringWriteBuffer : public std::streambuf
+    {
+    private:
+        std::string &_text;
+
+    public:
+        explicit StringWriteBuffer(std::string &text) : _text(text) { }
+
+    protected:
+        int_type overflow(const int_type character) override
+        {
+            if (!traits_type::eq_int_type(character, traits_type::eof())) {
+                _text += traits_type::to_char_type(character);
+            }
+
+            return traits_type::not_eof(character);
+        }
+
+        std::streamsize xsputn(const char *text, const std::streamsize count) override
+        {
+            _text.append(text, static_cast<size_t>(count));
+            return count;
+        }
+    };
+}
+
+
+/// <summary>Initializes a new instance of the <see cref="LineProcessor"/> class, and starts its workers.</summary>
+/// <param name="options">The run-time options; the scheduler is always the work-stealing one.</param>
+LineProcessor::LineProcessor(const ProcessOptions &options)
+    : _options(options)
+{
+    _options.Scheduler      = WorkStealingScheduler;
+    _options.ConsoleReports = false;
+
+    _pool.reset(new WorkStealingPool(_options.ThreadCount));
+}
+
+
+/// <summary>Processes an input stream into an output stream.</summary>
+/// <param name="input">The input stream.</param>
+/// <param name="output">The output stream.</param>
+/// <param name="sortAlgorithm">The sort algorithm.</param>
+/// <returns>Error Code if less than 0.</returns>
+int LineProcessor::Process(std::istream &input, std::ostream &output, const Algorithms::SortAlgorithm sortAlgorithm)
+{
+    const int errorCode = CheckOptions();
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    if (!input)
+    {
+        std::cerr << "Error reading input stream." << std::endl;
+        return -11;
+    }
+
+    ProcessInputFile job(input, output, sortAlgorithm, _options, _pool.get());
+
+    const int jobErrorCode = job.Process();
+    if (jobErrorCode < 0) {
+        return jobErrorCode;
+    }
+
+    if (output.bad())
+    {
+        std::cerr << "Error writing output stream." << std::endl;
+        return -12;
+    }
+
+    return 0;
+}
+
+
+/// <summary>Processes a buffer, appending the result to a string.</summary>
+/// <param name="data">The input lines.</param>
+/// <param name="length">The length of <paramref name="data" />.</param>
+/// <param name="output">The string to append the result to.</param>
+/// <param name="sortAlgorithm">The sort algorithm.</param>
+/// <returns>Error Code if less than 0.</returns>
+int LineProcessor::Process(const char *data, const size_t length, std::string &output, const Algorithms::SortAlgorithm sortAlgorithm)
+{
+    MemoryReadBuffer  inputBuffer(data, length);
+    StringWriteBuffer outputBuffer(output);
+
+    std::istream input(&inputBuffer);
+    std::ostream outputStream(&outputBuffer);
+
+    return Process(input, outputStream, sortAlgorithm);
+}
+
+
+/// <summary>Processes a string, appending the result to another.</summary>
+/// <param name="input">The input lines.</param>
+/// <param name="output">The string to append the result to.</param>
+/// <param name="sortAlgorithm">The sort algorithm.</param>
+/// <returns>Error Code if less than 0.</returns>
+int LineProcessor::Process(const std::string &input, std::string &output, const Algorithms::SortAlgorithm sortAlgorithm)
+{
+    return Process(input.data(), input.size(), output, sortAlgorithm);
+}
+
+
+/// <summary>Processes an input file into an output file.</summary>
+/// <param name="inputFile">The input file.</param>
+/// <param name="outputFile">The output file.</param>
+/// <param name="sortAlgorithm">The sort algorithm.</param>
+/// <returns>Error Code if less than 0.</returns>
+int LineProcessor::ProcessFile(const std::string &inputFile, const std::string &outputFile, const Algorithms::SortAlgorithm sortAlgorithm)
+{
+    // Before the output file is truncated.
+    const int errorCode = CheckOptions();
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    std::ifstream input(inputFile);
+    if (!input.is_open())
+    {
+        std::cerr << "Error opening input file '" << inputFile << "'." << std::endl;
+        return -11;
+    }
+
+    std::ofstream output(outputFile);
+    if (!output.is_open())
+    {
+        std::cerr << "Error opening output file '" << outputFile << "'." << std::endl;
+        return -12;
+    }
+
+    return Process(input, output, sortAlgorithm);
+}
+
+
+/// <summary>Rejects the modes a job on the shared pool cannot run.</summary>
+/// <returns>Error Code if less than 0.</returns>
+/// <remarks>
+///     The external sort runs on queue consumers of its own, never on the pool; the incremental run and sharding are
+///     file-to-file runs of their own (see IncrementalRun and ShardedRun).  Each would otherwise be silently ignored.
+/// </remarks>
+int LineProcessor::CheckOptions() const
+{
+    if ((_options.ExternalSortMemory > 0) || !_options.ManifestFile.empty() || (_options.ShardCount > 1))
+    {
+        std::cerr << "Error: the external sort, incremental and sharded modes cannot run on a LineProcessor." << std::endl;
+        return -4;
+    }
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+// =============================================================================================================================================
+// <copyright file="LineProcessor.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: LineProcessor.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 7:20 PM
+//  Purpose: The in-process API of the AssessmentCore library: sorts and formats streams or buffers in memory.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _LINE_PROCESSOR_H
+#define _LINE_PROCESSOR_H
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "Algorithms/SortAlgorithm.h"
+#include "ProcessOptions.h"
+#include "WorkStealingPool.h"
+
+
+/// <summary>Sorts and formats lines in memory, the same way AssessmentMain does files.</summary>
+/// <remarks>
+///     The worker pool is started once, and lives as long as the processor does, so that a caller with many small
+///     inputs does not pay for starting and stopping threads on every one.  Jobs always run on the work-stealing
+///     scheduler.  Process() may be called from several threads at once; the jobs share the pool, and each one waits
+///     only for its own lines.
+///     The modes that need a scheduler, a process or an output file of their own are rejected: the external sort, the
+///     incremental run and sharding.
+///     The same limits apply as to a file: at most <see cref="ProcessInputFile::MAX_LINES"/> lines are read.
+/// </remarks>
+class LineProcessor
+{
+private:
+    ProcessOptions                    _options;
+    std::unique_ptr<WorkStealingPool> _pool;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="LineProcessor"/> class, and starts its workers.</summary>
+    /// <param name="options">The run-time options; the scheduler is always the work-stealing one.</param>
+    explicit LineProcessor(const ProcessOptions &options = ProcessOptions());
+
+    /// <summary>The worker thread count.</summary>
+    int WorkerCount() const { return _pool->WorkerCount(); }
+
+    /// <summary>Processes an input stream into an output stream.</summary>
+    int Process(std::istream &input, std::ostream &output, Algorithms::SortAlgorithm sortAlgorithm);
+
+    /// <summary>Processes a buffer, appending the result to a string.</summary>
+    int Process(const char *data, size_t length, std::string &output, Algorithms::SortAlgorithm sortAlgorithm);
+
+    /// <summary>Processes a string, appending the result to another.</summary>
+    int Process(const std::string &input, std::string &output, Algorithms::SortAlgorithm sortAlgorithm);
+
+    /// <summary>Processes an input file into an output file.</summary>
+    int ProcessFile(const std::string &inputFile, const std::string &outputFile, Algorithms::SortAlgorithm sortAlgorithm);
+
+
+    /// Block the copy constructor.
+    LineProcessor(LineProcessor &) = delete;
+
+    /// Block the move constructor.
+    LineProcessor(LineProcessor &&) = delete;
+
+    /// Block the copy assignment operator.
+    LineProcessor operator =(LineProcessor &) = delete;
+
+    /// Block the move assignment operator.
+    LineProcessor operator =(LineProcessor &&) = delete;
+
+private:
+
+    /// <summary>Rejects the modes a job on the shared pool cannot run.</summary>
+    int CheckOptions() const;
+};
+
+#endif  // _LINE_PROCESSOR_H
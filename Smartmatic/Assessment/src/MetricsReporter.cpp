@@ -0,0 +1,198 @@
+// =============================================================================================================================================
+// <copyright file="MetricsReporter.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: MetricsReporter.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 6:50 PM
+//  Purpose: Reports the progress of a running job periodically: to stderr, and/or to a Prometheus text-format file.
+// </summary>
+// =============================================================================================================================================
+
+#include "MetricsReporter.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "Clock.h"
+#include "Compatibility.h"
+
+
+/// <summary>Initializes a new instance of the <see cref="MetricsReporter"/> class, and starts reporting.</summary>
+/// <param name="input">The input file, to label the metrics with.</param>
+/// <param name="intervalMs">How often to report.</param>
+/// <param name="toStderr">Write a progress line to stderr.</param>
+/// <param name="metricsFile">Keep Prometheus text-format metrics in this file; empty for none.</param>
+/// <param name="sample">Samples the job.</param>
+/// <param name="context">Passed to <paramref name="sample" />.</param>
+MetricsReporter::MetricsReporter(const std::string &input, const int intervalMs, const bool toStderr, const std::string &metricsFile,
+                                 const sample_function_t sample, void *context)
+    : _input(input),
+      _intervalMs(std::max(intervalMs, 1)),
+      _toStderr(toStderr),
+      _metricsFile(metricsFile),
+      _sample(sample),
+      _context(context),
+      _start(Clock::Current().Now()),
+      _lastSampledAt(_start),
+      _lastLinesWritten(0),
+      _reportedError(false),
+      _isRunning(true),
+      _thread(&MetricsReporter::Run, this)
+{ }
+
+
+/// <summary>Finalizes an instance of the <see cref="MetricsReporter"/> class.</summary>
+MetricsReporter::~MetricsReporter()
+{
+    Stop();
+}
+
+
+/// <summary>Stops reporting, after one last report with the job marked as finished.  Idempotent.</summary>
+void MetricsReporter::Stop()
+{
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _isRunning = false;
+    }
+
+    _stopCV.notify_all();
+    if (_thread.joinable())
+    {
+        _thread.join();
+        Report(true);
+    }
+}
+
+
+/// <summary>Samples the job and reports it.</summary>
+/// <param name="finished">Whether the job has finished.</param>
+void MetricsReporter::Report(const bool finished)
+{
+    ProgressSnapshot snapshot;
+    _sample(_context, snapshot);
+
+    const long long now            = Clock::Current().Now();
+    const double    elapsedSeconds = static_cast<double>(now - _start) / 1e9;
+    const double    intervalSecs   = static_cast<double>(now - _lastSampledAt) / 1e9;
+    const double    linesPerSecond = (intervalSecs > 0.0) ? static_cast<double>(snapshot.LinesWritten - _lastLinesWritten) / intervalSecs : 0.0;
+    _lastSampledAt    = now;
+    _lastLinesWritten = snapshot.LinesWritten;
+
+    if (_toStderr)
+    {
+        const int idle = std::max(snapshot.Workers - snapshot.WorkersBusy - snapshot.WorkersSleeping, 0);
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1)
+             << (finished ? "Finished: " : "Progress: ") << elapsedSeconds << " s, " << snapshot.LinesRead << " read, "
+             << snapshot.LinesWritten << " written, " << snapshot.QueueDepth << " queued, "
+             << (snapshot.LinesRead - snapshot.LinesWritten) << " in flight; workers " << snapshot.WorkersBusy << " busy, "
+             << snapshot.WorkersSleeping << " sleeping, " << idle << " idle; " << linesPerSecond << " lines/s" << std::endl;
+
+        // One write, so that the line does not get torn up by anything else writing to stderr.
+        std::cerr << line.str() << std::flush;
+    }
+
+    if (!_metricsFile.empty() && !WriteMetricsFile(snapshot, elapsedSeconds, linesPerSecond, finished) && !_reportedError)
+    {
+        // Keep on processing; the job matters more than its metrics.
+        std::cerr << "Error writing metrics file '" << _metricsFile << "'." << std::endl;
+        _reportedError = true;
+    }
+}
+
+
+/// <summary>The reporter thread main loop.</summary>
+void MetricsReporter::Run()
+{
+    // Lock will be released as soon as it goes out of scope.
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!Clock::Current().WaitFor(_stopCV, lock, _intervalMs * 1000000LL, [this]{ return !_isRunning; })) {
+        Report(false);
+    }
+}
+
+
+/// <summary>Writes the metrics file, by way of a temporary file.</summary>
+/// <param name="snapshot">The sample.</param>
+/// <param name="elapsedSeconds">The time since the job started.</param>
+/// <param name="linesPerSecond">The throughput over the last interval.</param>
+/// <param name="finished">Whether the job has finished.</param>
+/// <returns>true / false - depending upon success.</returns>
+bool MetricsReporter::WriteMetricsFile(const ProgressSnapshot &snapshot, const double elapsedSeconds, const double linesPerSecond,
+                                       const bool finished) const
+{
+    // Label values escape backslashes, double quotes and line feeds.
+    std::string input;
+    for (auto c : _input)
+    {
+        if (c == '\n') {
+            input += "\\n";
+            continue;
+        }
+
+        if ((c == '\\') || (c == '"')) {
+            input += '\\';
+        }
+
+        input += c;
+    }
+
+    const std::string label = "{input=\"" + input + "\"}";
+    const int         idle  = std::max(snapshot.Workers - snapshot.WorkersBusy - snapshot.WorkersSleeping, 0);
+    const auto        epoch = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(3)
+         << "# HELP assessment_running Whether the job is still running (1) or has finished (0)." << '\n'
+         << "# TYPE assessment_running gauge" << '\n'
+         << "assessment_running" << label << ' ' << (finished ? 0 : 1) << '\n'
+         << "# HELP assessment_elapsed_seconds Time since the job started." << '\n'
+         << "# TYPE assessment_elapsed_seconds gauge" << '\n'
+         << "assessment_elapsed_seconds" << label << ' ' << elapsedSeconds << '\n'
+         << "# HELP assessment_last_update_timestamp_seconds When this file was last written." << '\n'
+         << "# TYPE assessment_last_update_timestamp_seconds gauge" << '\n'
+         << "assessment_last_update_timestamp_seconds" << label << ' ' << epoch << '\n'
+         << "# HELP assessment_lines_read_total Lines read from the input." << '\n'
+         << "# TYPE assessment_lines_read_total counter" << '\n'
+         << "assessment_lines_read_total" << label << ' ' << snapshot.LinesRead << '\n'
+         << "# HELP assessment_lines_written_total Lines completed in input order, lines which produce no output included." << '\n'
+         << "# TYPE assessment_lines_written_total counter" << '\n'
+         << "assessment_lines_written_total" << label << ' ' << snapshot.LinesWritten << '\n'
+         << "# HELP assessment_queue_depth Items queued, or work-stealing tasks not yet finished." << '\n'
+         << "# TYPE assessment_queue_depth gauge" << '\n'
+         << "assessment_queue_depth" << label << ' ' << snapshot.QueueDepth << '\n'
+         << "# HELP assessment_lines_in_flight Lines read but not yet written." << '\n'
+         << "# TYPE assessment_lines_in_flight gauge" << '\n'
+         << "assessment_lines_in_flight" << label << ' ' << (snapshot.LinesRead - snapshot.LinesWritten) << '\n'
+         << "# HELP assessment_workers Worker threads, by state." << '\n'
+         << "# TYPE assessment_workers gauge" << '\n'
+         << "assessment_workers{input=\"" << input << "\",state=\"busy\"} " << snapshot.WorkersBusy << '\n'
+         << "assessment_workers{input=\"" << input << "\",state=\"sleeping\"} " << snapshot.WorkersSleeping << '\n'
+         << "assessment_workers{input=\"" << input << "\",state=\"idle\"} " << idle << '\n'
+         << "# HELP assessment_throughput_lines_per_second Lines written per second over the last interval." << '\n'
+         << "# TYPE assessment_throughput_lines_per_second gauge" << '\n'
+         << "assessment_throughput_lines_per_second" << label << ' ' << linesPerSecond << '\n';
+
+    const std::string temporaryFile = _metricsFile + ".tmp";
+    {
+        std::ofstream stream(temporaryFile, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!(stream << text.str()).flush()) {
+            return false;
+        }
+    }
+
+    return RenameFileOver(temporaryFile, _metricsFile);
+}
@@ -0,0 +1,113 @@
+// =============================================================================================================================================
+// <copyright file="MetricsReporter.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: MetricsReporter.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 6:50 PM
+//  Purpose: Reports the progress of a running job periodically: to stderr, and/or to a Prometheus text-format file.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _METRICS_REPORTER_H
+#define _METRICS_REPORTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+
+/// <summary>Where a job stands at one moment.</summary>
+struct ProgressSnapshot
+{
+    long long LinesRead       = 0;
+    long long LinesWritten    = 0;   // In input order; lines which produce no output included.
+    long long QueueDepth      = 0;   // Items queued, or work-stealing tasks not yet finished.
+    int       Workers         = 0;
+    int       WorkersBusy     = 0;   // Processing a line, not counting the whitespace delay.
+    int       WorkersSleeping = 0;   // In the whitespace delay.
+};
+
+
+/// <summary>Reports the progress of a running job periodically: to stderr, and/or to a Prometheus text-format file.</summary>
+/// <remarks>
+///     A thread of its own samples the job every interval, through a function pointer and a context, and reports:
+///     lines read and written, queue depth, lines in flight, workers busy / sleeping / idle, and the throughput over
+///     the last interval.  The metrics file is written to a temporary file and renamed over the old one, so that a
+///     scraper never sees half a file.  <see cref="Stop"/> reports once more, with the job marked as finished.
+/// </remarks>
+class MetricsReporter
+{
+public:
+    using sample_function_t = void (*)(void *context, ProgressSnapshot &snapshot);
+
+private:
+    const std::string _input;
+    const int         _intervalMs;
+    const bool        _toStderr;
+    const std::string _metricsFile;
+    sample_function_t _sample;
+    void             *_context;
+
+    const long long _start;           // Clock nanoseconds.
+    long long       _lastSampledAt;   // Clock nanoseconds.
+    long long       _lastLinesWritten;
+    bool            _reportedError;
+
+    std::atomic<bool>       _isRunning;
+    std::mutex              _mutex;
+    std::condition_variable _stopCV;
+
+    std::thread _thread;  // Has to be initialized last.
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="MetricsReporter"/> class, and starts reporting.</summary>
+    /// <param name="input">The input file, to label the metrics with.</param>
+    /// <param name="intervalMs">How often to report.</param>
+    /// <param name="toStderr">Write a progress line to stderr.</param>
+    /// <param name="metricsFile">Keep Prometheus text-format metrics in this file; empty for none.</param>
+    /// <param name="sample">Samples the job.</param>
+    /// <param name="context">Passed to <paramref name="sample" />.</param>
+    MetricsReporter(const std::string &input, int intervalMs, bool toStderr, const std::string &metricsFile,
+                    sample_function_t sample, void *context);
+
+    /// <summary>Finalizes an instance of the <see cref="MetricsReporter"/> class.</summary>
+    ~MetricsReporter();
+
+    /// <summary>Stops reporting, after one last report with the job marked as finished.  Idempotent.</summary>
+    void Stop();
+
+
+    /// Block the copy constructor.
+    MetricsReporter(MetricsReporter &) = delete;
+
+    /// Block the move constructor.
+    MetricsReporter(MetricsReporter &&) = delete;
+
+    /// Block the copy assignment operator.
+    MetricsReporter operator =(MetricsReporter &) = delete;
+
+    /// Block the move assignment operator.
+    MetricsReporter operator =(MetricsReporter &&) = delete;
+
+private:
+
+    /// <summary>Samples the job and reports it.</summary>
+    void Report(bool finished);
+
+    /// <summary>The reporter thread main loop.</summary>
+    void Run();
+
+    /// <summary>Writes the metrics file, by way of a temporary file.</summary>
+    bool WriteMetricsFile(const ProgressSnapshot &snapshot, double elapsedSeconds, double linesPerSecond, bool finished) const;
+};
+
+#endif  // _METRICS_REPORTER_H
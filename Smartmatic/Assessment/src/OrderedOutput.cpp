@@ -0,0 +1,148 @@
+// =============================================================================================================================================
+// <copyright file="OrderedOutput.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: OrderedOutput.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 12:10 PM
+//  Purpose: Writes per-line results to the output stream in input line order, without making the workers wait.
+// </summary>
+// =============================================================================================================================================
+
+#include "OrderedOutput.h"
+
+#include <algorithm>
+
+
+/// <summary>Completes a line: writes it now if it is next, otherwise parks it until it is.</summary>
+/// <param name="lineNumber">The input line number.</param>
+/// <param name="text">The formatted result; empty for lines which produce no output.  Copied only if parked.</param>
+/// <param name="readAt">When the line was read, for the end-to-end latency; 0 if unknown.</param>
+void OrderedOutput::Complete(const int lineNumber, const std::string &text, const long long readAt)
+{
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<pipeline_mutex_t> lock(_mutex);
+
+        if (lineNumber != _lineWritten + 1)
+        {
+            // The frontier line now holds back a finished line.
+            if (_pending.empty()) {
+                _stallStart = Clock::Current().Now();
+            }
+
+            parked_text_t parked(text.data(), text.size(), SlabAllocator<char>(&_arena));
+            _pending.emplace(lineNumber, PendingLine { std::move(parked), readAt, (nullptr != _stats) ? PipelineStats::Now() : 0 });
+            _stallStats.MostLinesHeld = std::max(_stallStats.MostLinesHeld, _pending.size());
+            return;
+        }
+
+        if (!_pending.empty())
+        {
+            // We were the frontier line holding everybody else back.
+            const long long now   = Clock::Current().Now();
+            const long long stall = now - _stallStart;
+
+            _stallStats.BlockedNanoseconds += stall;
+            ++_stallStats.Stalls;
+            if (stall > _stallStats.LongestStallNanoseconds)
+            {
+                _stallStats.LongestStallNanoseconds = stall;
+                _stallStats.LongestStallLine        = lineNumber;
+            }
+
+            if (nullptr != _stats) {
+                _stats->TraceStall(lineNumber, _stallStart, now);
+            }
+
+            _stallStart = now;
+        }
+
+        const long long writeStart = (nullptr != _stats) ? PipelineStats::Now() : 0;
+        _stream << text;
+        _lineWritten = lineNumber;
+        if (nullptr != _index) {
+            _index->Record(text.size());
+        }
+
+        long long writeEnd = 0;
+        if (nullptr != _stats)
+        {
+            writeEnd = PipelineStats::Now();
+            _stats->RecordLineWait(OutputWaitStage, lineNumber, writeStart, writeStart);
+            _stats->RecordLineLatency(readAt, writeEnd);
+            if (!text.empty()) {
+                _stats->CountWritten(text.size());
+            }
+        }
+
+        // Drain whatever was waiting behind us.
+        auto next = _pending.begin();
+        while ((next != _pending.end()) && (next->first == _lineWritten + 1))
+        {
+            if (nullptr != _stats) {
+                _stats->RecordLineWait(OutputWaitStage, next->first, next->second.CompletedAt, PipelineStats::Now());
+            }
+
+            {
+                StageScope writeScope(_stats, WriteStage);
+                _stream << next->second.Text;
+            }
+
+            if (nullptr != _index) {
+                _index->Record(next->second.Text.size());
+            }
+
+            if (nullptr != _stats)
+            {
+                _stats->RecordLineLatency(next->second.ReadAt, PipelineStats::Now());
+                if (!next->second.Text.empty()) {
+                    _stats->CountWritten(next->second.Text.size());
+                }
+            }
+
+            _lineWritten = next->first;
+            next = _pending.erase(next);
+        }
+
+        // The flush is charged to the line that got everything moving; the lines it drained are not.
+        const long long flushStart = (nullptr != _stats) ? PipelineStats::Now() : 0;
+        _stream.flush();
+        if (nullptr != _stats) {
+            _stats->Record(WriteStage, writeStart, PipelineStats::Now(), flushStart - writeEnd);
+        }
+
+        // Published under the lock, so that it never goes backwards; the waiters themselves take no lock.
+        _lineWrittenPublished.Store(_lineWritten);
+    }
+}
+
+
+/// <summary>Waits until every line up to and including <paramref name="lineNumber" /> has been written.</summary>
+/// <param name="lineNumber">The line number.</param>
+void OrderedOutput::WaitUntilWritten(const int lineNumber)
+{
+    _lineWrittenPublished.WaitUntilAtLeast(lineNumber);
+}
+
+
+/// <summary>The last line written.</summary>
+int OrderedOutput::LineWritten()
+{
+    return _lineWrittenPublished.Load();
+}
+
+
+/// <summary>How long output was blocked so far.</summary>
+/// <returns>A snapshot of the stall statistics.</returns>
+OutputStallStats OrderedOutput::StallStats()
+{
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<pipeline_mutex_t> lock(_mutex);
+
+    return _stallStats;
+}
@@ -0,0 +1,137 @@
+// =============================================================================================================================================
+// <copyright file="OrderedOutput.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: OrderedOutput.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 12:10 PM
+//  Purpose: Writes per-line results to the output stream in input line order, without making the workers wait.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _ORDERED_OUTPUT_H
+#define _ORDERED_OUTPUT_H
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "OutputIndex.h"
+#include "PipelineStats.h"
+#include "ProfiledMutex.h"
+#include "SlabArena.h"
+#include "WaitWord.h"
+
+
+/// <summary>How long finished lines sat in the reorder buffer, held back by the line at the output frontier.</summary>
+struct OutputStallStats
+{
+    /// <summary>Total time during which finished lines were held back.</summary>
+    long long BlockedNanoseconds = 0;
+
+    /// <summary>The number of frontier lines that held back finished lines.</summary>
+    int Stalls = 0;
+
+    /// <summary>The longest time any one frontier line held back finished lines.</summary>
+    long long LongestStallNanoseconds = 0;
+
+    /// <summary>The frontier line responsible for the longest stall.</summary>
+    int LongestStallLine = 0;
+
+    /// <summary>The most finished lines held back at one time.</summary>
+    size_t MostLinesHeld = 0;
+};
+
+
+/// <summary>Writes per-line results to the output stream in input line order, without making the workers wait.</summary>
+/// <remarks>
+///     A result that arrives ahead of its turn is parked in a reorder buffer, and the worker goes back for more work.
+///     Whichever worker completes the line at the output frontier also writes every parked line that directly follows it.
+///     Even empty/erronous lines must be completed, they just don't get to be part of the output result.
+///     A result is copied only when it has to be parked; both the map nodes and the parked copies come from a slab
+///     arena, so that parking allocates nothing in steady state.
+/// </remarks>
+class OrderedOutput
+{
+private:
+
+    using parked_text_t = std::basic_string<char, std::char_traits<char>, SlabAllocator<char>>;
+
+    /// <summary>A completed line waiting for its turn.</summary>
+    struct PendingLine
+    {
+        parked_text_t Text;
+        long long     ReadAt;        // For the statistics only.
+        long long     CompletedAt;   // For the statistics only.
+    };
+
+    using pending_map_t = std::map<int, PendingLine, std::less<int>, SlabAllocator<std::pair<const int, PendingLine>>>;
+
+    std::ostream  &_stream;
+    PipelineStats *_stats;
+    OutputIndex   *_index;
+
+    pipeline_mutex_t _mutex;
+    int              _lineWritten;          // The last line written; lines are numbered from 1.
+    WaitWord         _lineWrittenPublished; // The same, published once a batch is flushed; waited on without the lock.
+    SlabArena        _arena;                // For _pending, its nodes and its texts; has to be initialized before it.
+    pending_map_t    _pending;              // Completed lines waiting for their turn.
+
+    long long        _stallStart;   // When the current frontier line started holding back _pending; Clock nanoseconds.
+    OutputStallStats _stallStats;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="OrderedOutput"/> class.</summary>
+    /// <param name="stream">The output stream.</param>
+    /// <param name="stats">Where to record the output-wait and write stages; nullptr for none.</param>
+    /// <param name="index">Where to record the offset of each line's result; nullptr for none.</param>
+    explicit OrderedOutput(std::ostream &stream, PipelineStats *stats = nullptr, OutputIndex *index = nullptr)
+        : _stream(stream),
+          _stats(stats),
+          _index(index),
+          _lineWritten(0),
+          _pending(std::less<int>(), SlabAllocator<std::pair<const int, PendingLine>>(&_arena)),
+          _stallStart(0)
+    {
+        NameMutex(_mutex, "ordered output");
+    }
+
+
+    /// <summary>Completes a line: writes it now if it is next, otherwise parks it until it is.</summary>
+    /// <param name="lineNumber">The input line number.</param>
+    /// <param name="text">The formatted result; empty for lines which produce no output.  Copied only if parked.</param>
+    /// <param name="readAt">When the line was read, for the end-to-end latency; 0 if unknown.</param>
+    void Complete(int lineNumber, const std::string &text, long long readAt = 0);
+
+    /// <summary>Waits until every line up to and including <paramref name="lineNumber" /> has been written.</summary>
+    void WaitUntilWritten(int lineNumber);
+
+    /// <summary>The last line written.</summary>
+    int LineWritten();
+
+    /// <summary>How long output was blocked so far.</summary>
+    OutputStallStats StallStats();
+
+
+    /// Block the copy constructor.
+    OrderedOutput(OrderedOutput &) = delete;
+
+    /// Block the move constructor.
+    OrderedOutput(OrderedOutput &&) = delete;
+
+    /// Block the copy assignment operator.
+    OrderedOutput operator =(OrderedOutput &) = delete;
+
+    /// Block the move assignment operator.
+    OrderedOutput operator =(OrderedOutput &&) = delete;
+};
+
+#endif  // _ORDERED_OUTPUT_H
@@ -0,0 +1,87 @@
+// =============================================================================================================================================
+// <copyright file="OutputIndex.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: OutputIndex.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 10:05 PM
+//  Purpose: "--index": a sidecar file of the byte offset of every input line's result in the output file.
+// </summary>
+// =============================================================================================================================================
+
+#include "OutputIndex.h"
+
+#include <cstddef>
+#include <cstring>
+
+
+const uint32_t OutputIndex::VERSION;
+const uint32_t OutputIndex::FLAG_COMPLETE;
+const size_t   OutputIndex::BUFFERED_OFFSETS;
+
+static_assert(sizeof(OutputIndexHeader) == 24, "The index file header is 24 bytes.");
+
+
+/// <summary>Initializes a new instance of the <see cref="OutputIndex"/> class, creating the index file.</summary>
+/// <param name="path">The index file.</param>
+OutputIndex::OutputIndex(const std::string &path)
+    : _path(path),
+      _file(path, std::ios::binary | std::ios::trunc),
+      _offset(0),
+      _lineCount(0)
+{
+    _pending.reserve(BUFFERED_OFFSETS);
+
+    // The flags stay 0 until Finish(); a reader can tell an index cut short, even of an empty input.
+    OutputIndexHeader header = {};
+    memcpy(header.Magic, Magic(), sizeof(header.Magic));
+    header.Version = VERSION;
+    _file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+
+/// <summary>Records the next line's result.</summary>
+/// <param name="length">The length of the result; 0 for a line with no output.</param>
+/// <remarks>In input line order, and never by two threads at the same time.</remarks>
+void OutputIndex::Record(const size_t length)
+{
+    _pending.push_back(_offset);
+    _offset += length;
+    ++_lineCount;
+
+    if (_pending.size() == BUFFERED_OFFSETS) {
+        WritePending();
+    }
+}
+
+
+/// <summary>Writes the end offset and the line count, marks the index complete, and closes the index file.</summary>
+/// <returns>true / false - depending upon success.</returns>
+bool OutputIndex::Finish()
+{
+    _pending.push_back(_offset);
+    WritePending();
+
+    _file.seekp(offsetof(OutputIndexHeader, LineCount));
+    _file.write(reinterpret_cast<const char *>(&_lineCount), sizeof(_lineCount));
+
+    // Last of all, once everything it vouches for is in place.
+    _file.flush();
+    _file.seekp(offsetof(OutputIndexHeader, Flags));
+    _file.write(reinterpret_cast<const char *>(&FLAG_COMPLETE), sizeof(FLAG_COMPLETE));
+    _file.close();
+
+    return !_file.fail();
+}
+
+
+/// <summary>Writes the pending offsets.</summary>
+void OutputIndex::WritePending()
+{
+    _file.write(reinterpret_cast<const char *>(_pending.data()), static_cast<std::streamsize>(_pending.size() * sizeof(uint64_t)));
+    _pending.clear();
+}
@@ -0,0 +1,105 @@
+// =============================================================================================================================================
+// <copyright file="OutputIndex.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: OutputIndex.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 10:05 PM
+//  Purpose: "--index": a sidecar file of the byte offset of every input line's result in the output file.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _OUTPUT_INDEX_H
+#define _OUTPUT_INDEX_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+/// <summary>The header of an index file.</summary>
+/// <remarks>
+///     An index file is this header, followed by LineCount + 1 offsets (uint64_t): the result of input line N starts at
+///     offset [N - 1] of the output file, and ends where line N + 1 starts, so that the last offset is the output size.
+///     Every input line has its entry; empty and erroneous lines, which have no output, have a zero-length result.
+///     Line N's entry is at a fixed place, so a lookup is two reads, whatever the size of the output.
+///     Every field is little-endian, as on every platform this builds for.
+/// </remarks>
+struct OutputIndexHeader
+{
+    char     Magic[4];    // "AIDX"
+    uint32_t Version;
+    uint32_t Flags;       // OutputIndex::FLAG_COMPLETE once the output is complete; 0 until then.
+    uint32_t Reserved;
+    uint64_t LineCount;   // Filled in when the output is complete; an empty input has none.
+};
+
+
+/// <summary>"--index": writes the byte offset of every input line's result in the output file, as it is written.</summary>
+/// <remarks>
+///     The output stage records each line's result length, in input line order, under its own lock; the index keeps
+///     the running offset, and writes the offsets out in large blocks.
+/// </remarks>
+class OutputIndex
+{
+public:
+    static const uint32_t VERSION          = 2;
+    static const uint32_t FLAG_COMPLETE    = 1;
+    static const size_t   BUFFERED_OFFSETS = 8192;
+
+    /// <summary>The "magic" number at the start of an index file.</summary>
+    static const char *Magic() { return "AIDX"; }
+
+    /// <summary>The index file of an output file, when none is named.</summary>
+    static std::string DefaultPath(const std::string &outputFile) { return outputFile + ".idx"; }
+
+private:
+    std::string           _path;
+    std::ofstream         _file;
+    uint64_t              _offset;     // Where the next line's result starts.
+    uint64_t              _lineCount;
+    std::vector<uint64_t> _pending;    // Offsets not yet written.
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="OutputIndex"/> class, creating the index file.</summary>
+    /// <param name="path">The index file.</param>
+    explicit OutputIndex(const std::string &path);
+
+    /// <summary>Whether the index file could be created.</summary>
+    bool IsOpen() const { return _file.is_open(); }
+
+    /// <summary>The index file.</summary>
+    const std::string &Path() const { return _path; }
+
+    /// <summary>Records the next line's result.</summary>
+    void Record(size_t length);
+
+    /// <summary>Writes the end offset and the line count, marks the index complete, and closes the index file.</summary>
+    bool Finish();
+
+
+    /// Block the copy constructor.
+    OutputIndex(OutputIndex &) = delete;
+
+    /// Block the move constructor.
+    OutputIndex(OutputIndex &&) = delete;
+
+    /// Block the copy assignment operator.
+    OutputIndex operator =(OutputIndex &) = delete;
+
+    /// Block the move assignment operator.
+    OutputIndex operator =(OutputIndex &&) = delete;
+
+private:
+
+    /// <summary>Writes the pending offsets.</summary>
+    void WritePending();
+};
+
+#endif  // _OUTPUT_INDEX_H
@@ -0,0 +1,408 @@
+// =============================================================================================================================================
+// <copyright file="PipelineStats.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: PipelineStats.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 3:20 PM
+//  Purpose: Per-stage latency histograms, per-thread busy/idle time and throughput of one processing run ("--stats").
+// </summary>
+// =============================================================================================================================================
+
+#include "PipelineStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+
+std::atomic<long long> PipelineStats::_instanceGenerator(0);
+
+// The statistics (if any) that the current thread records into, and the run they belong to.
+static thread_local long long    t_instance    = 0;
+static thread_local ThreadStats *t_threadStats = nullptr;
+
+static const char *STAGE_NAMES[STAGE_COUNT] = { "read", "queue-wait", "sleep", "filter", "sort", "format", "output-wait", "write", "end-to-end" };
+
+
+/// <summary>The display name of a stage.</summary>
+/// <param name="stage">The stage.</param>
+const char *StageName(const PipelineStage stage)
+{
+    return ((stage >= 0) && (stage < STAGE_COUNT)) ? STAGE_NAMES[stage] : "?";
+}
+
+
+/// <summary>Initializes a new instance of the <see cref="LatencyHistogram"/> class.</summary>
+LatencyHistogram::LatencyHistogram()
+    : _buckets(),
+      _count(0),
+      _total(0),
+      _min(0),
+      _max(0)
+{ }
+
+
+/// <summary>Records a value.  Single writer.</summary>
+/// <param name="nanoseconds">The value.</param>
+void LatencyHistogram::Record(long long nanoseconds)
+{
+    nanoseconds = std::max(nanoseconds, 0LL);
+
+    auto &bucket = _buckets[BucketIndex(nanoseconds)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    const long long count = _count.load(std::memory_order_relaxed);
+    if ((count == 0) || (nanoseconds < _min.load(std::memory_order_relaxed))) {
+        _min.store(nanoseconds, std::memory_order_relaxed);
+    }
+
+    if (nanoseconds > _max.load(std::memory_order_relaxed)) {
+        _max.store(nanoseconds, std::memory_order_relaxed);
+    }
+
+    _total.store(_total.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+    _count.store(count + 1, std::memory_order_relaxed);
+}
+
+
+/// <summary>Adds another histogram's counts to this one.  Single writer.</summary>
+/// <param name="other">The other histogram.</param>
+void LatencyHistogram::Merge(const LatencyHistogram &other)
+{
+    const long long otherCount = other.Count();
+    if (otherCount == 0) {
+        return;
+    }
+
+    for (auto i = 0; i < BUCKET_COUNT; ++i) {
+        _buckets[i].store(_buckets[i].load(std::memory_order_relaxed) + other._buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    if ((Count() == 0) || (other.Min() < Min())) {
+        _min.store(other.Min(), std::memory_order_relaxed);
+    }
+
+    _max.store(std::max(Max(), other.Max()), std::memory_order_relaxed);
+    _total.store(Total() + other.Total(), std::memory_order_relaxed);
+    _count.store(Count() + otherCount, std::memory_order_relaxed);
+}
+
+
+/// <summary>The value below which the given percentage of the recorded values fall.</summary>
+/// <param name="percentile">The percentile, 0 to 100.</param>
+/// <returns>The upper bound of the bucket holding that value, but never more than the largest value recorded.</returns>
+long long LatencyHistogram::ValueAtPercentile(const double percentile) const
+{
+    const long long count = Count();
+    if (count == 0) {
+        return 0;
+    }
+
+    const long long rank = std::max(1LL, static_cast<long long>(std::ceil(percentile / 100.0 * static_cast<double>(count))));
+
+    long long seen = 0;
+    for (auto i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(BucketUpperBound(i), Max());
+        }
+    }
+
+    return Max();
+}
+
+
+/// <summary>The bucket of a value.</summary>
+/// <param name="value">The value; not negative.</param>
+int LatencyHistogram::BucketIndex(const long long value)
+{
+    // The first two powers of two are exact.
+    if (value < 2 * SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+
+#ifdef _MSC_VER
+    unsigned long mostSignificantBit;
+    _BitScanReverse64(&mostSignificantBit, static_cast<unsigned long long>(value));
+#else
+    const int mostSignificantBit = 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+#endif
+
+    const int shift = static_cast<int>(mostSignificantBit) - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) - SUB_BUCKETS);
+}
+
+
+/// <summary>The largest value that falls into a bucket.</summary>
+/// <param name="index">The bucket index.</param>
+long long LatencyHistogram::BucketUpperBound(const int index)
+{
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    const int       shift     = index / SUB_BUCKETS - 1;
+    const long long subBucket = index % SUB_BUCKETS + SUB_BUCKETS;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+
+/// <summary>Initializes a new instance of the <see cref="PipelineStats"/> class; the run starts now.</summary>
+/// <param name="traced">Also record a timeline; see <see cref="Trace"/>.</param>
+PipelineStats::PipelineStats(const bool traced)
+    : _instance(++_instanceGenerator),
+      _startNanoseconds(Now()),
+      _workerCount(0)
+{
+    if (traced) {
+        _trace = std::make_unique<TraceRecorder>(_startNanoseconds);
+    }
+}
+
+
+/// <summary>The calling thread's statistics; registered on first use.</summary>
+/// <param name="name">The name to register under; by default "worker N".</param>
+ThreadStats &PipelineStats::ThisThread(const char *name)
+{
+    if (t_instance == _instance) {
+        return *t_threadStats;
+    }
+
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(_threadsMutex);
+
+    const std::string threadName = (nullptr != name) ? name : "worker " + std::to_string(++_workerCount);
+    _threads.emplace_back(new ThreadStats(threadName, (nullptr != _trace) ? _trace->RegisterThread(threadName) : nullptr));
+
+    t_instance    = _instance;
+    t_threadStats = _threads.back().get();
+    return *t_threadStats;
+}
+
+
+/// <summary>Records one stage on the calling thread.</summary>
+/// <param name="stage">The stage.</param>
+/// <param name="begin">When it began.</param>
+/// <param name="end">When it ended.</param>
+/// <param name="excluded">Time within the stage that belongs to other stages, recorded separately.</param>
+void PipelineStats::Record(const PipelineStage stage, const long long begin, const long long end, const long long excluded)
+{
+    auto &thread = ThisThread();
+    Add(thread.Stages[stage], end - begin - excluded);
+    if (nullptr != thread.Trace) {
+        thread.Trace->Append(TraceEvent { STAGE_NAMES[stage], begin, end, 0, TraceEvent::ThreadSpan });
+    }
+}
+
+
+/// <summary>Records a stage in which the calling thread was blocked.</summary>
+/// <param name="stage">The stage.</param>
+/// <param name="begin">When it began.</param>
+/// <param name="end">When it ended.</param>
+void PipelineStats::RecordBlocked(const PipelineStage stage, const long long begin, const long long end)
+{
+    Record(stage, begin, end);
+    Add(ThisThread().BlockedNanoseconds, end - begin);
+}
+
+
+/// <summary>Records a stage in which a line waited, rather than a thread; it goes on the line's own track.</summary>
+/// <param name="stage">The stage.</param>
+/// <param name="line">The line number.</param>
+/// <param name="begin">When it began.</param>
+/// <param name="end">When it ended.</param>
+void PipelineStats::RecordLineWait(const PipelineStage stage, const int line, const long long begin, const long long end)
+{
+    auto &thread = ThisThread();
+    Add(thread.Stages[stage], end - begin);
+    if ((nullptr != thread.Trace) && (end > begin)) {
+        thread.Trace->Append(TraceEvent { STAGE_NAMES[stage], begin, end, line, TraceEvent::AsyncLineSpan });
+    }
+}
+
+
+/// <summary>Records how long a line took from being read until it was written; not put on the timeline.</summary>
+/// <param name="readAt">When it was read; 0 if unknown, in which case nothing is recorded.</param>
+/// <param name="writtenAt">When it was written.</param>
+void PipelineStats::RecordLineLatency(const long long readAt, const long long writtenAt)
+{
+    if (readAt != 0) {
+        Add(ThisThread().Stages[LatencyStage], writtenAt - readAt);
+    }
+}
+
+
+/// <summary>Puts the processing of a line on the calling thread's track.</summary>
+/// <param name="line">The line number.</param>
+/// <param name="begin">When it began.</param>
+/// <param name="end">When it ended.</param>
+void PipelineStats::TraceLine(const int line, const long long begin, const long long end)
+{
+    auto &thread = ThisThread();
+    if (nullptr != thread.Trace) {
+        thread.Trace->Append(TraceEvent { "line", begin, end, line, TraceEvent::LineSpan });
+    }
+}
+
+
+/// <summary>Puts the time the output was held up behind a line on that line's track.</summary>
+/// <param name="line">The line number.</param>
+/// <param name="begin">When it began.</param>
+/// <param name="end">When it ended.</param>
+void PipelineStats::TraceStall(const int line, const long long begin, const long long end)
+{
+    auto &thread = ThisThread();
+    if (nullptr != thread.Trace) {
+        thread.Trace->Append(TraceEvent { "output-blocked", begin, end, line, TraceEvent::AsyncLineSpan });
+    }
+}
+
+
+/// <summary>Counts a line read by the calling thread.</summary>
+/// <param name="bytes">The line length.</param>
+void PipelineStats::CountRead(const size_t bytes)
+{
+    auto &thread = ThisThread();
+    Add(thread.LinesRead, 1);
+    Add(thread.BytesRead, static_cast<long long>(bytes));
+}
+
+
+/// <summary>Counts a line written by the calling thread.</summary>
+/// <param name="bytes">The formatted length.</param>
+void PipelineStats::CountWritten(const size_t bytes)
+{
+    auto &thread = ThisThread();
+    Add(thread.LinesWritten, 1);
+    Add(thread.BytesWritten, static_cast<long long>(bytes));
+}
+
+
+/// <summary>Adds what every thread recorded for a stage to a histogram.</summary>
+/// <param name="stage">The stage.</param>
+/// <param name="histogram">The histogram.</param>
+void PipelineStats::MergeStage(const PipelineStage stage, LatencyHistogram &histogram)
+{
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(_threadsMutex);
+
+    for (const auto &thread : _threads) {
+        histogram.Merge(thread->Stages[stage]);
+    }
+}
+
+
+/// <summary>Writes the report: a table, or a single JSON object.</summary>
+/// <param name="stream">The stream.</param>
+/// <param name="json">JSON, rather than a table.</param>
+void PipelineStats::Report(std::ostream &stream, const bool json)
+{
+    static const double PERCENTILES[]      = { 50.0, 90.0, 99.0, 99.9 };
+    static const char  *PERCENTILE_NAMES[] = { "p50", "p90", "p99", "p99.9" };
+
+    const long long elapsed = std::max(Now() - _startNanoseconds, 1LL);
+    const double    seconds = static_cast<double>(elapsed) / 1e9;
+
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(_threadsMutex);
+
+    LatencyHistogram stages[STAGE_COUNT];
+    long long linesRead = 0, bytesRead = 0, linesWritten = 0, bytesWritten = 0;
+    for (const auto &thread : _threads)
+    {
+        for (auto stage = 0; stage < STAGE_COUNT; ++stage) {
+            stages[stage].Merge(thread->Stages[stage]);
+        }
+
+        linesRead    += thread->LinesRead;
+        bytesRead    += thread->BytesRead;
+        linesWritten += thread->LinesWritten;
+        bytesWritten += thread->BytesWritten;
+    }
+
+    const double linesPerSecond = static_cast<double>(linesRead) / seconds;
+    const double megabytesIn    = static_cast<double>(bytesRead) / (1024.0 * 1024.0) / seconds;
+    const double megabytesOut   = static_cast<double>(bytesWritten) / (1024.0 * 1024.0) / seconds;
+    const auto   micro          = [](const long long nanoseconds){ return static_cast<double>(nanoseconds) / 1000.0; };
+    const auto   milli          = [](const long long nanoseconds){ return static_cast<double>(nanoseconds) / 1e6; };
+
+    const auto oldFlags     = stream.flags();
+    const auto oldPrecision = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+
+    if (json)
+    {
+        stream << "{\"seconds\":" << seconds
+               << ",\"linesRead\":" << linesRead << ",\"bytesRead\":" << bytesRead
+               << ",\"linesWritten\":" << linesWritten << ",\"bytesWritten\":" << bytesWritten
+               << ",\"linesPerSecond\":" << linesPerSecond << ",\"megabytesInPerSecond\":" << megabytesIn
+               << ",\"megabytesOutPerSecond\":" << megabytesOut << ",\"stages\":{";
+
+        for (auto stage = 0; stage < STAGE_COUNT; ++stage)
+        {
+            const auto &histogram = stages[stage];
+            stream << ((stage > 0) ? "," : "") << "\"" << STAGE_NAMES[stage] << "\":{\"count\":" << histogram.Count()
+                   << ",\"minUs\":" << micro(histogram.Min()) << ",\"meanUs\":" << histogram.Mean() / 1000.0;
+            for (auto p = 0; p < 4; ++p) {
+                stream << ",\"" << PERCENTILE_NAMES[p] << "Us\":" << micro(histogram.ValueAtPercentile(PERCENTILES[p]));
+            }
+
+            stream << ",\"maxUs\":" << micro(histogram.Max()) << "}";
+        }
+
+        stream << "},\"threads\":[";
+        for (size_t i = 0; i < _threads.size(); ++i)
+        {
+            const auto     &thread  = *_threads[i];
+            const long long working = std::min<long long>(thread.BusyNanoseconds, elapsed);
+            const long long blocked = std::min<long long>(thread.BlockedNanoseconds, working);
+            stream << ((i > 0) ? "," : "") << "{\"name\":\"" << thread.Name << "\",\"busyMs\":" << milli(working - blocked)
+                   << ",\"blockedMs\":" << milli(blocked) << ",\"idleMs\":" << milli(elapsed - working) << "}";
+        }
+
+        stream << "]}" << std::endl;
+    }
+    else
+    {
+        stream << "Statistics: " << linesRead << " lines (" << bytesRead << " bytes) read, " << linesWritten << " lines ("
+               << bytesWritten << " bytes) written in " << seconds << " s; " << std::setprecision(1) << linesPerSecond
+               << " lines/s, " << std::setprecision(3) << megabytesIn << " MB/s in, " << megabytesOut << " MB/s out." << std::endl;
+
+        stream << std::setprecision(1)
+               << "  Stage (us)        count        min        p50        p90        p99      p99.9        max       mean" << std::endl;
+        for (auto stage = 0; stage < STAGE_COUNT; ++stage)
+        {
+            const auto &histogram = stages[stage];
+            stream << "  " << std::left << std::setw(12) << STAGE_NAMES[stage] << std::right << std::setw(11) << histogram.Count()
+                   << std::setw(11) << micro(histogram.Min());
+            for (auto percentile : PERCENTILES) {
+                stream << std::setw(11) << micro(histogram.ValueAtPercentile(percentile));
+            }
+
+            stream << std::setw(11) << micro(histogram.Max()) << std::setw(11) << histogram.Mean() / 1000.0 << std::endl;
+        }
+
+        stream << "  Thread (ms)        busy    blocked       idle      busy%" << std::endl;
+        for (const auto &thread : _threads)
+        {
+            const long long working = std::min<long long>(thread->BusyNanoseconds, elapsed);
+            const long long blocked = std::min<long long>(thread->BlockedNanoseconds, working);
+            stream << "  " << std::left << std::setw(12) << thread->Name << std::right << std::setw(12) << milli(working - blocked)
+                   << std::setw(11) << milli(blocked) << std::setw(11) << milli(elapsed - working)
+                   << std::setw(11) << 100.0 * static_cast<double>(working - blocked) / static_cast<double>(elapsed) << std::endl;
+        }
+    }
+
+    stream.flags(oldFlags);
+    stream.precision(oldPrecision);
+}
@@ -0,0 +1,321 @@
+// =============================================================================================================================================
+// <copyright file="PipelineStats.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: PipelineStats.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 3:20 PM
+//  Purpose: Per-stage latency histograms, per-thread busy/idle time and throughput of one processing run ("--stats").
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _PIPELINE_STATS_H
+#define _PIPELINE_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "AllocationTracker.h"
+#include "Clock.h"
+#include "TraceRecorder.h"
+
+
+/// <summary>The stages a line goes through.</summary>
+enum PipelineStage
+{
+    ReadStage = 0,      // GetItemString().
+    QueueWaitStage,     // From being queued (or submitted in a batch) until a worker picks it up.
+    SleepStage,         // The whitespace delay.
+    FilterStage,        // Skipping the spaces, without the sleeps.
+    SortStage,
+    FormatStage,
+    OutputWaitStage,    // From finished until it is its turn to be written.
+    WriteStage,
+    LatencyStage,       // End to end: from read until written.
+    STAGE_COUNT
+};
+
+
+/// <summary>The display name of a stage.</summary>
+const char *StageName(PipelineStage stage);
+
+
+/// <summary>A latency histogram, in nanoseconds, with HDR-style log-linear buckets.</summary>
+/// <remarks>
+///     Each power of two is divided into 16 linear sub-buckets, so that any recorded value is reported to within about
+///     6%, over the whole range from 1 ns to centuries.  Recording is one relaxed load and store per counter, so only
+///     one thread may record into a histogram; any thread may read it.
+/// </remarks>
+class LatencyHistogram
+{
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS     = 1 << SUB_BUCKET_BITS;
+    static const int BUCKET_COUNT    = (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+private:
+    std::atomic<long long> _buckets[BUCKET_COUNT];
+    std::atomic<long long> _count;
+    std::atomic<long long> _total;
+    std::atomic<long long> _min;
+    std::atomic<long long> _max;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="LatencyHistogram"/> class.</summary>
+    LatencyHistogram();
+
+    /// <summary>Records a value.  Single writer.</summary>
+    void Record(long long nanoseconds);
+
+    /// <summary>Adds another histogram's counts to this one.  Single writer.</summary>
+    void Merge(const LatencyHistogram &other);
+
+    long long Count() const { return _count.load(std::memory_order_relaxed); }
+    long long Total() const { return _total.load(std::memory_order_relaxed); }
+    long long Min()   const { return (Count() > 0) ? _min.load(std::memory_order_relaxed) : 0; }
+    long long Max()   const { return _max.load(std::memory_order_relaxed); }
+    double    Mean()  const { return (Count() > 0) ? static_cast<double>(Total()) / static_cast<double>(Count()) : 0.0; }
+
+    /// <summary>The value below which the given percentage of the recorded values fall.</summary>
+    long long ValueAtPercentile(double percentile) const;
+
+
+    /// Block the copy constructor.
+    LatencyHistogram(LatencyHistogram &) = delete;
+
+    /// Block the move constructor.
+    LatencyHistogram(LatencyHistogram &&) = delete;
+
+    /// Block the copy assignment operator.
+    LatencyHistogram operator =(LatencyHistogram &) = delete;
+
+    /// Block the move assignment operator.
+    LatencyHistogram operator =(LatencyHistogram &&) = delete;
+
+private:
+
+    static int       BucketIndex(long long value);
+    static long long BucketUpperBound(int index);
+};
+
+
+/// <summary>Everything one thread has recorded.  Written only by its own thread.</summary>
+struct ThreadStats
+{
+    std::string            Name;
+    LatencyHistogram       Stages[STAGE_COUNT];
+    std::atomic<long long> BusyNanoseconds;      // Inside a WorkScope, including BlockedNanoseconds.
+    std::atomic<long long> BlockedNanoseconds;   // Inside a WorkScope, but unable to carry on.
+    std::atomic<long long> LinesRead;
+    std::atomic<long long> BytesRead;
+    std::atomic<long long> LinesWritten;
+    std::atomic<long long> BytesWritten;
+    int                    WorkDepth;   // Nesting of WorkScope.
+    TraceBuffer           *Trace;       // "--trace" only.
+
+    ThreadStats(const std::string &name, TraceBuffer *trace)
+        : Name(name),
+          BusyNanoseconds(0),
+          BlockedNanoseconds(0),
+          LinesRead(0),
+          BytesRead(0),
+          LinesWritten(0),
+          BytesWritten(0),
+          WorkDepth(0),
+          Trace(trace)
+    { }
+};
+
+
+/// <summary>The statistics of one processing run: per-stage latency histograms, per-thread busy/idle time, throughput.</summary>
+/// <remarks>
+///     Every thread records into its own <see cref="ThreadStats"/>, registered the first time it records anything, so
+///     recording takes no lock.  <see cref="Report"/> merges them all.
+///     With a <see cref="TraceRecorder"/>, everything recorded is also put on a timeline.
+/// </remarks>
+class PipelineStats
+{
+private:
+    static std::atomic<long long> _instanceGenerator;
+
+    const long long                           _instance;
+    const long long                           _startNanoseconds;
+    std::mutex                                _threadsMutex;
+    std::vector<std::unique_ptr<ThreadStats>> _threads;
+    int                                       _workerCount;
+    std::unique_ptr<TraceRecorder>            _trace;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="PipelineStats"/> class; the run starts now.</summary>
+    /// <param name="traced">Also record a timeline; see <see cref="Trace"/>.</param>
+    explicit PipelineStats(bool traced = false);
+
+    /// <summary>The timeline; nullptr unless traced.</summary>
+    TraceRecorder *Trace() const { return _trace.get(); }
+
+    /// <summary>The steady clock, in nanoseconds.</summary>
+    static long long Now()
+    {
+        return Clock::Current().Now();
+    }
+
+    /// <summary>The calling thread's statistics; registered on first use.</summary>
+    /// <param name="name">The name to register under; by default "worker N".</param>
+    ThreadStats &ThisThread(const char *name = nullptr);
+
+    /// <summary>Records one stage on the calling thread.</summary>
+    /// <param name="stage">The stage.</param>
+    /// <param name="begin">When it began.</param>
+    /// <param name="end">When it ended.</param>
+    /// <param name="excluded">Time within the stage that belongs to other stages, recorded separately.</param>
+    void Record(PipelineStage stage, long long begin, long long end, long long excluded = 0);
+
+    /// <summary>Records a stage in which the calling thread was blocked.</summary>
+    void RecordBlocked(PipelineStage stage, long long begin, long long end);
+
+    /// <summary>Records a stage in which a line waited, rather than a thread; it goes on the line's own track.</summary>
+    void RecordLineWait(PipelineStage stage, int line, long long begin, long long end);
+
+    /// <summary>Records how long a line took from being read until it was written; not put on the timeline.</summary>
+    void RecordLineLatency(long long readAt, long long writtenAt);
+
+    /// <summary>Puts the processing of a line on the calling thread's track.</summary>
+    void TraceLine(int line, long long begin, long long end);
+
+    /// <summary>Puts the time the output was held up behind a line on that line's track.</summary>
+    void TraceStall(int line, long long begin, long long end);
+
+    /// <summary>Counts a line read by the calling thread.</summary>
+    void CountRead(size_t bytes);
+
+    /// <summary>Counts a line written by the calling thread.</summary>
+    void CountWritten(size_t bytes);
+
+    /// <summary>Adds what every thread recorded for a stage to a histogram.</summary>
+    void MergeStage(PipelineStage stage, LatencyHistogram &histogram);
+
+    /// <summary>Writes the report: a table, or a single JSON object.</summary>
+    void Report(std::ostream &stream, bool json);
+
+
+    /// Block the copy constructor.
+    PipelineStats(PipelineStats &) = delete;
+
+    /// Block the move constructor.
+    PipelineStats(PipelineStats &&) = delete;
+
+    /// Block the copy assignment operator.
+    PipelineStats operator =(PipelineStats &) = delete;
+
+    /// Block the move assignment operator.
+    PipelineStats operator =(PipelineStats &&) = delete;
+
+private:
+    friend class WorkScope;
+
+    static void Add(LatencyHistogram &histogram, long long nanoseconds) { histogram.Record(nanoseconds); }
+
+    static void Add(std::atomic<long long> &counter, long long value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+
+/// <summary>Times a stage from construction to destruction; does nothing when there are no statistics.</summary>
+/// <remarks>The allocations of a TRACK_ALLOCATIONS build are charged to the stage, statistics or not.</remarks>
+class StageScope
+{
+private:
+    PipelineStats  *_stats;
+    PipelineStage   _stage;
+    long long       _start;
+    AllocationScope _allocations;
+
+public:
+    StageScope(PipelineStats *stats, const PipelineStage stage)
+        : _stats(stats),
+          _stage(stage),
+          _start((nullptr != stats) ? PipelineStats::Now() : 0),
+          _allocations(stage)
+    { }
+
+    ~StageScope()
+    {
+        if (nullptr != _stats) {
+            _stats->Record(_stage, _start, PipelineStats::Now());
+        }
+    }
+
+    StageScope(StageScope &) = delete;
+    StageScope operator =(StageScope &) = delete;
+};
+
+
+/// <summary>Puts the processing of one line on the timeline, from construction to destruction.</summary>
+class LineScope
+{
+private:
+    PipelineStats *_stats;
+    int            _line;
+    long long      _start;
+
+public:
+    LineScope(PipelineStats *stats, const int line)
+        : _stats(((nullptr != stats) && (nullptr != stats->Trace())) ? stats : nullptr),
+          _line(line),
+          _start((nullptr != _stats) ? PipelineStats::Now() : 0)
+    { }
+
+    ~LineScope()
+    {
+        if (nullptr != _stats) {
+            _stats->TraceLine(_line, _start, PipelineStats::Now());
+        }
+    }
+
+    LineScope(LineScope &) = delete;
+    LineScope operator =(LineScope &) = delete;
+};
+
+
+/// <summary>Counts a worker's busy time from construction to destruction; nested scopes count once.</summary>
+class WorkScope
+{
+private:
+    ThreadStats *_thread;
+    long long    _start;
+
+public:
+    explicit WorkScope(PipelineStats *stats)
+        : _thread((nullptr != stats) ? &stats->ThisThread() : nullptr),
+          _start(0)
+    {
+        if ((nullptr != _thread) && (_thread->WorkDepth++ == 0)) {
+            _start = PipelineStats::Now();
+        }
+    }
+
+    ~WorkScope()
+    {
+        if ((nullptr != _thread) && (--_thread->WorkDepth == 0)) {
+            PipelineStats::Add(_thread->BusyNanoseconds, PipelineStats::Now() - _start);
+        }
+    }
+
+    WorkScope(WorkScope &) = delete;
+    WorkScope operator =(WorkScope &) = delete;
+};
+
+#endif  // _PIPELINE_STATS_H
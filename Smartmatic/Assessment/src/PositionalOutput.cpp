@@ -0,0 +1,150 @@
+// =============================================================================================================================================
+// <copyright file="PositionalOutput.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: PositionalOutput.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-20, 1:05 AM
+//  Purpose: Writes every line's result straight to its own place in the output file, worked out when the line is read.
+// </summary>
+// =============================================================================================================================================
+
+#include "PositionalOutput.h"
+
+#include <limits>
+
+#include "Algorithms/TextKernels.h"
+#include "Compatibility.h"
+
+
+const long long PositionalOutput::PREALLOCATE_BYTES;
+
+
+/// <summary>Initializes a new instance of the <see cref="PositionalOutput"/> class, creating the output file.</summary>
+/// <param name="path">The output file.</param>
+/// <param name="stats">Where to record the write stage; nullptr for none.</param>
+/// <param name="index">Where to record the length of each line's result; nullptr for none.</param>
+PositionalOutput::PositionalOutput(const std::string &path, PipelineStats *stats, OutputIndex *index)
+    : _path(path),
+      _descriptor(CreateFileForWriting(path)),
+      _stats(stats),
+      _index(index),
+      _reserved(0),
+      _allocated(0),
+      _writeFailed(false),
+      _linesCompleted(0),
+      _linesAwaited(std::numeric_limits<int>::max())
+{ }
+
+
+/// <summary>Finalizes an instance of the <see cref="PositionalOutput"/> class, closing the file if it is still open.</summary>
+PositionalOutput::~PositionalOutput()
+{
+    if (_descriptor >= 0) {
+        CloseFile(_descriptor);
+    }
+}
+
+
+/// <summary>The length of a line's result, from the line as read.</summary>
+/// <param name="itemString">The line, as read.</param>
+/// <returns>Two bytes per character kept ("a,b,c\n"), a lone line end for a line of whitespace, nothing for an empty line.</returns>
+long long PositionalOutput::ResultLength(const std::string &itemString)
+{
+    if (itemString.empty()) {
+        return 0;
+    }
+
+    const size_t kept = itemString.size() - Algorithms::CountWhitespace(itemString.data(), itemString.size());
+    return static_cast<long long>(Algorithms::FormattedItemLength(kept));
+}
+
+
+/// <summary>Sets aside the place of the next line's result; the reader only, in line order.</summary>
+/// <param name="length">The length of the result; see <see cref="ResultLength"/>.</param>
+/// <returns>The offset of the result in the file.</returns>
+long long PositionalOutput::Reserve(const long long length)
+{
+    const long long offset = _reserved;
+    _reserved += length;
+
+    // Ahead of the workers, in large steps: they never have to grow the file themselves.
+    if (_reserved > _allocated)
+    {
+        const long long allocateTo = _reserved + PREALLOCATE_BYTES;
+        PreallocateFile(_descriptor, _allocated, allocateTo - _allocated);
+        _allocated = allocateTo;
+    }
+
+    // Every line has its entry, the ones with no output included.
+    if (nullptr != _index) {
+        _index->Record(static_cast<size_t>(length));
+    }
+
+    return offset;
+}
+
+
+/// <summary>Completes a line: writes its result at its place.</summary>
+/// <param name="lineNumber">The input line number.</param>
+/// <param name="offset">The place set aside for it by <see cref="Reserve"/>.</param>
+/// <param name="text">The formatted result; empty for lines which produce no output.</param>
+/// <param name="readAt">When the line was read, for the end-to-end latency; 0 if unknown.</param>
+void PositionalOutput::Complete(const int /*lineNumber*/, const long long offset, const std::string &text, const long long readAt)
+{
+    if (!text.empty())
+    {
+        StageScope writeScope(_stats, WriteStage);
+        if (!WriteFileAt(_descriptor, text.data(), text.size(), offset)) {
+            _writeFailed = true;
+        }
+    }
+
+    if (nullptr != _stats)
+    {
+        _stats->RecordLineLatency(readAt, PipelineStats::Now());
+        if (!text.empty()) {
+            _stats->CountWritten(text.size());
+        }
+    }
+
+    const int linesCompleted = ++_linesCompleted;
+    if (linesCompleted >= _linesAwaited) {
+        _linesCompletedPublished.Store(linesCompleted);
+    }
+}
+
+
+/// <summary>Waits until <paramref name="lineCount" /> lines have been completed.</summary>
+/// <param name="lineCount">The line count.</param>
+void PositionalOutput::WaitUntilCompleted(const int lineCount)
+{
+    // A line completed from here on either is seen by the check below, or sees the count awaited and wakes us.
+    _linesAwaited = lineCount;
+    if (_linesCompleted >= lineCount) {
+        return;
+    }
+
+    _linesCompletedPublished.WaitUntilAtLeast(lineCount);
+}
+
+
+/// <summary>Cuts the file to the results, and closes it; once every line has been completed.</summary>
+/// <returns>true / false - false if any write failed.</returns>
+bool PositionalOutput::Finish()
+{
+    if (_descriptor < 0) {
+        return false;
+    }
+
+    // The space set aside past the last result goes back.
+    const bool truncated = TruncateFile(_descriptor, _reserved);
+    const bool closed    = CloseFile(_descriptor);
+    _descriptor = -1;
+
+    return truncated && closed && !_writeFailed;
+}
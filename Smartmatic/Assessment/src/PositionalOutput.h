@@ -0,0 +1,111 @@
+// =============================================================================================================================================
+// <copyright file="PositionalOutput.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: PositionalOutput.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-20, 1:05 AM
+//  Purpose: Writes every line's result straight to its own place in the output file, worked out when the line is read.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _POSITIONAL_OUTPUT_H
+#define _POSITIONAL_OUTPUT_H
+
+#include <atomic>
+#include <string>
+
+#include "OutputIndex.h"
+#include "PipelineStats.h"
+#include "WaitWord.h"
+
+
+/// <summary>Writes every line's result straight to its own place in the output file, worked out when the line is read.</summary>
+/// <remarks>
+///     The length of a line's result is known as soon as the line is read: "a,b,c\n" is two bytes per character that
+///     is not whitespace, a line of nothing but whitespace is a lone "\n", and an empty line has no result at all.
+///     The reader adds the lengths up as it goes, and hands every line the offset of its result (<see cref="Reserve"/>);
+///     the workers write their results there (<see cref="Complete"/>), in whatever order they finish, with no lock
+///     and no waiting for each other.  The file comes out exactly as the ordered output would have it.
+///     Item mode only: a token mode result depends on the values of the numbers, not just on their length.
+/// </remarks>
+class PositionalOutput
+{
+public:
+    static const long long PREALLOCATE_BYTES = 8 * 1024 * 1024;   // Disk space set aside at a time, ahead of the reader.
+
+private:
+    const std::string _path;
+    int               _descriptor;
+    PipelineStats    *_stats;
+    OutputIndex      *_index;
+
+    // The reader's alone.
+    long long _reserved;    // The end of the last line's result.
+    long long _allocated;   // The end of the disk space set aside.
+
+    std::atomic<bool> _writeFailed;
+
+    // Lines completed, with or without output; WaitUntilCompleted() is only woken once its count is reached.
+    std::atomic<int> _linesCompleted;
+    std::atomic<int> _linesAwaited;
+    WaitWord         _linesCompletedPublished;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="PositionalOutput"/> class, creating the output file.</summary>
+    /// <param name="path">The output file.</param>
+    /// <param name="stats">Where to record the write stage; nullptr for none.</param>
+    /// <param name="index">Where to record the length of each line's result; nullptr for none.</param>
+    explicit PositionalOutput(const std::string &path, PipelineStats *stats = nullptr, OutputIndex *index = nullptr);
+
+    /// <summary>Finalizes an instance of the <see cref="PositionalOutput"/> class, closing the file if it is still open.</summary>
+    ~PositionalOutput();
+
+    /// <summary>Determines whether the output file was created.</summary>
+    bool IsOpen() const { return _descriptor >= 0; }
+
+    /// <summary>The output file.</summary>
+    const std::string &Path() const { return _path; }
+
+    /// <summary>The length of a line's result, from the line as read.</summary>
+    static long long ResultLength(const std::string &itemString);
+
+    /// <summary>Sets aside the place of the next line's result; the reader only, in line order.</summary>
+    long long Reserve(long long length);
+
+    /// <summary>Completes a line: writes its result at its place.</summary>
+    /// <param name="lineNumber">The input line number.</param>
+    /// <param name="offset">The place set aside for it by <see cref="Reserve"/>.</param>
+    /// <param name="text">The formatted result; empty for lines which produce no output.</param>
+    /// <param name="readAt">When the line was read, for the end-to-end latency; 0 if unknown.</param>
+    void Complete(int lineNumber, long long offset, const std::string &text, long long readAt = 0);
+
+    /// <summary>Waits until <paramref name="lineCount" /> lines have been completed.</summary>
+    void WaitUntilCompleted(int lineCount);
+
+    /// <summary>Cuts the file to the results, and closes it; once every line has been completed.</summary>
+    bool Finish();
+
+    /// <summary>The number of lines completed.</summary>
+    int LinesCompleted() const { return _linesCompleted; }
+
+
+    /// Block the copy constructor.
+    PositionalOutput(PositionalOutput &) = delete;
+
+    /// Block the move constructor.
+    PositionalOutput(PositionalOutput &&) = delete;
+
+    /// Block the copy assignment operator.
+    PositionalOutput operator =(PositionalOutput &) = delete;
+
+    /// Block the move assignment operator.
+    PositionalOutput operator =(PositionalOutput &&) = delete;
+};
+
+#endif  // _POSITIONAL_OUTPUT_H
@@ -18,63 +18,213 @@
 
 #include <condition_variable>
 #include <fstream>
+#include <istream>
 #include <mutex>
+#include <ostream>
 #include <string>
 #include <thread>
 
 #include "Algorithms/SortAlgorithm.h"
 #include "ConcurrentQueue.h"
+#include "ExternalSorter.h"
 #include "ItemConsumer.h"
+#include "MetricsReporter.h"
+#include "OrderedOutput.h"
+#include "OutputIndex.h"
+#include "PipelineStats.h"
+#include "PositionalOutput.h"
+#include "ProfiledMutex.h"
+#include "ProcessOptions.h"
+#include "SlabArena.h"
+#include "UnorderedOutput.h"
+#include "WaitWord.h"
 #include "WorkItem.h"
+#include "WorkStealingPool.h"
 
 /// <summary>
 ///     Process the specified input file.
 /// </summary>
+/// <remarks>
+///     Or any input stream, into any output stream; see <see cref="LineProcessor"/> for the in-process API.
+/// </remarks>
 class ProcessInputFile
 {
 public:
     static const int MAX_BUF_LENGTH       = 2048;
     static const int MAX_CHARS            = 100;
     static const int MAX_LINES            = 10000;
-    static const int MAX_CONSUMER_THREADS = 4;
+
+    // Elastic mode: how often the consumers are reviewed, and how idle a consumer has to be to get parked.
+    static const int        SCALER_INTERVAL_MS = 20;
+    static constexpr double IDLE_PARK_FRACTION = 0.75;
+
+    // Lines with at least this many spaces are split across workers by the work-stealing scheduler.
+    static const int SPLIT_WHITESPACE_THRESHOLD = 2;
+
+    // The work-stealing reader keeps at most this many batches per worker in flight, and waits for one to be retired beyond that.
+    static const int BATCHES_PER_WORKER = 4;
+
+    // Every embedded space costs a sleep; the head-of-line scheduler estimates a line's cost from these.
+    static const int SPACE_SLEEP_MS    = 1000;
+    static const int CHARACTER_COST_US = 1;
 
     using item_t     = std::vector<char>;
     using consumer_t = void (*)(WorkItem&&);
 
+    /// <summary>A worker's line buffers; they grow to fit the longest line seen, and are reused for every line after it.</summary>
+    struct LineBuffers
+    {
+        std::vector<char>     Item;        // The line, filtered, then sorted in place.
+        std::vector<uint64_t> Tokens;      // Token mode: the line's numbers.
+        std::string           Formatted;   // The result.
+    };
+
 private:
+    /// <summary>A batch of lines, handed to the work-stealing scheduler as one task.</summary>
+    struct LineBatch
+    {
+        ProcessInputFile        *Producer;
+        int                      FirstLineNumber;
+        long long                SubmittedAt;   // For the statistics only.
+        std::string              Text;            // The lines, end to end; a recycled batch reads into the room it already has.
+        std::vector<size_t>      LineEnds;        // Where each line ends in Text.
+        std::vector<long long>   OutputOffsets;   // Positional mode only: where each line's result goes.
+        std::atomic<int>         Remaining;   // Lines not yet completed; the last one out retires the batch.
+
+        int         LineCount() const                 { return static_cast<int>(LineEnds.size()); }
+        const char *LineData(const int index) const   { return Text.data() + LineStart(index); }
+        size_t      LineLength(const int index) const { return LineEnds[index] - LineStart(index); }
+        size_t      LineStart(const int index) const  { return (0 == index) ? 0 : LineEnds[index - 1]; }
+    };
+
+    /// <summary>Aggregate mode: one worker's character counts, indexed by unsigned character value.</summary>
+    struct CharacterHistogram
+    {
+        uint64_t Counts[256];
+    };
+
+    /// <summary>Counts the calling thread in, from construction to destruction.</summary>
+    class CountScope
+    {
+    private:
+        std::atomic<int> &_count;
+
+    public:
+        explicit CountScope(std::atomic<int> &count) : _count(count) { ++_count; }
+        ~CountScope() { --_count; }
+
+        CountScope(CountScope &) = delete;
+        CountScope operator =(CountScope &) = delete;
+    };
+
+    /// <summary>A line that has been split into segments, which are filtered in parallel.</summary>
+    struct SplitLine
+    {
+        LineBatch                     *Batch;
+        int                            Index;
+        std::vector<std::string>       Segments;
+        std::vector<std::vector<char>> Filtered;
+        std::atomic<int>               Remaining;   // Segments not yet filtered; the last one out finishes the line.
+    };
+
     // Inputs
     std::string   _inputFile;
     std::string   _outputFile;
     Algorithms::SortAlgorithm _sortAlgorithm;
+    ProcessOptions            _options;
+
+    // Working I/O streams; the files are only opened when the caller did not supply streams of its own.
+    std::unique_ptr<std::ifstream> _inputFileStream;
+    std::unique_ptr<std::ofstream> _outputFileStream;
+    std::istream                  *_inputStream;
+    std::ostream                  *_outputStream;
 
-    // Working I/O streams.
-    std::unique_ptr<std::ifstream> _inputStream;
-    std::ofstream                  _outputStream;
+    // Item data too long to fit inside a WorkItem; per job.
+    SlabArena _itemArena;
+
+    // "--stats" and "--trace" only.  Has to outlive the worker threads below.
+    std::unique_ptr<PipelineStats> _stats;
 
     ConcurrentQueue<WorkItem>            _producerQueue;
     std::vector<ItemConsumer<WorkItem> *> *_consumers;
 
-    std::mutex _outputStreamMutex;
+    // The work-stealing pool is either this job's own, or shared with other jobs; this job only waits for its own tasks.
+    std::unique_ptr<WorkStealingPool> _ownedPool;
+    WorkStealingPool                 *_pool;
+    WorkStealingPool::TaskGroup       _poolTasks;
+    std::unique_ptr<OrderedOutput>    _orderedOutput;
+
+    // The work-stealing scheduler's finished batches, kept for the reader to fill again.
+    std::vector<std::unique_ptr<LineBatch>> _spareBatches;
+    int                                     _batchCount;   // Made so far; the spares, and those in flight.
+    pipeline_mutex_t                        _spareBatchesMutex;
+    pipeline_condition_t                    _spareBatchesCV;
 
-    std::atomic<int>        _lineWritten;
-    std::condition_variable _lineWrittenCV;
+    // "--unordered": takes the place of the ordered output, or of the consumers' own in-order writes, for any scheduler.
+    std::unique_ptr<UnorderedOutput> _unorderedOutput;
 
-#ifdef _DEBUG
-    static std::mutex _consoleMutex;
-#endif
+    // "--positional": the workers write their results straight into the output file, at offsets set when the lines are read.
+    std::unique_ptr<PositionalOutput> _positionalOutput;
+
+    // Aggregate mode: one histogram per pool worker, so that counting takes no lock; reduced into the first at the end.
+    std::vector<CharacterHistogram> _histograms;
+
+    // External sort mode: the consumers hand their lines to this, rather than to the output.
+    std::unique_ptr<ExternalSorter> _externalSorter;
+
+    // "--index": fed by whichever writes the lines in order, the ordered output or the consumers.
+    std::unique_ptr<OutputIndex> _outputIndex;
+
+    // TRACK_ALLOCATIONS builds: the allocations from the end of Initialize() to the end of the last line.
+    AllocationCounts _allocationsAtStart;
+    AllocationCounts _allocationsAtEnd;
+
+    // Elastic mode.
+    std::thread             _scalerThread;
+    std::atomic<bool>       _isScaling;
+    std::mutex              _scalerMutex;
+    std::condition_variable _scalerCV;
+
+    // "--progress" and "--metrics-file".
+    std::unique_ptr<MetricsReporter> _reporter;
+    std::atomic<int>                 _linesRead;
+    std::atomic<int>                 _workersBusy;       // Queue consumers; the work-stealing pool counts its own.
+    mutable std::atomic<int>         _workersSleeping;   // FilterItemString() is const.
+
+    pipeline_mutex_t _outputStreamMutex;
+
+    WaitWord _lineWritten;   // The consumers wait for their turn on it without holding _outputStreamMutex.
 
 public:
     /// <param name="inputFile">The input file.</param>
     /// <param name="outputFile">The output file.</param>
     /// <param name="sortAlgorithm">The sort algorithm.</param>
-    ProcessInputFile(const std::string &inputFile, const std::string &outputFile, const Algorithms::SortAlgorithm sortAlgorithm)
-    {
-        _inputFile     = inputFile;
-        _outputFile    = outputFile;
-        _sortAlgorithm = sortAlgorithm;
+    /// <param name="options">The run-time options.</param>
+    ProcessInputFile(const std::string &inputFile, const std::string &outputFile, const Algorithms::SortAlgorithm sortAlgorithm,
+                     const ProcessOptions &options = ProcessOptions())
+        : ProcessInputFile(inputFile, outputFile, nullptr, nullptr, sortAlgorithm, options, nullptr)
+    { }
 
-        _consumers = new std::vector<ItemConsumer<WorkItem> *>(MAX_CONSUMER_THREADS);
-    }
+
+    /// <param name="input">The input stream; the caller keeps ownership.</param>
+    /// <param name="output">The output stream; the caller keeps ownership.</param>
+    /// <param name="sortAlgorithm">The sort algorithm.</param>
+    /// <param name="options">The run-time options.</param>
+    /// <param name="pool">A long-lived work-stealing pool to run on; nullptr for a pool of the job's own.</param>
+    ProcessInputFile(std::istream &input, std::ostream &output, const Algorithms::SortAlgorithm sortAlgorithm,
+                     const ProcessOptions &options = ProcessOptions(), WorkStealingPool *pool = nullptr)
+        : ProcessInputFile(std::string(), std::string(), &input, &output, sortAlgorithm, options, pool)
+    { }
+
+
+    /// <param name="input">The input stream; the caller keeps ownership.</param>
+    /// <param name="outputFile">The output file.</param>
+    /// <param name="sortAlgorithm">The sort algorithm.</param>
+    /// <param name="options">The run-time options.</param>
+    ProcessInputFile(std::istream &input, const std::string &outputFile, const Algorithms::SortAlgorithm sortAlgorithm,
+                     const ProcessOptions &options = ProcessOptions())
+        : ProcessInputFile(std::string(), outputFile, &input, nullptr, sortAlgorithm, options, nullptr)
+    { }
 
 
     /// <summary>Finalizes an instance of the <see cref="ProcessInputFile" /> class.</summary>
@@ -85,6 +235,12 @@ public:
     /// <returns>Error Code if less than 0.</returns>
     int Process();
 
+    /// <summary>The statistics of the run; nullptr unless "--stats" or "--trace" was given.</summary>
+    PipelineStats *Statistics() const { return _stats.get(); }
+
+    /// <summary>Reads the next item string (raw) from a stream, the way every input line is read.</summary>
+    static bool ReadItemString(std::istream &input, std::string &itemString);
+
 
     /// Block the copy constructor.
     ProcessInputFile(ProcessInputFile &) = delete;
@@ -99,12 +255,76 @@ public:
     ProcessInputFile operator =(ProcessInputFile &&) = delete;
 
 private:
-    /// <summary>Send trace messages to Standard Out.</summary>
-    static void ConsoleTrace(const std::string &msg);
+    ProcessInputFile(const std::string &inputFile, const std::string &outputFile, std::istream *input, std::ostream *output,
+                     const Algorithms::SortAlgorithm sortAlgorithm, const ProcessOptions &options, WorkStealingPool *pool)
+        : _producerQueue(ProducerQueueBackend(options), options.RingCapacity)
+    {
+        _inputFile     = inputFile;
+        _outputFile    = outputFile;
+        _inputStream   = input;
+        _outputStream  = output;
+        _pool          = pool;
+        _sortAlgorithm = sortAlgorithm;
+        _options       = options;
+
+        // The external sort runs on the queue consumers; and the output order is its own, whatever the scheduler.
+        if (_options.ExternalSortMemory > 0) {
+            _options.Scheduler = QueueScheduler;
+        }
+
+        _consumers = new std::vector<ItemConsumer<WorkItem> *>(_options.ThreadCount);
+        _isScaling   = false;
+        _lineWritten.Store(0);
+
+        _batchCount      = 0;
+        _linesRead       = 0;
+        _workersBusy     = 0;
+        _workersSleeping = 0;
+
+        _producerQueue.ProfileAs("producer queue");
+        NameMutex(_outputStreamMutex, "output stream");
+        NameMutex(_spareBatchesMutex, "spare batches");
+    }
+
+
+    /// <summary>Appends the formatted item string to <paramref name="output" />.</summary>
+    void AppendItemFormattedString(const char *itemSorted, size_t length, std::string &output) const;
+
+    /// <summary>Token mode: parses, sorts and formats the numbers of an item string, into a worker's buffers.</summary>
+    void AppendTokenFormattedString(const char *itemString, size_t length, LineBuffers &buffers) const;
+
+    /// <summary>"--max-allocations-per-line": fails the run if the lines took more allocations than that.</summary>
+    int CheckAllocations() const;
 
     /// <summary>Consume an item in the producer queue.</summary>
     static void Consumer(WorkItem && workItem);
 
+    /// <summary>Aggregate mode, work-stealing task: counts the characters of a <see cref="LineBatch"/>.</summary>
+    static void CountBatch(WorkStealingPool &pool, void *context, int begin, int end);
+
+    /// <summary>Reads the input, handing batches of lines to the work-stealing pool.</summary>
+    /// <param name="task">The task to run on each batch.</param>
+    /// <returns>The number of lines read.</returns>
+    int DistributeLineBatches(WorkStealingPool::task_function_t task = &ProcessInputFile::ProcessBatch);
+
+    /// <summary>Estimates the processing cost of a line, in microseconds.</summary>
+    long long EstimateLineCost(const std::string &itemString) const;
+
+    /// <summary>Filters the embedded spaces out of an item string, waiting for each one.</summary>
+    void FilterItemString(const char *itemString, size_t length, std::vector<char> &itemFiltered) const;
+
+    /// <summary>Completes the index, if one was asked for.</summary>
+    int FinishIndex();
+
+    /// <summary>Work-stealing task: filters segments [begin, end) of a <see cref="SplitLine"/>.</summary>
+    static void FilterSegments(WorkStealingPool &pool, void *context, int begin, int end);
+
+    /// <summary>Sorts and formats a filtered line, in a worker's buffers (a raw one, in token mode), and completes it.</summary>
+    void FinishLine(LineBatch *batch, int index, LineBuffers &buffers);
+
+    /// <summary>Completes the positional output: cuts the file to the results, and closes it.</summary>
+    int FinishPositionalOutput();
+
     /// <summary>Get the next item string (raw) from the input stream.</summary>
     /// <param name="edittedString">The editted string.</param>
     /// <returns><see langword="true"/> if successful, <see langword="false"/> otherwise.</returns>
@@ -114,15 +334,69 @@ private:
     /// <returns>If less than zero, any associated error code.</returns>
     int Initialize();
 
-    std::string ParseAndSortItemString(const std::string &itemString) const;
+    /// <summary>Aggregate mode, work-stealing task: adds histogram <paramref name="end"/> into histogram <paramref name="begin"/>.</summary>
+    static void MergeHistograms(WorkStealingPool &pool, void *context, int begin, int end);
+
+    /// <summary>Takes a spare batch, or makes a new one if there is none; waits for one, if enough are in flight.</summary>
+    LineBatch *NewLineBatch();
+
+    /// <summary>Work-stealing task: processes lines [begin, end) of a <see cref="LineBatch"/>.</summary>
+    static void ProcessBatch(WorkStealingPool &pool, void *context, int begin, int end);
+
+    /// <summary>Processes one line of a batch, splitting it first if it is large.</summary>
+    void ProcessLine(WorkStealingPool &pool, LineBatch *batch, int index);
+
+    /// <summary>Reads and processes every line, with whichever scheduler was asked for.</summary>
+    int ProcessLines();
+
+    /// <summary>The storage behind the producer queue.</summary>
+    static QueueBackend ProducerQueueBackend(const ProcessOptions &options);
+
+    /// <summary>Aggregate mode: combines the per-worker histograms into the first one, pairwise, in a tree.</summary>
+    void ReduceHistograms();
+
+    /// <summary>Reports how long the output was blocked behind the line at the output frontier.</summary>
+    void ReportOutputStalls() const;
+
+    /// <summary>Reports the run statistics, if they were asked for, and the lock and allocation profiles of builds with them.</summary>
+    void ReportStatistics() const;
 
-    std::string ToItemFormattedString(const std::string &itemStringSorted) const;
+    /// <summary>Keeps a finished batch, and its buffers, for the reader to fill again.</summary>
+    void RetireLineBatch(LineBatch *batch);
 
-    std::string ToItemSortedString(const std::string &itemStringFiltered) const;
+    /// <summary>Samples the progress of the job, for the <see cref="MetricsReporter"/>.</summary>
+    static void SampleProgress(void *context, ProgressSnapshot &snapshot);
+
+    /// <summary>Elastic mode: adds and parks consumers to follow the queue depth and their idle time.</summary>
+    void ScaleConsumers();
+
+    /// <summary>Sorts an item, in place.</summary>
+    void SortItem(std::vector<char> &item) const;
+
+    /// <summary>External sort mode: sorts a run of lines, for the <see cref="ExternalSorter"/>.</summary>
+    static void SortRun(void *context, std::vector<std::string> &run);
+
+    /// <summary>Starts the progress reports, if they were asked for.</summary>
+    void StartReporting();
+
+    /// <summary>Stops the progress reports, after a final one.</summary>
+    void StopReporting();
+
+    /// <summary>Elastic mode: stops the thread running <see cref="ScaleConsumers"/>.</summary>
+    void StopScaling();
+
+    /// <summary>Stops the worker threads, letting them finish what they are doing.</summary>
+    void StopWorkers();
 
     /// <summary>Waits for queue to empty.</summary>
     /// <param name="linesRead">The lines read.</param>
     void WaitForQueueToEmpty(int linesRead);
+
+    /// <summary>Aggregate mode: writes the reduced histogram, in the form asked for.</summary>
+    int WriteAggregate();
+
+    /// <summary>Writes the trace, if one was asked for.</summary>
+    int WriteTrace() const;
 };
 
 #endif // _PROCESS_INPUT_FILE_H
@@ -0,0 +1,234 @@
+// =============================================================================================================================================
+// <copyright file="ProcessOptions.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: ProcessOptions.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 9:40 AM
+//  Purpose: Run-time (startup) options for processing an input file.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _PROCESS_OPTIONS_H
+#define _PROCESS_OPTIONS_H
+
+#include <string>
+
+#include "ConcurrentQueue.h"
+
+
+/// <summary>How lines are handed to the worker threads.</summary>
+enum SchedulerKind
+{
+    /// <summary>A fixed set of <see cref="ItemConsumer"/> threads on one shared producer queue, one line at a time.</summary>
+    QueueScheduler = 0,
+
+    /// <summary>A <see cref="WorkStealingPool"/>, fed with batches of lines.</summary>
+    WorkStealingScheduler,
+
+    /// <summary>
+    ///     Head-of-line aware: the queue scheduler on a <see cref="PriorityBackend"/> queue, ordered by each line's
+    ///     estimated cost and its distance from the output frontier, with non-blocking ordered output.
+    /// </summary>
+    HeadOfLineScheduler
+};
+
+
+/// <summary>Returns the supported schedulers.</summary>
+inline std::string SupportedSchedulers()
+{
+    return "queue | stealing | hol";
+}
+
+
+/// <summary>Translate the string to a scheduler.</summary>
+/// <param name="schedulerName">The scheduler name.</param>
+/// <param name="scheduler">The scheduler, when recognized.</param>
+/// <returns>true / false - depending upon success.</returns>
+inline bool ToScheduler(const std::string &schedulerName, SchedulerKind &scheduler)
+{
+    if (schedulerName == "queue") {
+        scheduler = QueueScheduler;
+        return true;
+    }
+
+    if (schedulerName == "stealing") {
+        scheduler = WorkStealingScheduler;
+        return true;
+    }
+
+    if (schedulerName == "hol") {
+        scheduler = HeadOfLineScheduler;
+        return true;
+    }
+
+    return false;
+}
+
+
+/// <summary>Whether to write one output line per item, or one result for the whole input.</summary>
+enum AggregateMode
+{
+    /// <summary>One output line per item.</summary>
+    NoAggregate = 0,
+
+    /// <summary>One line: every character of the input, sorted, in the per-item format "a,a,b,c\n".</summary>
+    SortedAggregate,
+
+    /// <summary>One "c,count\n" line per character of the input, in sort order.</summary>
+    HistogramAggregate
+};
+
+
+/// <summary>Returns the supported aggregate modes.</summary>
+inline std::string SupportedAggregateModes()
+{
+    return "sorted | histogram";
+}
+
+
+/// <summary>Translate the string to an aggregate mode.</summary>
+/// <param name="aggregateName">The aggregate mode name.</param>
+/// <param name="aggregate">The aggregate mode, when recognized.</param>
+/// <returns>true / false - depending upon success.</returns>
+inline bool ToAggregateMode(const std::string &aggregateName, AggregateMode &aggregate)
+{
+    if (aggregateName == "sorted") {
+        aggregate = SortedAggregate;
+        return true;
+    }
+
+    if (aggregateName == "histogram") {
+        aggregate = HistogramAggregate;
+        return true;
+    }
+
+    return false;
+}
+
+
+/// <summary>Whether, and how, to report the run statistics.</summary>
+enum StatsFormat
+{
+    NoStats = 0,
+    TextStats,
+    JsonStats
+};
+
+
+/// <summary>
+///     Run-time (startup) options for processing an input file.
+///     The defaults reproduce the original behaviour, so the three positional arguments alone are still enough.
+/// </summary>
+struct ProcessOptions
+{
+    // The original specification: a maximum of 4 worker threads.
+    static const int DEFAULT_THREAD_COUNT = 4;
+
+    // External sort mode, when no memory budget is given.
+    static const size_t DEFAULT_EXTERNAL_SORT_MEMORY = 64 * 1024 * 1024;
+
+    /// <summary>The storage behind the producer queue; the head-of-line scheduler always uses the priority backend.</summary>
+    QueueBackend Queue = DEFAULT_QUEUE_BACKEND;
+
+    /// <summary>The ring capacity, for the ring backend only.</summary>
+    size_t RingCapacity = ConcurrentQueue<int>::DEFAULT_RING_CAPACITY;
+
+    /// <summary>How lines are handed to the worker threads.</summary>
+    SchedulerKind Scheduler = QueueScheduler;
+
+    /// <summary>Lines per batch, for the work-stealing scheduler only.</summary>
+    int BatchSize = 64;
+
+    /// <summary>
+    ///     Token mode: split every item on its whitespace, and sort the tokens numerically, as 64-bit integers, rather
+    ///     than sorting the item's characters.  The whitespace is a separator here, so it costs no sleep.
+    /// </summary>
+    bool Tokens = false;
+
+    /// <summary>
+    ///     Aggregate mode: count the characters of the whole input, on the work-stealing pool whatever the scheduler,
+    ///     and write the combined result once.  No item is looked at on its own, so the whitespace costs no sleep.
+    /// </summary>
+    AggregateMode Aggregate = NoAggregate;
+
+    /// <summary>
+    ///     External sort mode: sort the output lines of the whole input, within this much memory, in bytes; 0 for off.
+    ///     The queue consumers sort runs of lines and spill them to temporary files, which are merged into the output at
+    ///     the end.  The input is read to its end, past <see cref="ProcessInputFile::MAX_LINES"/>, through a bounded
+    ///     ring queue, so that the reader cannot run ahead of the consumers.
+    /// </summary>
+    size_t ExternalSortMemory = 0;
+
+    /// <summary>Where the external sort puts its run files; empty for the system's temporary directory.</summary>
+    std::string SortTempDirectory;
+
+    /// <summary>Write an index of the byte offset of every line's result in the output; see <see cref="OutputIndex"/>.</summary>
+    bool WriteIndex = false;
+
+    /// <summary>The index file; empty for the output file's name with ".idx" added.</summary>
+    std::string IndexFile;
+
+    /// <summary>Incremental mode: the manifest of the previous run, rewritten for the next; see <see cref="IncrementalRun"/>.</summary>
+    std::string ManifestFile;
+
+    /// <summary>
+    ///     Unordered mode: write every result as soon as it is done, tagged "&lt;line number&gt;\t", in no particular order;
+    ///     see <see cref="UnorderedOutput"/>.  The RestoreOrder tool puts them back in order.
+    /// </summary>
+    bool Unordered = false;
+
+    /// <summary>
+    ///     Positional mode: every result is written straight to its place in the output file, set from the line's length
+    ///     when it is read; no worker waits for another.  See <see cref="PositionalOutput"/>.  Item mode, output files only.
+    /// </summary>
+    bool Positional = false;
+
+    /// <summary>
+    ///     Sharded mode: the number of processes to split the input across, each running the pipeline on a slice of its own;
+    ///     1 for none.  See <see cref="ShardedRun"/>.  POSIX only.
+    /// </summary>
+    int ShardCount = 1;
+
+    /// <summary>The number of worker threads; the most worker threads in elastic mode.</summary>
+    int ThreadCount = DEFAULT_THREAD_COUNT;
+
+    /// <summary>Elastic mode: add and park queue consumers as the queue depth and their idle time dictate.</summary>
+    bool ElasticThreads = false;
+
+    /// <summary>Per-stage latency histograms, per-thread busy/idle time and throughput, reported at the end.</summary>
+    StatsFormat Stats = NoStats;
+
+    /// <summary>Where to write a Chrome trace event format timeline of the run; empty for none.</summary>
+    std::string TraceFile;
+
+    /// <summary>Write a progress line to stderr every <see cref="ProgressIntervalMs"/>.</summary>
+    bool Progress = false;
+
+    /// <summary>Where to keep Prometheus text-format metrics, rewritten every <see cref="ProgressIntervalMs"/>; empty for none.</summary>
+    std::string MetricsFile;
+
+    /// <summary>How often to report progress.</summary>
+    int ProgressIntervalMs = 1000;
+
+    /// <summary>
+    ///     Virtual time: skip the sleeps, and report the wall time the run would have taken; see <see cref="VirtualClock"/>.
+    ///     The clock is process-wide, so this is for the command line run only.
+    /// </summary>
+    bool VirtualTime = false;
+
+    /// <summary>
+    ///     Allocation budget: fail the run (-18) if its lines took more heap allocations each than this, on average,
+    ///     from the end of the setup to the last line written; negative for none.  TRACK_ALLOCATIONS builds only.
+    /// </summary>
+    double MaxAllocationsPerLine = -1.0;
+
+    /// <summary>Print the end-of-run reports (output stalls, statistics, lock profile) to stdout; off for in-process use.</summary>
+    bool ConsoleReports = true;
+};
+
+#endif  // _PROCESS_OPTIONS_H
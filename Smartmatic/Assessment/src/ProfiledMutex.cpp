@@ -0,0 +1,250 @@
+// =============================================================================================================================================
+// <copyright file="ProfiledMutex.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: ProfiledMutex.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 5:05 PM
+//  Purpose: A mutex that profiles its own contention; compiled in for the per-line locks with the PROFILE_LOCKS option.
+// </summary>
+// =============================================================================================================================================
+
+#include "ProfiledMutex.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <vector>
+
+
+namespace
+{
+    /// <summary>Every profiled lock alive, and the profiles of those gone, one per name.</summary>
+    struct LockRegistry
+    {
+        std::mutex                                          Mutex;
+        std::vector<const ProfiledMutex *>                  Live;
+        std::map<std::string, std::unique_ptr<LockProfile>> Retired;
+    };
+
+    /// <summary>The registry; never destroyed, so that locks in static objects can still retire into it.</summary>
+    LockRegistry &Registry()
+    {
+        static LockRegistry *registry = new LockRegistry();
+        return *registry;
+    }
+
+    /// <summary>The profile of a name within a set of totals; added if new.</summary>
+    LockProfile &Totals(std::map<std::string, std::unique_ptr<LockProfile>> &totals, const std::string &name)
+    {
+        auto &profile = totals[name];
+        if (nullptr == profile) {
+            profile = std::make_unique<LockProfile>(name);
+        }
+
+        return *profile;
+    }
+
+    void Add(std::atomic<long long> &counter, const long long value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+
+/// <summary>Adds another profile's counts to this one.  Single writer.</summary>
+/// <param name="other">The other profile.</param>
+void LockProfile::Merge(const LockProfile &other)
+{
+    Add(Acquisitions, other.Acquisitions);
+    Add(Contended, other.Contended);
+    Wait.Merge(other.Wait);
+    Hold.Merge(other.Hold);
+}
+
+
+/// <summary>Initializes a new instance of the <see cref="ProfiledMutex"/> class.</summary>
+/// <param name="name">The name to report the lock under.</param>
+ProfiledMutex::ProfiledMutex(const char *name)
+    : _acquiredAt(0),
+      _profile(name)
+{
+    auto &registry = Registry();
+
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+
+    registry.Live.push_back(this);
+}
+
+
+/// <summary>Finalizes an instance of the <see cref="ProfiledMutex"/> class; its profile stays in the report.</summary>
+ProfiledMutex::~ProfiledMutex()
+{
+    auto &registry = Registry();
+
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+
+    registry.Live.erase(std::find(registry.Live.begin(), registry.Live.end(), this));
+    if (_profile.Acquisitions > 0) {
+        Totals(registry.Retired, _profile.Name).Merge(_profile);
+    }
+}
+
+
+/// <summary>Acquires the lock, waiting as long as it takes.</summary>
+void ProfiledMutex::lock()
+{
+    const long long askedAt = PipelineStats::Now();
+    if (_mutex.try_lock())
+    {
+        Acquired(askedAt, false);
+        return;
+    }
+
+    _mutex.lock();
+    Acquired(askedAt, true);
+}
+
+
+/// <summary>Acquires the lock if it is free.</summary>
+/// <returns>true / false - depending upon success.</returns>
+bool ProfiledMutex::try_lock()
+{
+    const long long askedAt = PipelineStats::Now();
+    if (!_mutex.try_lock()) {
+        return false;
+    }
+
+    Acquired(askedAt, false);
+    return true;
+}
+
+
+/// <summary>Releases the lock.</summary>
+void ProfiledMutex::unlock()
+{
+    _profile.Hold.Record(PipelineStats::Now() - _acquiredAt);
+    _mutex.unlock();
+}
+
+
+/// <summary>Books an acquisition; the caller now holds the lock.</summary>
+/// <param name="askedAt">When the caller asked for the lock.</param>
+/// <param name="contended">Whether the lock was taken at the time.</param>
+void ProfiledMutex::Acquired(const long long askedAt, const bool contended)
+{
+    _acquiredAt = PipelineStats::Now();
+    _profile.Wait.Record(_acquiredAt - askedAt);
+
+    Add(_profile.Acquisitions, 1);
+    if (contended) {
+        Add(_profile.Contended, 1);
+    }
+}
+
+
+/// <summary>Writes the profile of every lock: a table, or a single JSON object.  Writes nothing if there are none.</summary>
+/// <param name="stream">The stream.</param>
+/// <param name="json">JSON, rather than a table.</param>
+/// <remarks>Live locks are read without stopping them; the numbers are only exact once the workers have stopped.</remarks>
+void ProfiledMutex::Report(std::ostream &stream, const bool json)
+{
+    static const double PERCENTILES[]      = { 50.0, 99.0 };
+    static const char  *PERCENTILE_NAMES[] = { "p50", "p99" };
+
+    std::map<std::string, std::unique_ptr<LockProfile>> totals;
+    {
+        auto &registry = Registry();
+
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+
+        for (const auto &retired : registry.Retired) {
+            Totals(totals, retired.first).Merge(*retired.second);
+        }
+
+        for (auto mutex : registry.Live)
+        {
+            if (mutex->_profile.Acquisitions > 0) {
+                Totals(totals, mutex->_profile.Name).Merge(mutex->_profile);
+            }
+        }
+    }
+
+    if (totals.empty()) {
+        return;
+    }
+
+    const auto micro = [](const long long nanoseconds){ return static_cast<double>(nanoseconds) / 1000.0; };
+    const auto milli = [](const long long nanoseconds){ return static_cast<double>(nanoseconds) / 1e6; };
+
+    const auto oldFlags     = stream.flags();
+    const auto oldPrecision = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+
+    if (json)
+    {
+        stream << "{\"locks\":{";
+        auto first = true;
+        for (const auto &entry : totals)
+        {
+            const auto &profile = *entry.second;
+            stream << (first ? "" : ",") << "\"" << profile.Name << "\":{\"acquisitions\":" << profile.Acquisitions
+                   << ",\"contended\":" << profile.Contended;
+
+            for (auto histogram : { std::make_pair("wait", &profile.Wait), std::make_pair("hold", &profile.Hold) })
+            {
+                stream << ",\"" << histogram.first << "\":{\"totalMs\":" << milli(histogram.second->Total());
+                for (auto p = 0; p < 2; ++p) {
+                    stream << ",\"" << PERCENTILE_NAMES[p] << "Us\":" << micro(histogram.second->ValueAtPercentile(PERCENTILES[p]));
+                }
+
+                stream << ",\"maxUs\":" << micro(histogram.second->Max()) << "}";
+            }
+
+            stream << "}";
+            first = false;
+        }
+
+        stream << "}}" << std::endl;
+    }
+    else
+    {
+        stream << std::setprecision(1)
+               << "  Lock                 acquired  contended  contended%    wait ms  wait p50  wait p99  wait max"
+               << "    hold ms  hold p50  hold p99  hold max" << std::endl;
+
+        for (const auto &entry : totals)
+        {
+            const auto &profile      = *entry.second;
+            const auto  acquisitions = std::max<long long>(profile.Acquisitions, 1);
+            stream << "  " << std::left << std::setw(20) << profile.Name << std::right << std::setw(10) << profile.Acquisitions
+                   << std::setw(11) << profile.Contended
+                   << std::setw(12) << 100.0 * static_cast<double>(profile.Contended) / static_cast<double>(acquisitions);
+
+            for (auto histogram : { &profile.Wait, &profile.Hold })
+            {
+                stream << std::setw(11) << milli(histogram->Total());
+                for (auto percentile : PERCENTILES) {
+                    stream << std::setw(10) << micro(histogram->ValueAtPercentile(percentile));
+                }
+
+                stream << std::setw(10) << micro(histogram->Max());
+            }
+
+            stream << std::endl;
+        }
+
+        stream << "  (wait and hold percentiles in us)" << std::endl;
+    }
+
+    stream.flags(oldFlags);
+    stream.precision(oldPrecision);
+}
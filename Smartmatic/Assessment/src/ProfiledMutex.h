@@ -0,0 +1,117 @@
+// =============================================================================================================================================
+// <copyright file="ProfiledMutex.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: ProfiledMutex.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 5:05 PM
+//  Purpose: A mutex that profiles its own contention; compiled in for the per-line locks with the PROFILE_LOCKS option.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _PROFILED_MUTEX_H
+#define _PROFILED_MUTEX_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "PipelineStats.h"
+
+
+/// <summary>What a lock, or all the locks of one name, went through.</summary>
+struct LockProfile
+{
+    std::string            Name;
+    std::atomic<long long> Acquisitions;
+    std::atomic<long long> Contended;   // Acquisitions that found the lock taken.
+    LatencyHistogram       Wait;        // Every acquisition, from asking for the lock until getting it.
+    LatencyHistogram       Hold;        // From getting the lock until releasing it.
+
+    explicit LockProfile(const std::string &name)
+        : Name(name),
+          Acquisitions(0),
+          Contended(0)
+    { }
+
+    /// <summary>Adds another profile's counts to this one.  Single writer.</summary>
+    void Merge(const LockProfile &other);
+};
+
+
+/// <summary>A mutex that profiles its own contention: acquisitions, contended acquisitions, wait and hold times.</summary>
+/// <remarks>
+///     A drop-in for std::mutex (lock, try_lock, unlock); use std::condition_variable_any to wait on it.
+///     The profile is only ever written by the thread holding the lock, so it needs no lock of its own.
+///     Every instance registers itself, and <see cref="Report"/> sums up all the locks, live or gone, by name.
+/// </remarks>
+class ProfiledMutex
+{
+private:
+    std::mutex  _mutex;
+    long long   _acquiredAt;
+    LockProfile _profile;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="ProfiledMutex"/> class.</summary>
+    /// <param name="name">The name to report the lock under.</param>
+    explicit ProfiledMutex(const char *name = "unnamed");
+
+    /// <summary>Finalizes an instance of the <see cref="ProfiledMutex"/> class; its profile stays in the report.</summary>
+    ~ProfiledMutex();
+
+    /// <summary>Renames the lock; before it is first used.</summary>
+    void Name(const char *name) { _profile.Name = name; }
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    /// <summary>Writes the profile of every lock: a table, or a single JSON object.  Writes nothing if there are none.</summary>
+    static void Report(std::ostream &stream, bool json);
+
+
+    /// Block the copy constructor.
+    ProfiledMutex(ProfiledMutex &) = delete;
+
+    /// Block the move constructor.
+    ProfiledMutex(ProfiledMutex &&) = delete;
+
+    /// Block the copy assignment operator.
+    ProfiledMutex operator =(ProfiledMutex &) = delete;
+
+    /// Block the move assignment operator.
+    ProfiledMutex operator =(ProfiledMutex &&) = delete;
+
+private:
+
+    /// <summary>Books an acquisition; the caller now holds the lock.</summary>
+    void Acquired(long long askedAt, bool contended);
+};
+
+
+// The locks on the per-line path.  They are only profiled in a PROFILE_LOCKS build, because profiling costs two clock
+// reads per acquisition and turns every condition variable into a std::condition_variable_any.
+#ifdef PROFILE_LOCKS
+using pipeline_mutex_t     = ProfiledMutex;
+using pipeline_condition_t = std::condition_variable_any;
+#else
+using pipeline_mutex_t     = std::mutex;
+using pipeline_condition_t = std::condition_variable;
+#endif
+
+
+/// <summary>Names a per-line lock for the profile; nothing to do unless it is profiled.</summary>
+inline void NameMutex(std::mutex &, const char *) { }
+
+/// <summary>Names a per-line lock for the profile.</summary>
+inline void NameMutex(ProfiledMutex &mutex, const char *name) { mutex.Name(name); }
+
+#endif  // _PROFILED_MUTEX_H
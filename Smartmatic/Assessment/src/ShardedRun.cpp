@@ -0,0 +1,330 @@
+// =============================================================================================================================================
+// <copyright file="ShardedRun.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: ShardedRun.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-20, 1:30 AM
+//  Purpose: Runs the pipeline in several processes, one per slice of the input, and joins their outputs in order.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _MSC_VER
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+
+#include "ShardedRun.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Algorithms/TextKernels.h"
+#include "Clock.h"
+#include "Compatibility.h"
+#include "ProcessInputFile.h"
+
+
+const int ShardedRun::MAX_SHARDS;
+
+
+/// <param name="inputFile">The input file.</param>
+/// <param name="outputFile">The output file.</param>
+/// <param name="sortAlgorithm">The sort algorithm.</param>
+/// <param name="options">The run-time options; <see cref="ProcessOptions::ShardCount"/> is the number of processes.</param>
+ShardedRun::ShardedRun(const std::string &inputFile, const std::string &outputFile, const Algorithms::SortAlgorithm sortAlgorithm,
+                       const ProcessOptions &options)
+    : _inputFile(inputFile),
+      _outputFile(outputFile),
+      _sortAlgorithm(sortAlgorithm),
+      _options(options)
+{ }
+
+
+/// <summary>Processes this instance.</summary>
+/// <returns>Error Code if less than 0.</returns>
+int ShardedRun::Process()
+{
+    int errorCode = ReadInput();
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    PlanShards();
+
+    // Whatever was started has to be waited for, even if not every shard could be.
+    const int startError = StartShards();
+    const int waitError  = WaitForShards();
+    errorCode = (startError < 0) ? startError : waitError;
+
+    if (errorCode >= 0) {
+        errorCode = AssembleOutput();
+    }
+
+    RemoveShardFiles();
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    ReportShards();
+    return 0;
+}
+
+
+/// <summary>Concatenates the shard files, in order, into the output.</summary>
+/// <returns>Error Code if less than 0.</returns>
+int ShardedRun::AssembleOutput() const
+{
+    // The output is only replaced once it is complete.
+    const std::string temporaryFile = _outputFile + ".sharded";
+    const int         assembled     = CreateFileForWriting(temporaryFile);
+
+    bool      succeeded = assembled >= 0;
+    long long written   = 0;
+    for (size_t k = 0; succeeded && (k < _shards.size()); ++k)
+    {
+        std::ifstream   shardOutput(_shards[k].OutputFile, std::ios::binary | std::ios::ate);
+        const long long length = shardOutput.is_open() ? static_cast<long long>(shardOutput.tellg()) : -1;
+        shardOutput.close();
+
+        const int shard = (length >= 0) ? OpenFileForReading(_shards[k].OutputFile) : -1;
+        succeeded = (shard >= 0) && CopyFileRange(shard, 0, assembled, written, length);
+        written  += length;
+
+        if (shard >= 0) {
+            CloseFile(shard);
+        }
+    }
+
+    succeeded = (assembled >= 0) && CloseFile(assembled) && succeeded;
+    if (!succeeded || !RenameFileOver(temporaryFile, _outputFile))
+    {
+        std::cerr << "Error writing output file '" << _outputFile << "'." << std::endl;
+        std::remove(temporaryFile.c_str());
+        return -12;
+    }
+
+    return 0;
+}
+
+
+/// <summary>The estimated cost of a line, in microseconds; see <see cref="ProcessInputFile::EstimateLineCost"/>.</summary>
+/// <param name="line">The line.</param>
+/// <returns>The estimate: the sleeps for its spaces dominate; token mode does not sleep.</returns>
+long long ShardedRun::EstimateLineCost(const std::string &line) const
+{
+    const long long whitespace = _options.Tokens ? 0 : static_cast<long long>(Algorithms::CountWhitespace(line.data(), line.size()));
+    return (whitespace * ProcessInputFile::SPACE_SLEEP_MS * 1000LL) + (static_cast<long long>(line.size()) * ProcessInputFile::CHARACTER_COST_US);
+}
+
+
+/// <summary>Cuts the input into slices of about the same estimated cost.</summary>
+/// <remarks>No more shards than lines; every shard gets at least one line, but an empty input still gets its one shard.</remarks>
+void ShardedRun::PlanShards()
+{
+    const int lineCount = static_cast<int>(_lines.size());
+    const int count     = std::max(1, std::min(_options.ShardCount, lineCount));
+
+    std::vector<long long> costs(_lines.size());
+    long long              totalCost = 0;
+    for (auto i = 0; i < lineCount; ++i)
+    {
+        costs[i]   = EstimateLineCost(_lines[i]);
+        totalCost += costs[i];
+    }
+
+    _shards.clear();
+    long long costSoFar = 0;
+    int       line      = 0;
+    for (auto k = 0; k < count; ++k)
+    {
+        // Up to this shard's share of the total; but leave a line for each of the shards still to come.
+        const long long targetCost = totalCost * (k + 1) / count;
+        const int       lastLine   = lineCount - (count - 1 - k);
+
+        Shard shard = {};
+        shard.FirstLine  = line;
+        shard.OutputFile = _outputFile + ".shard" + std::to_string(k + 1);
+        while ((line < lastLine) && ((line == shard.FirstLine) || (costSoFar < targetCost) || (k == count - 1))) {
+            costSoFar += costs[line++];
+        }
+
+        shard.LineCount = line - shard.FirstLine;
+        _shards.push_back(shard);
+    }
+}
+
+
+/// <summary>Reads the input.</summary>
+/// <returns>Error Code if less than 0.</returns>
+int ShardedRun::ReadInput()
+{
+    std::ifstream input(_inputFile);
+    if (!input.is_open())
+    {
+        std::cerr << "Error opening input file '" << _inputFile << "'." << std::endl;
+        return -11;
+    }
+
+    AdviseSequentialRead(_inputFile);
+
+    // The same lines, and the same limit, as a full run.
+    std::string line;
+    while ((_lines.size() < ProcessInputFile::MAX_LINES) && ProcessInputFile::ReadItemString(input, line)) {
+        _lines.push_back(line);
+    }
+
+    return 0;
+}
+
+
+/// <summary>Deletes the shard files.</summary>
+void ShardedRun::RemoveShardFiles() const
+{
+    for (const auto &shard : _shards) {
+        std::remove(shard.OutputFile.c_str());
+    }
+}
+
+
+/// <summary>Reports how long each shard took.</summary>
+void ShardedRun::ReportShards() const
+{
+    if (!_options.ConsoleReports) {
+        return;
+    }
+
+    std::cout << "Sharded: " << _lines.size() << " lines in " << _shards.size() << " processes." << std::endl;
+    for (size_t k = 0; k < _shards.size(); ++k)
+    {
+        const Shard &shard = _shards[k];
+        std::cout << "  shard " << (k + 1) << ": lines " << (shard.FirstLine + 1) << "-" << (shard.FirstLine + shard.LineCount) << ", "
+                  << (static_cast<double>(shard.FinishedAt - shard.StartedAt) / 1e9) << " s" << std::endl;
+    }
+}
+
+
+/// <summary>Runs one shard's pipeline; in the child process.</summary>
+/// <param name="shard">The shard.</param>
+/// <returns>Error Code if less than 0.</returns>
+int ShardedRun::RunShard(const Shard &shard) const
+{
+    // The slice goes back through ReadItemString(), which gives back the very same lines.
+    std::string slice;
+    for (auto i = shard.FirstLine; i < shard.FirstLine + shard.LineCount; ++i) {
+        slice.append(_lines[i]).append(1, '\n');
+    }
+
+    std::istringstream input(slice);
+    ProcessInputFile   processor(input, shard.OutputFile, _sortAlgorithm, _options);
+    return processor.Process();
+}
+
+
+/// <summary>Starts a child process for every shard.</summary>
+/// <returns>Error Code if less than 0.</returns>
+int ShardedRun::StartShards()
+{
+#ifdef _MSC_VER
+    std::cerr << "Error starting the shards: there is no fork() on this platform." << std::endl;
+    return -19;
+#else
+    // Anything still buffered would otherwise be written once more by every child.
+    std::cout.flush();
+    std::cerr.flush();
+
+    for (size_t k = 0; k < _shards.size(); ++k)
+    {
+        Shard &shard = _shards[k];
+        shard.StartedAt = Clock::Current().Now();
+
+        const pid_t processId = fork();
+        if (processId < 0)
+        {
+            std::cerr << "Error starting shard " << (k + 1) << " of " << _shards.size() << "." << std::endl;
+            return -19;
+        }
+
+        if (processId == 0)
+        {
+            // The child: its own slice, and threads of its own; the error code goes back as the exit status.
+            const int errorCode = RunShard(shard);
+            std::cout.flush();
+            std::cerr.flush();
+            _exit(errorCode & 0xff);
+        }
+
+        shard.ProcessId = static_cast<int>(processId);
+    }
+
+    return 0;
+#endif
+}
+
+
+/// <summary>Waits for every child process that was started, and reports the ones that failed.</summary>
+/// <returns>Error Code if less than 0: that of the first shard to fail.</returns>
+int ShardedRun::WaitForShards()
+{
+#ifdef _MSC_VER
+    return 0;
+#else
+    int errorCode = 0;
+    int running   = static_cast<int>(std::count_if(_shards.begin(), _shards.end(), [](const Shard &shard){ return shard.ProcessId > 0; }));
+    while (running > 0)
+    {
+        int         status    = 0;
+        const pid_t processId = waitpid(-1, &status, 0);
+        if (processId < 0)
+        {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        const auto shard = std::find_if(_shards.begin(), _shards.end(), [processId](const Shard &s){ return s.ProcessId == processId; });
+        if (shard == _shards.end()) {
+            continue;
+        }
+
+        --running;
+        shard->FinishedAt = Clock::Current().Now();
+        if (WIFEXITED(status)) {
+            shard->ExitCode = static_cast<signed char>(WEXITSTATUS(status));
+        }
+        else
+        {
+            shard->Signal   = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+            shard->ExitCode = -19;
+        }
+
+        if (shard->ExitCode < 0)
+        {
+            std::cerr << "Error in shard " << (shard - _shards.begin() + 1) << " of " << _shards.size() << " (lines "
+                      << (shard->FirstLine + 1) << "-" << (shard->FirstLine + shard->LineCount) << "): ";
+            if (shard->Signal != 0) {
+                std::cerr << "terminated by signal " << shard->Signal << "." << std::endl;
+            }
+            else {
+                std::cerr << "error code " << shard->ExitCode << "." << std::endl;
+            }
+
+            if (errorCode == 0) {
+                errorCode = shard->ExitCode;
+            }
+        }
+    }
+
+    return errorCode;
+#endif
+}
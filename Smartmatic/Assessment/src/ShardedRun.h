@@ -0,0 +1,113 @@
+// =============================================================================================================================================
+// <copyright file="ShardedRun.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: ShardedRun.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-20, 1:30 AM
+//  Purpose: Runs the pipeline in several processes, one per slice of the input, and joins their outputs in order.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _SHARDED_RUN_H
+#define _SHARDED_RUN_H
+
+#include <string>
+#include <vector>
+
+#include "Algorithms/SortAlgorithm.h"
+#include "ProcessOptions.h"
+
+
+/// <summary>"--shards=N": runs the pipeline in N processes, one per slice of the input, and joins their outputs in order.</summary>
+/// <remarks>
+///     The input is read once, by the parent: the same lines, and the same limit, as a full run.  It is cut at line
+///     boundaries into slices of about the same estimated cost (the sleeps for the whitespace dominate), so that the
+///     shards finish at about the same time.  Every slice goes through the usual <see cref="ProcessInputFile"/>
+///     pipeline, threads and all, in a child process of its own (fork()), into a shard file beside the output; the
+///     processes share no locks.  The parent waits for every shard, then concatenates the shard files, in order, into
+///     the output (copy_file_range() where the platform has it), by way of a temporary file and a rename.
+///     A failed shard is reported with its line range, and fails the run; the output file is then left as it was.
+///     POSIX only.
+/// </remarks>
+class ShardedRun
+{
+public:
+    static const int MAX_SHARDS = 64;
+
+private:
+    /// <summary>One slice of the input, and the process working on it.</summary>
+    struct Shard
+    {
+        int         FirstLine;     // Index into _lines.
+        int         LineCount;
+        std::string OutputFile;
+        int         ProcessId;     // 0 until started.
+        int         ExitCode;      // The pipeline's error code, once finished; 0 for success.
+        int         Signal;        // The signal that terminated the process; 0 for none.
+        long long   StartedAt;     // Clock nanoseconds.
+        long long   FinishedAt;
+    };
+
+    std::string               _inputFile;
+    std::string               _outputFile;
+    Algorithms::SortAlgorithm _sortAlgorithm;
+    ProcessOptions            _options;
+
+    std::vector<std::string> _lines;   // This run's input.
+    std::vector<Shard>       _shards;
+
+public:
+
+    /// <param name="inputFile">The input file.</param>
+    /// <param name="outputFile">The output file.</param>
+    /// <param name="sortAlgorithm">The sort algorithm.</param>
+    /// <param name="options">The run-time options; <see cref="ProcessOptions::ShardCount"/> is the number of processes.</param>
+    ShardedRun(const std::string &inputFile, const std::string &outputFile, Algorithms::SortAlgorithm sortAlgorithm,
+               const ProcessOptions &options);
+
+    /// <summary>Processes this instance.</summary>
+    int Process();
+
+
+    /// Block the copy constructor.
+    ShardedRun(ShardedRun &) = delete;
+
+    /// Block the copy assignment operator.
+    ShardedRun operator =(ShardedRun &) = delete;
+
+private:
+
+    /// <summary>Concatenates the shard files, in order, into the output.</summary>
+    int AssembleOutput() const;
+
+    /// <summary>The estimated cost of a line, in microseconds; see <see cref="ProcessInputFile::EstimateLineCost"/>.</summary>
+    long long EstimateLineCost(const std::string &line) const;
+
+    /// <summary>Cuts the input into slices of about the same estimated cost.</summary>
+    void PlanShards();
+
+    /// <summary>Reads the input.</summary>
+    int ReadInput();
+
+    /// <summary>Deletes the shard files.</summary>
+    void RemoveShardFiles() const;
+
+    /// <summary>Reports how long each shard took.</summary>
+    void ReportShards() const;
+
+    /// <summary>Runs one shard's pipeline; in the child process.</summary>
+    int RunShard(const Shard &shard) const;
+
+    /// <summary>Starts a child process for every shard.</summary>
+    int StartShards();
+
+    /// <summary>Waits for every child process that was started, and reports the ones that failed.</summary>
+    int WaitForShards();
+};
+
+#endif  // _SHARDED_RUN_H
@@ -0,0 +1,120 @@
+// =============================================================================================================================================
+// <copyright file="SlabArena.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: SlabArena.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 2:05 PM
+//  Purpose: A per-job slab arena, and a standard allocator on top of it, so that per-line work allocates nothing in steady state.
+// </summary>
+// =============================================================================================================================================
+
+#include "SlabArena.h"
+
+#include <new>
+
+
+/// <summary>Initializes a new instance of the <see cref="SlabArena"/> class.</summary>
+SlabArena::SlabArena()
+    : _freeLists(),
+      _chunkCursor(nullptr),
+      _chunkRemaining(0),
+      _systemAllocations(0)
+{ }
+
+
+/// <summary>Finalizes an instance of the <see cref="SlabArena"/> class, returning every chunk.</summary>
+SlabArena::~SlabArena()
+{
+    for (auto chunk : _chunks) {
+        ::operator delete(chunk);
+    }
+}
+
+
+/// <summary>Allocates a block of at least <paramref name="size" /> bytes.</summary>
+/// <param name="size">The size, in bytes.</param>
+/// <returns>The block; aligned for any fundamental type.</returns>
+void *SlabArena::Allocate(const size_t size)
+{
+    const int sizeClass = SizeClass(size);
+    if (sizeClass < 0)
+    {
+        ++_systemAllocations;
+        return ::operator new(size);
+    }
+
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    FreeBlock *block = _freeLists[sizeClass];
+    if (nullptr != block)
+    {
+        _freeLists[sizeClass] = block->Next;
+        return block;
+    }
+
+    const size_t blockSize = MIN_BLOCK_SIZE << sizeClass;
+    if (_chunkRemaining < blockSize)
+    {
+        // The tail of the old chunk is too small for this class; it is simply abandoned.
+        ++_systemAllocations;
+        _chunkCursor    = static_cast<char *>(::operator new(CHUNK_SIZE));
+        _chunkRemaining = CHUNK_SIZE;
+        _chunks.push_back(_chunkCursor);
+    }
+
+    void *carved = _chunkCursor;
+    _chunkCursor    += blockSize;
+    _chunkRemaining -= blockSize;
+    return carved;
+}
+
+
+/// <summary>Returns a block from <see cref="Allocate"/>.</summary>
+/// <param name="block">The block.</param>
+/// <param name="size">The size that was asked for.</param>
+void SlabArena::Deallocate(void *block, const size_t size)
+{
+    if (nullptr == block) {
+        return;
+    }
+
+    const int sizeClass = SizeClass(size);
+    if (sizeClass < 0)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto freed = static_cast<FreeBlock *>(block);
+    freed->Next = _freeLists[sizeClass];
+    _freeLists[sizeClass] = freed;
+}
+
+
+/// <summary>The size class of a request, or -1 when it is too large for the slabs.</summary>
+/// <param name="size">The size, in bytes.</param>
+int SlabArena::SizeClass(const size_t size)
+{
+    if (size > MAX_BLOCK_SIZE) {
+        return -1;
+    }
+
+    int    sizeClass = 0;
+    size_t blockSize = MIN_BLOCK_SIZE;
+    while (blockSize < size)
+    {
+        blockSize <<= 1;
+        ++sizeClass;
+    }
+
+    return sizeClass;
+}
@@ -0,0 +1,135 @@
+// =============================================================================================================================================
+// <copyright file="SlabArena.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: SlabArena.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 2:05 PM
+//  Purpose: A per-job slab arena, and a standard allocator on top of it, so that per-line work allocates nothing in steady state.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _SLAB_ARENA_H
+#define _SLAB_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+
+/// <summary>A slab arena: fixed size classes carved out of large chunks, recycled through free lists.</summary>
+/// <remarks>
+///     Blocks are rounded up to a power of two between <see cref="MIN_BLOCK_SIZE"/> and <see cref="MAX_BLOCK_SIZE"/>; a
+///     freed block goes onto the free list of its class and is handed out again before any new chunk is carved.  Once a
+///     job has reached its high-water mark, allocation and deallocation never reach the system allocator.
+///     Larger requests go straight to the system allocator.  The chunks are only returned when the arena is destroyed,
+///     so an arena lives as long as one job.  Thread-safe.
+/// </remarks>
+class SlabArena
+{
+public:
+    static const size_t MIN_BLOCK_SIZE = 16;
+    static const size_t MAX_BLOCK_SIZE = 4096;
+    static const size_t CHUNK_SIZE     = 64 * 1024;
+
+private:
+
+    // MIN_BLOCK_SIZE, doubling up to MAX_BLOCK_SIZE.
+    static const int SIZE_CLASSES = 9;
+
+    /// <summary>A free block; the link lives in the block itself.</summary>
+    struct FreeBlock
+    {
+        FreeBlock *Next;
+    };
+
+    std::mutex          _mutex;
+    FreeBlock          *_freeLists[SIZE_CLASSES];
+    std::vector<char *> _chunks;
+    char               *_chunkCursor;
+    size_t              _chunkRemaining;
+
+    std::atomic<long long> _systemAllocations;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="SlabArena"/> class.</summary>
+    SlabArena();
+
+    /// <summary>Finalizes an instance of the <see cref="SlabArena"/> class, returning every chunk.</summary>
+    ~SlabArena();
+
+    /// <summary>Allocates a block of at least <paramref name="size" /> bytes.</summary>
+    void *Allocate(size_t size);
+
+    /// <summary>Returns a block from <see cref="Allocate"/>; <paramref name="size" /> must be the size asked for.</summary>
+    void Deallocate(void *block, size_t size);
+
+    /// <summary>The number of calls this arena has made to the system allocator.</summary>
+    long long SystemAllocations() const { return _systemAllocations; }
+
+
+    /// Block the copy constructor.
+    SlabArena(SlabArena &) = delete;
+
+    /// Block the move constructor.
+    SlabArena(SlabArena &&) = delete;
+
+    /// Block the copy assignment operator.
+    SlabArena operator =(SlabArena &) = delete;
+
+    /// Block the move assignment operator.
+    SlabArena operator =(SlabArena &&) = delete;
+
+private:
+
+    /// <summary>The size class of a request, or -1 when it is too large for the slabs.</summary>
+    static int SizeClass(size_t size);
+};
+
+
+/// <summary>A standard allocator drawing from a <see cref="SlabArena"/>; for the node and block storage of containers.</summary>
+template<typename T> class SlabAllocator
+{
+public:
+    using value_type = T;
+
+private:
+    SlabArena *_arena;
+
+    template<typename U> friend class SlabAllocator;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="SlabAllocator"/> class.</summary>
+    /// <param name="arena">The arena; it must outlive every container using this allocator.</param>
+    explicit SlabAllocator(SlabArena *arena) noexcept
+        : _arena(arena)
+    { }
+
+    /// <summary>Rebinding constructor.</summary>
+    template<typename U> SlabAllocator(const SlabAllocator<U> &other) noexcept
+        : _arena(other._arena)
+    { }
+
+    T *allocate(const size_t count)
+    {
+        return static_cast<T *>(_arena->Allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T *block, const size_t count) noexcept
+    {
+        _arena->Deallocate(block, count * sizeof(T));
+    }
+
+    template<typename U> bool operator ==(const SlabAllocator<U> &other) const noexcept { return _arena == other._arena; }
+
+    template<typename U> bool operator !=(const SlabAllocator<U> &other) const noexcept { return _arena != other._arena; }
+};
+
+#endif  // _SLAB_ARENA_H
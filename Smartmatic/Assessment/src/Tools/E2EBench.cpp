@@ -0,0 +1,514 @@
+// =============================================================================================================================================
+// <copyright file="E2EBench.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: E2EBench
+//     File: E2EBench.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 6:15 PM
+//  Purpose: End-to-end benchmark: runs the whole ProcessInputFile pipeline over a set of inputs, for every combination
+//           of scheduler, sort algorithm and thread count asked for, and reports lines/s, MB/s and the per-line
+//           latency percentiles (from read until written).
+//
+//           Without input files, a built-in suite is generated (see SUITE); the generator is seeded, so the suite is
+//           the same on every run and every platform.  Spaces are left out of the suite, because every one of them
+//           costs a second of sleep, which would swamp everything else; pass GenInput files to measure them.
+//           Or "--virtual-time" them away: the sleeps are skipped, and the times reported are the simulated ones, so
+//           that throughput can be modelled against thread count and whitespace density ("--space-density") in seconds.
+//
+//              1.  E.g.:
+//                  ./E2EBench --threads=1,2,4,8 --algorithms=HeapSort,ShellSort --schedulers=queue,stealing --runs=5
+// </summary>
+// =============================================================================================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Clock.h"
+#include "ProcessInputFile.h"
+#include "ProcessOptions.h"
+#include "Tools/InputGenerator.h"
+
+
+/// <summary>What to run.</summary>
+struct BenchOptions
+{
+    std::vector<std::string>               Inputs;
+    std::vector<SchedulerKind>             Schedulers { QueueScheduler, WorkStealingScheduler, HeadOfLineScheduler };
+    std::vector<Algorithms::SortAlgorithm> SortAlgorithms { Algorithms::HeapSortAlgorithm, Algorithms::ShellSortAlgorithm, Algorithms::RadixSortAlgorithm };
+    std::vector<int>                       ThreadCounts { 1, 2, 4, 8 };
+    int                                    Runs    = 3;
+    int                                    Lines   = ProcessInputFile::MAX_LINES;
+    std::string                            WorkDir = ".";
+    double                                 Spaces  = 0.0;
+    bool                                   Virtual = false;
+    bool                                   Keep    = false;
+    bool                                   Csv     = false;
+};
+
+
+/// <summary>One input of the built-in suite.</summary>
+struct SuiteEntry
+{
+    const char *Name;
+    int         MinLength;
+    int         MaxLength;
+    double      DuplicateRatio;
+    double      Similarity;
+};
+
+static const SuiteEntry SUITE[] =
+{
+    { "short",   1,   10, 0.0, 0.0 },   // Per-line overhead dominates.
+    { "long",   90,  100, 0.0, 0.0 },   // Sorting and formatting dominate.
+    { "mixed",   1,  100, 0.2, 0.5 },   // Anything goes, some of it repeated.
+};
+
+
+/// <summary>The outcome of one run.</summary>
+struct RunResult
+{
+    double    Seconds;
+    long long P50;
+    long long P99;
+    long long P999;
+    long long Max;
+};
+
+
+// Local/Static Method prototypes:
+static int  CheckApplicationOptions(int argc, char *argv[], BenchOptions &options);
+static int  CountLines(const std::string &path, long long &lines, long long &bytes);
+static int  GenerateSuite(BenchOptions &options, std::vector<std::string> &generated);
+static int  RunOnce(const std::string &input, const std::string &output, Algorithms::SortAlgorithm sortAlgorithm,
+                    const ProcessOptions &processOptions, RunResult &result);
+static const char *SchedulerName(SchedulerKind scheduler);
+static std::vector<std::string> SplitList(const std::string &value);
+static void Usage(char *argv[]);
+
+
+/// <summary>Main method.</summary>
+/// <param name="argc">The argument count.</param>
+/// <param name="argv">The argument vector.</param>
+/// <returns>Exit status</returns>
+int main(const int argc, char *argv[])
+{
+    BenchOptions options;
+    int errorCode = CheckApplicationOptions(argc, argv, options);
+    if (errorCode < 0) {
+        exit (errorCode);
+    }
+
+    std::vector<std::string> generated;
+    if (options.Inputs.empty())
+    {
+        errorCode = GenerateSuite(options, generated);
+        if (errorCode < 0) {
+            exit (errorCode);
+        }
+    }
+
+    const std::string output = options.WorkDir + "/E2EBench.out.txt";
+
+    VirtualClock virtualClock;
+    if (options.Virtual) {
+        Clock::Use(&virtualClock);
+    }
+
+    if (options.Csv) {
+        std::cout << "input,lines,bytes,scheduler,algorithm,threads,seconds,linesPerSecond,megabytesPerSecond,p50Us,p99Us,p999Us,maxUs" << std::endl;
+    }
+    else
+    {
+        std::cout << "Median of " << options.Runs << " run(s); latency is per line, from read until written"
+                  << (options.Virtual ? "; in simulated (virtual) time." : ".") << std::endl
+                  << std::left << std::setw(28) << "input" << std::right << std::setw(7) << "lines" << std::setw(9) << "bytes"
+                  << "  " << std::left << std::setw(10) << "scheduler" << std::setw(10) << "algorithm" << std::right << std::setw(8) << "threads"
+                  << std::setw(10) << "seconds" << std::setw(11) << "lines/s" << std::setw(9) << "MB/s"
+                  << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us" << std::setw(10) << "max us" << std::endl;
+    }
+
+    for (const auto &input : options.Inputs)
+    {
+        long long lines, bytes;
+        errorCode = CountLines(input, lines, bytes);
+        if (errorCode < 0) {
+            break;
+        }
+
+        lines = std::min<long long>(lines, ProcessInputFile::MAX_LINES);
+
+        for (auto scheduler : options.Schedulers)
+        {
+            for (auto sortAlgorithm : options.SortAlgorithms)
+            {
+                for (auto threadCount : options.ThreadCounts)
+                {
+                    ProcessOptions processOptions;
+                    processOptions.Scheduler   = scheduler;
+                    processOptions.ThreadCount = threadCount;
+                    processOptions.Stats       = TextStats;
+
+                    std::vector<RunResult> results(options.Runs);
+                    for (auto &result : results)
+                    {
+                        errorCode = RunOnce(input, output, sortAlgorithm, processOptions, result);
+                        if (errorCode < 0) {
+                            break;
+                        }
+                    }
+
+                    if (errorCode < 0) {
+                        break;
+                    }
+
+                    std::sort(results.begin(), results.end(), [](const RunResult &lhs, const RunResult &rhs){ return lhs.Seconds < rhs.Seconds; });
+                    const RunResult &median = results[results.size() / 2];
+
+                    const double seconds        = std::max(median.Seconds, 1e-9);
+                    const double linesPerSecond = static_cast<double>(lines) / seconds;
+                    const double megabytes      = static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds;
+                    const auto   micro          = [](const long long nanoseconds){ return static_cast<double>(nanoseconds) / 1000.0; };
+                    const auto   algorithmName  = Algorithms::ToSortAlgorithmName(sortAlgorithm);
+
+                    std::cout << std::fixed;
+                    if (options.Csv)
+                    {
+                        std::cout << input << "," << lines << "," << bytes << "," << SchedulerName(scheduler) << "," << algorithmName << ","
+                                  << threadCount << "," << std::setprecision(6) << median.Seconds << "," << std::setprecision(1) << linesPerSecond
+                                  << "," << std::setprecision(3) << megabytes << "," << micro(median.P50) << "," << micro(median.P99) << ","
+                                  << micro(median.P999) << "," << micro(median.Max) << std::endl;
+                    }
+                    else
+                    {
+                        const std::string name = (input.size() > 27) ? "..." + input.substr(input.size() - 24) : input;
+                        std::cout << std::left << std::setw(28) << name << std::right << std::setw(7) << lines << std::setw(9) << bytes
+                                  << "  " << std::left << std::setw(10) << SchedulerName(scheduler) << std::setw(10) << algorithmName
+                                  << std::right << std::setw(8) << threadCount << std::setprecision(4) << std::setw(10) << median.Seconds
+                                  << std::setprecision(0) << std::setw(11) << linesPerSecond << std::setprecision(2) << std::setw(9) << megabytes
+                                  << std::setprecision(1) << std::setw(10) << micro(median.P50) << std::setw(10) << micro(median.P99)
+                                  << std::setw(10) << micro(median.P999) << std::setw(10) << micro(median.Max) << std::endl;
+                    }
+                }
+
+                if (errorCode < 0) {
+                    break;
+                }
+            }
+
+            if (errorCode < 0) {
+                break;
+            }
+        }
+
+        if (errorCode < 0) {
+            break;
+        }
+    }
+
+    Clock::Use(nullptr);
+    std::remove(output.c_str());
+    if (!options.Keep)
+    {
+        for (const auto &input : generated) {
+            std::remove(input.c_str());
+        }
+    }
+
+    exit((errorCode < 0) ? errorCode : 0);
+}
+
+
+/// <summary>Checks the "--name=value" options and the input files.</summary>
+/// <param name="argc">The argument count.</param>
+/// <param name="argv">The argv.</param>
+/// <param name="options">The options.</param>
+/// <returns>Exit/Error Code if less than 0.</returns>
+static int CheckApplicationOptions(const int argc, char *argv[], BenchOptions &options)
+{
+    for (auto i = 1; i < argc; ++i)
+    {
+        const std::string            argument = argv[i];
+        const std::string::size_type equals   = argument.find('=');
+        const std::string            name     = argument.substr(0, equals);
+        const std::string            value    = (equals != std::string::npos) ? argument.substr(equals + 1) : "";
+
+        if (argument.compare(0, 2, "--") != 0) {
+            options.Inputs.push_back(argument);
+        }
+        else if (name == "--schedulers")
+        {
+            options.Schedulers.clear();
+            for (const auto &schedulerName : SplitList(value))
+            {
+                SchedulerKind scheduler;
+                if (!ToScheduler(schedulerName, scheduler))
+                {
+                    std::cerr << "Error:" << std::endl
+                              << "Scheduler '" << schedulerName << "' is not available." << std::endl;
+                    return -4;
+                }
+
+                options.Schedulers.push_back(scheduler);
+            }
+        }
+        else if (name == "--algorithms")
+        {
+            options.SortAlgorithms.clear();
+            for (const auto &algorithmName : SplitList(value))
+            {
+                const auto sortAlgorithm = Algorithms::ToSortAlgorithm(algorithmName);
+                if (sortAlgorithm == Algorithms::SortAlgorithm::None)
+                {
+                    std::cerr << "Error:" << std::endl
+                              << "Sort Algorithm '" << algorithmName << "' is not available." << std::endl;
+                    return -3;
+                }
+
+                options.SortAlgorithms.push_back(sortAlgorithm);
+            }
+        }
+        else if (name == "--threads")
+        {
+            options.ThreadCounts.clear();
+            for (const auto &count : SplitList(value))
+            {
+                const long threadCount = strtol(count.c_str(), nullptr, 10);
+                if (threadCount <= 0)
+                {
+                    std::cerr << "Error:" << std::endl
+                              << "Thread count '" << count << "' is not a positive number." << std::endl;
+                    return -4;
+                }
+
+                options.ThreadCounts.push_back(static_cast<int>(threadCount));
+            }
+        }
+        else if ((name == "--runs") || (name == "--lines"))
+        {
+            const long number = strtol(value.c_str(), nullptr, 10);
+            if (number <= 0)
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '" << name << "' needs a positive number, not '" << value << "'." << std::endl;
+                return -4;
+            }
+
+            ((name == "--runs") ? options.Runs : options.Lines) = static_cast<int>(number);
+        }
+        else if ((name == "--work-dir") && !value.empty()) {
+            options.WorkDir = value;
+        }
+        else if (name == "--space-density")
+        {
+            options.Spaces = strtod(value.c_str(), nullptr);
+            if ((options.Spaces < 0.0) || (options.Spaces > 1.0))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '--space-density' needs a fraction from 0 to 1, not '" << value << "'." << std::endl;
+                return -4;
+            }
+        }
+        else if (argument == "--virtual-time") {
+            options.Virtual = true;
+        }
+        else if (argument == "--keep") {
+            options.Keep = true;
+        }
+        else if (argument == "--csv") {
+            options.Csv = true;
+        }
+        else if (argument == "--help")
+        {
+            Usage(argv);
+            return -1;
+        }
+        else
+        {
+            std::cerr << "Error:" << std::endl
+                      << "Option '" << argument << "' is not recognized." << std::endl;
+            return -4;
+        }
+    }
+
+    if (options.Schedulers.empty() || options.SortAlgorithms.empty() || options.ThreadCounts.empty())
+    {
+        std::cerr << "Error:" << std::endl
+                  << "Nothing to run." << std::endl;
+        return -4;
+    }
+
+    return 0;
+}
+
+
+/// <summary>Counts the lines and bytes of an input file.</summary>
+/// <param name="path">The file.</param>
+/// <param name="lines">The line count.</param>
+/// <param name="bytes">The byte count.</param>
+/// <returns>Exit/Error Code if less than 0.</returns>
+static int CountLines(const std::string &path, long long &lines, long long &bytes)
+{
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    if (!stream.is_open())
+    {
+        std::cerr << "Error opening input file '" << path << "'." << std::endl;
+        return -11;
+    }
+
+    lines = 0;
+    bytes = 0;
+
+    char buffer[64 * 1024];
+    char last = '\n';
+    while (stream.read(buffer, sizeof(buffer)) || (stream.gcount() > 0))
+    {
+        const auto count = stream.gcount();
+        lines += std::count(buffer, buffer + count, '\n');
+        bytes += count;
+        last   = buffer[count - 1];
+    }
+
+    // An unterminated last line is still a line.
+    if (last != '\n') {
+        ++lines;
+    }
+
+    return 0;
+}
+
+
+/// <summary>Writes the built-in suite into the work directory.</summary>
+/// <param name="options">The options; the generated files become the inputs.</param>
+/// <param name="generated">The generated files, to clean up.</param>
+/// <returns>Exit/Error Code if less than 0.</returns>
+static int GenerateSuite(BenchOptions &options, std::vector<std::string> &generated)
+{
+    for (const auto &entry : SUITE)
+    {
+        Tools::InputProfile profile;
+        profile.Lines          = options.Lines;
+        profile.MinLength      = entry.MinLength;
+        profile.MaxLength      = entry.MaxLength;
+        profile.DuplicateRatio = entry.DuplicateRatio;
+        profile.Similarity     = entry.Similarity;
+        profile.SpaceDensity   = options.Spaces;
+
+        const std::string path = options.WorkDir + "/E2EBench." + entry.Name + ".txt";
+        Tools::InputGenerator generator(profile);
+        const int errorCode = generator.WriteFile(path);
+        if (errorCode < 0) {
+            return errorCode;
+        }
+
+        generated.push_back(path);
+        options.Inputs.push_back(path);
+    }
+
+    return 0;
+}
+
+
+/// <summary>Runs the pipeline once, with its report silenced.</summary>
+/// <param name="input">The input file.</param>
+/// <param name="output">The output file.</param>
+/// <param name="sortAlgorithm">The sort algorithm.</param>
+/// <param name="processOptions">The pipeline options; statistics on.</param>
+/// <param name="result">The outcome.</param>
+/// <returns>Exit/Error Code if less than 0.</returns>
+static int RunOnce(const std::string &input, const std::string &output, const Algorithms::SortAlgorithm sortAlgorithm,
+                   const ProcessOptions &processOptions, RunResult &result)
+{
+    auto processor = new ProcessInputFile(input, output, sortAlgorithm, processOptions);
+
+    const long long start     = Clock::Current().Now();
+    const auto      coutBuf   = std::cout.rdbuf(nullptr);
+    const int       errorCode = processor->Process();
+    std::cout.rdbuf(coutBuf);
+    std::cout.clear();
+    const long long elapsed   = Clock::Current().Now() - start;
+
+    if (errorCode >= 0)
+    {
+        LatencyHistogram latency;
+        processor->Statistics()->MergeStage(LatencyStage, latency);
+
+        result.Seconds = static_cast<double>(elapsed) / 1e9;
+        result.P50     = latency.ValueAtPercentile(50.0);
+        result.P99     = latency.ValueAtPercentile(99.0);
+        result.P999    = latency.ValueAtPercentile(99.9);
+        result.Max     = latency.Max();
+    }
+
+    delete processor;
+    return errorCode;
+}
+
+
+/// <summary>The command line name of a scheduler.</summary>
+/// <param name="scheduler">The scheduler.</param>
+static const char *SchedulerName(const SchedulerKind scheduler)
+{
+    switch (scheduler)
+    {
+    case WorkStealingScheduler: return "stealing";
+    case HeadOfLineScheduler:   return "hol";
+    default:                    return "queue";
+    }
+}
+
+
+/// <summary>Splits a comma separated list.</summary>
+/// <param name="value">The list.</param>
+/// <returns>The items; empty ones dropped.</returns>
+static std::vector<std::string> SplitList(const std::string &value)
+{
+    std::vector<std::string> items;
+    std::string::size_type   begin = 0;
+    while (begin <= value.size())
+    {
+        auto end = value.find(',', begin);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+
+        if (end > begin) {
+            items.push_back(value.substr(begin, end - begin));
+        }
+
+        begin = end + 1;
+    }
+
+    return items;
+}
+
+
+/// <summary>Output the progam usage information to stdout.</summary>
+/// <param name="argv">The argument vector.</param>
+static void Usage(char *argv[])
+{
+    std::cout << "Usage:" << std::endl
+              << argv[0] << " [options] [pathToInputFile ...]" << std::endl
+              << "    Without input files, a built-in suite is generated in the work directory." << std::endl
+              << "    [options]:" << std::endl
+              << "        --schedulers=<list>   Comma separated, each one of [" << SupportedSchedulers() << "] (default all)" << std::endl
+              << "        --algorithms=<list>   Comma separated, each one of [" << Algorithms::SupportedSortAlgorithms() << "] (default all)" << std::endl
+              << "        --threads=<list>      Comma separated thread counts (default 1,2,4,8)" << std::endl
+              << "        --runs=<n>            Runs of each combination; the median is reported (default 3)" << std::endl
+              << "        --lines=<n>           Lines in each generated input (default " << ProcessInputFile::MAX_LINES << ")" << std::endl
+              << "        --work-dir=<dir>      Where the generated inputs and the scratch output go (default .)" << std::endl
+              << "        --space-density=<p>   The chance of any one character of a generated input being a space (default 0)" << std::endl
+              << "        --virtual-time        Skip the sleeps; report simulated times (see VirtualClock)" << std::endl
+              << "        --keep                Keep the generated inputs" << std::endl
+              << "        --csv                 CSV rather than a table" << std::endl;
+}
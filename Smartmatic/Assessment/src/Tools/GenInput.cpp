@@ -0,0 +1,172 @@
+// =============================================================================================================================================
+// <copyright file="GenInput.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: GenInput
+//     File: GenInput.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 5:55 PM
+//  Purpose: Writes a synthetic input file for AssessmentMain: line count, length distribution, whitespace density,
+//           duplicate ratio and line-to-line similarity are all controlled, and the same seed gives the same file.
+//
+//              1.  E.g.:
+//                  ./GenInput  /path/to/InputFile --lines=10000 --max-length=100 --spaces=0.001 --seed=42
+// </summary>
+// =============================================================================================================================================
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "InputGenerator.h"
+
+
+// Local/Static Method prototypes:
+static int  CheckApplicationOptions(int argc, char *argv[], Tools::InputProfile &profile);
+static bool ToFraction(const std::string &value, double &fraction);
+static void Usage(char *argv[]);
+
+
+/// <summary>Main method.</summary>
+/// <param name="argc">The argument count.</param>
+/// <param name="argv">The argument vector.</param>
+/// <returns>Exit status</returns>
+int main(const int argc, char *argv[])
+{
+    // Do we have a correctly formatted command line?
+    if ((argc < 2) || (argv[1][0] == '-'))
+    {
+        Usage(argv);
+        exit(-1);
+    }
+
+    Tools::InputProfile profile;
+    int errorCode = CheckApplicationOptions(argc, argv, profile);
+    if (errorCode < 0) {
+        exit (errorCode);
+    }
+
+    Tools::InputGenerator generator(profile);
+    errorCode = generator.WriteFile(argv[1]);
+    if (errorCode < 0) {
+        exit (errorCode);
+    }
+
+    exit(0);
+}
+
+
+/// <summary>Checks the optional "--name=value" arguments following the output file.</summary>
+/// <param name="argc">The argument count.</param>
+/// <param name="argv">The argv.</param>
+/// <param name="profile">The input profile.</param>
+/// <returns>Exit/Error Code if less than 0.</returns>
+static int CheckApplicationOptions(const int argc, char *argv[], Tools::InputProfile &profile)
+{
+    for (auto i = 2; i < argc; ++i)
+    {
+        const std::string            argument = argv[i];
+        const std::string::size_type equals   = argument.find('=');
+        const std::string            name     = argument.substr(0, equals);
+        const std::string            value    = (equals != std::string::npos) ? argument.substr(equals + 1) : "";
+        const long                   number   = strtol(value.c_str(), nullptr, 10);
+
+        if ((name == "--lines") || (name == "--min-length") || (name == "--max-length"))
+        {
+            if ((number < 0) || value.empty() || (value.find_first_not_of("0123456789") != std::string::npos))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '" << name << "' needs a number, not '" << value << "'." << std::endl;
+                return -4;
+            }
+
+            auto &field = (name == "--lines") ? profile.Lines : (name == "--min-length") ? profile.MinLength : profile.MaxLength;
+            field = static_cast<int>(number);
+        }
+        else if (name == "--length-distribution")
+        {
+            if (!Tools::ToLengthDistribution(value, profile.Lengths))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Length distribution '" << value << "' is not available." << std::endl;
+                return -4;
+            }
+        }
+        else if ((name == "--spaces") || (name == "--duplicates") || (name == "--similarity"))
+        {
+            auto &field = (name == "--spaces") ? profile.SpaceDensity : (name == "--duplicates") ? profile.DuplicateRatio : profile.Similarity;
+            if (!ToFraction(value, field))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Option '" << name << "' needs a fraction from 0 to 1, not '" << value << "'." << std::endl;
+                return -4;
+            }
+        }
+        else if (name == "--seed")
+        {
+            if (value.empty() || (value.find_first_not_of("0123456789") != std::string::npos))
+            {
+                std::cerr << "Error:" << std::endl
+                          << "Seed '" << value << "' is not a number." << std::endl;
+                return -4;
+            }
+
+            profile.Seed = strtoull(value.c_str(), nullptr, 10);
+        }
+        else
+        {
+            std::cerr << "Error:" << std::endl
+                      << "Option '" << argument << "' is not recognized." << std::endl;
+            return -4;
+        }
+    }
+
+    if (profile.MinLength > profile.MaxLength)
+    {
+        std::cerr << "Error:" << std::endl
+                  << "The shortest line (" << profile.MinLength << ") is longer than the longest (" << profile.MaxLength << ")." << std::endl;
+        return -4;
+    }
+
+    return 0;
+}
+
+
+/// <summary>Parses a fraction from 0 to 1.</summary>
+/// <param name="value">The text.</param>
+/// <param name="fraction">The fraction, when valid.</param>
+/// <returns>true / false - depending upon success.</returns>
+static bool ToFraction(const std::string &value, double &fraction)
+{
+    char        *end    = nullptr;
+    const double parsed = strtod(value.c_str(), &end);
+    if (value.empty() || (*end != '\0') || (parsed < 0.0) || (parsed > 1.0)) {
+        return false;
+    }
+
+    fraction = parsed;
+    return true;
+}
+
+
+/// <summary>Output the progam usage information to stdout.</summary>
+/// <param name="argv">The argument vector.</param>
+static void Usage(char *argv[])
+{
+    const Tools::InputProfile defaults;
+
+    std::cout << "Usage:" << std::endl
+              << argv[0] << " <pathToOutputFile> [options]" << std::endl
+              << "    [options]:" << std::endl
+              << "        --lines=<n>                    Lines to write (default " << defaults.Lines << ")" << std::endl
+              << "        --min-length=<n>               Shortest line, in characters (default " << defaults.MinLength << ")" << std::endl
+              << "        --max-length=<n>               Longest line, in characters (default " << defaults.MaxLength << ")" << std::endl
+              << "        --length-distribution=<dist>   Line lengths, <dist>::= [" << Tools::SupportedLengthDistributions() << "]" << std::endl
+              << "        --spaces=<fraction>            Chance of each character being a space; each costs AssessmentMain a second" << std::endl
+              << "        --duplicates=<fraction>        Chance of a line repeating an earlier line" << std::endl
+              << "        --similarity=<fraction>        Chance of each character matching the line before" << std::endl
+              << "        --seed=<n>                     Random seed (default " << defaults.Seed << "); the same seed gives the same file" << std::endl;
+}
@@ -0,0 +1,275 @@
+// =============================================================================================================================================
+// <copyright file="IndexLookup.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: IndexLookup
+//     File: IndexLookup.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 10:05 PM
+//  Purpose: Prints the results of given input lines from an AssessmentMain output file, through its "--index" file:
+//           the index is memory-mapped, so each lookup is a seek, whatever the size of the output.
+//
+//              1.  E.g.:
+//                  ./IndexLookup  /path/to/OutputFile 17 4711 100000 --index=/path/to/OutputFile.idx
+// </summary>
+// =============================================================================================================================================
+
+#ifdef _MSC_VER
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "OutputIndex.h"
+
+
+/// <summary>A read-only memory mapping of a whole file.</summary>
+class MappedFile
+{
+private:
+    const char *_data;
+    size_t      _size;
+#ifdef _MSC_VER
+    HANDLE      _file;
+    HANDLE      _mapping;
+#endif
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="MappedFile"/> class, mapping the file.</summary>
+    /// <param name="path">The file.</param>
+    explicit MappedFile(const std::string &path)
+        : _data(nullptr),
+          _size(0)
+    {
+#ifdef _MSC_VER
+        _mapping = nullptr;
+        _file    = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size;
+        if ((_file == INVALID_HANDLE_VALUE) || !GetFileSizeEx(_file, &size) || (size.QuadPart == 0)) {
+            return;
+        }
+
+        _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (nullptr != _mapping)
+        {
+            _data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+            _size = (nullptr != _data) ? static_cast<size_t>(size.QuadPart) : 0;
+        }
+#else
+        const int descriptor = open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if ((descriptor >= 0) && (fstat(descriptor, &status) == 0) && (status.st_size > 0))
+        {
+            void *data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+            if (data != MAP_FAILED)
+            {
+                // A few lookups touch a few pages here and there: read-ahead around each would be wasted.
+                madvise(data, static_cast<size_t>(status.st_size), MADV_RANDOM);
+                _data = static_cast<const char *>(data);
+                _size = static_cast<size_t>(status.st_size);
+            }
+        }
+
+        // The mapping does not need the descriptor.
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+#endif
+    }
+
+
+    /// <summary>Finalizes an instance of the <see cref="MappedFile"/> class, unmapping the file.</summary>
+    ~MappedFile()
+    {
+#ifdef _MSC_VER
+        if (nullptr != _data) {
+            UnmapViewOfFile(_data);
+        }
+
+        if (nullptr != _mapping) {
+            CloseHandle(_mapping);
+        }
+
+        if (_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(_file);
+        }
+#else
+        if (nullptr != _data) {
+            munmap(const_cast<char *>(_data), _size);
+        }
+#endif
+    }
+
+
+    /// <summary>The mapped bytes; nullptr if the file could not be mapped.</summary>
+    const char *Data() const { return _data; }
+
+    /// <summary>The size of the file.</summary>
+    size_t Size() const { return _size; }
+
+
+    /// Block the copy constructor.
+    MappedFile(MappedFile &) = delete;
+
+    /// Block the copy assignment operator.
+    MappedFile operator =(MappedFile &) = delete;
+};
+
+
+// Local/Static Method prototypes:
+static int  CheckIndex(const MappedFile &index, const std::string &indexFile, uint64_t &lineCount);
+static void Usage(char *argv[]);
+
+
+/// <summary>Main method.</summary>
+/// <param name="argc">The argument count.</param>
+/// <param name="argv">The argument vector.</param>
+/// <returns>Exit status</returns>
+int main(const int argc, char *argv[])
+{
+    // Do we have a correctly formatted command line?
+    if ((argc < 3) || (argv[1][0] == '-'))
+    {
+        Usage(argv);
+        exit(-1);
+    }
+
+    const std::string     outputFile = argv[1];
+    std::string           indexFile  = OutputIndex::DefaultPath(outputFile);
+    std::vector<uint64_t> lineNumbers;
+    for (auto i = 2; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument.compare(0, 8, "--index=") == 0)
+        {
+            indexFile = argument.substr(8);
+            continue;
+        }
+
+        if (argument.empty() || (argument.find_first_not_of("0123456789") != std::string::npos))
+        {
+            std::cerr << "Error:" << std::endl
+                      << "Line number '" << argument << "' is not a number." << std::endl;
+            exit(-4);
+        }
+
+        lineNumbers.push_back(strtoull(argument.c_str(), nullptr, 10));
+    }
+
+    const MappedFile index(indexFile);
+    uint64_t         lineCount = 0;
+    int errorCode = CheckIndex(index, indexFile, lineCount);
+    if (errorCode < 0) {
+        exit(errorCode);
+    }
+
+    std::ifstream output(outputFile, std::ios::binary);
+    if (!output.is_open())
+    {
+        std::cerr << "Error opening output file '" << outputFile << "'." << std::endl;
+        exit(-12);
+    }
+
+    // Line N's result runs from offset [N - 1] to offset [N]; the last offset is where the output ends.
+    const auto *offsets = reinterpret_cast<const uint64_t *>(index.Data() + sizeof(OutputIndexHeader));
+    output.seekg(0, std::ios::end);
+    if (static_cast<uint64_t>(output.tellg()) != offsets[lineCount])
+    {
+        std::cerr << "Error: index file '" << indexFile << "' does not match output file '" << outputFile << "'." << std::endl;
+        exit(-16);
+    }
+
+    // One line of output per line number asked for.
+    std::string result;
+    for (const auto lineNumber : lineNumbers)
+    {
+        if ((lineNumber == 0) || (lineNumber > lineCount))
+        {
+            std::cerr << "Error:" << std::endl
+                      << "Line " << lineNumber << " is not in the index (1 to " << lineCount << ")." << std::endl;
+            exit(-5);
+        }
+
+        const uint64_t start = offsets[lineNumber - 1];
+        const uint64_t end   = offsets[lineNumber];
+        result.resize(static_cast<size_t>(end - start));
+        output.seekg(static_cast<std::streamoff>(start));
+        output.read(&result[0], static_cast<std::streamsize>(result.size()));
+        if (!output)
+        {
+            std::cerr << "Error reading output file '" << outputFile << "'." << std::endl;
+            exit(-12);
+        }
+
+        // The empty and erroneous lines, which have no output, print as empty lines.
+        if (result.empty() || (result.back() != '\n')) {
+            result += '\n';
+        }
+
+        std::cout << result;
+    }
+
+    exit(0);
+}
+
+
+/// <summary>Checks that a mapped file is a complete index.</summary>
+/// <param name="index">The mapped index file.</param>
+/// <param name="indexFile">The index file name.</param>
+/// <param name="lineCount">The number of lines indexed.</param>
+/// <returns>Exit/Error Code if less than 0.</returns>
+static int CheckIndex(const MappedFile &index, const std::string &indexFile, uint64_t &lineCount)
+{
+    if (nullptr == index.Data())
+    {
+        std::cerr << "Error opening index file '" << indexFile << "'." << std::endl;
+        return -16;
+    }
+
+    OutputIndexHeader header;
+    if (index.Size() >= sizeof(header)) {
+        memcpy(&header, index.Data(), sizeof(header));
+    }
+
+    if ((index.Size() < sizeof(header)) || (memcmp(header.Magic, OutputIndex::Magic(), sizeof(header.Magic)) != 0) ||
+        (header.Version != OutputIndex::VERSION))
+    {
+        std::cerr << "Error: '" << indexFile << "' is not an index file." << std::endl;
+        return -16;
+    }
+
+    // A run that did not finish leaves the flags 0.
+    if (((header.Flags & OutputIndex::FLAG_COMPLETE) == 0) || (index.Size() != sizeof(header) + (header.LineCount + 1) * sizeof(uint64_t)))
+    {
+        std::cerr << "Error: index file '" << indexFile << "' is incomplete." << std::endl;
+        return -16;
+    }
+
+    lineCount = header.LineCount;
+    return 0;
+}
+
+
+/// <summary>Output the progam usage information to stdout.</summary>
+/// <param name="argv">The argument vector.</param>
+static void Usage(char *argv[])
+{
+    std::cout << "Usage:" << std::endl
+              << argv[0] << " <pathToOutputFile> <lineNumber>... [--index=<pathToIndexFile>]" << std::endl
+              << "    Prints the result of each input line asked for, from an output file written with \"--index\"." << std::endl
+              << "    --index=<pathToIndexFile>::= the index file (default <pathToOutputFile>.idx)" << std::endl;
+}
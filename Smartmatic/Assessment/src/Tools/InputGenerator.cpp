@@ -0,0 +1,135 @@
+// =============================================================================================================================================
+// <copyright file="InputGenerator.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: GenInput, E2EBench
+//     File: InputGenerator.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 5:40 PM
+//  Purpose: Generates synthetic input files with a controlled shape, reproducibly from a seed.
+// </summary>
+// =============================================================================================================================================
+
+#include "InputGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+
+namespace Tools
+{
+    /// <summary>Initializes a new instance of the <see cref="InputGenerator"/> class.</summary>
+    /// <param name="profile">The shape of the input.</param>
+    InputGenerator::InputGenerator(const InputProfile &profile)
+        : _profile(profile),
+          _random(profile.Seed)
+    {
+        _profile.MinLength = std::max(_profile.MinLength, 0);
+        _profile.MaxLength = std::max(_profile.MaxLength, _profile.MinLength);
+    }
+
+
+    /// <summary>Generates the next line.</summary>
+    /// <returns>The line, without its line end.</returns>
+    const std::string &InputGenerator::NextLine()
+    {
+        if (!_lines.empty() && (NextUniform() < _profile.DuplicateRatio))
+        {
+            _lines.push_back(_lines[NextInt(0, static_cast<int>(_lines.size()) - 1)]);
+            return _lines.back();
+        }
+
+        const std::string previous = _lines.empty() ? std::string() : _lines.back();
+        const int         length   = NextLength();
+
+        std::string line;
+        line.reserve(length);
+        for (auto i = 0; i < length; ++i)
+        {
+            const bool similar = (i < static_cast<int>(previous.size())) && (NextUniform() < _profile.Similarity);
+            line += similar ? previous[i] : NextCharacter();
+        }
+
+        _lines.push_back(std::move(line));
+        return _lines.back();
+    }
+
+
+    /// <summary>Writes a whole input file.</summary>
+    /// <param name="path">The file.</param>
+    /// <returns>Error Code if less than 0.</returns>
+    int InputGenerator::WriteFile(const std::string &path)
+    {
+        std::ofstream stream(path, std::ios::out | std::ios::trunc);
+        if (!stream.is_open())
+        {
+            std::cerr << "Error opening output file '" << path << "'." << std::endl;
+            return -12;
+        }
+
+        for (auto i = 0; i < _profile.Lines; ++i) {
+            stream << NextLine() << '\n';
+        }
+
+        stream.close();
+        if (stream.fail())
+        {
+            std::cerr << "Error writing output file '" << path << "'." << std::endl;
+            return -12;
+        }
+
+        return 0;
+    }
+
+
+    /// <summary>A number in [0, 1).</summary>
+    double InputGenerator::NextUniform()
+    {
+        // The top 53 bits make an exact double.
+        return static_cast<double>(_random() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+
+    /// <summary>A number in [low, high].</summary>
+    /// <param name="low">The lowest.</param>
+    /// <param name="high">The highest.</param>
+    int InputGenerator::NextInt(const int low, const int high)
+    {
+        return std::min(high, low + static_cast<int>(NextUniform() * static_cast<double>(high - low + 1)));
+    }
+
+
+    /// <summary>The length of the next line.</summary>
+    int InputGenerator::NextLength()
+    {
+        if (_profile.Lengths == NormalLengths)
+        {
+            // Box-Muller.
+            const double mean     = (_profile.MinLength + _profile.MaxLength) / 2.0;
+            const double sigma    = (_profile.MaxLength - _profile.MinLength) / 6.0;
+            const double u        = 1.0 - NextUniform();
+            const double v        = NextUniform();
+            const double standard = std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * 3.14159265358979323846 * v);
+            const auto   length   = static_cast<int>(std::lround(mean + sigma * standard));
+            return std::min(std::max(length, _profile.MinLength), _profile.MaxLength);
+        }
+
+        return NextInt(_profile.MinLength, _profile.MaxLength);
+    }
+
+
+    /// <summary>A digit, or a space.</summary>
+    char InputGenerator::NextCharacter()
+    {
+        if (NextUniform() < _profile.SpaceDensity) {
+            return ' ';
+        }
+
+        return static_cast<char>('0' + NextInt(0, 9));
+    }
+}
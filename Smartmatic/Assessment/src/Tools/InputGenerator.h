@@ -0,0 +1,133 @@
+// =============================================================================================================================================
+// <copyright file="InputGenerator.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: GenInput, E2EBench
+//     File: InputGenerator.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 5:40 PM
+//  Purpose: Generates synthetic input files with a controlled shape, reproducibly from a seed.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _INPUT_GENERATOR_H
+#define _INPUT_GENERATOR_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace Tools
+{
+    /// <summary>How line lengths are distributed between the shortest and the longest.</summary>
+    enum LengthDistribution
+    {
+        UniformLengths = 0,
+
+        /// <summary>Centered between the shortest and the longest, three standard deviations either way.</summary>
+        NormalLengths
+    };
+
+
+    /// <summary>Returns the supported length distributions.</summary>
+    inline std::string SupportedLengthDistributions()
+    {
+        return "uniform | normal";
+    }
+
+
+    /// <summary>Translate the string to a length distribution.</summary>
+    /// <param name="distributionName">The distribution name.</param>
+    /// <param name="distribution">The distribution, when recognized.</param>
+    /// <returns>true / false - depending upon success.</returns>
+    inline bool ToLengthDistribution(const std::string &distributionName, LengthDistribution &distribution)
+    {
+        if (distributionName == "uniform") {
+            distribution = UniformLengths;
+            return true;
+        }
+
+        if (distributionName == "normal") {
+            distribution = NormalLengths;
+            return true;
+        }
+
+        return false;
+    }
+
+
+    /// <summary>The shape of a synthetic input file.</summary>
+    struct InputProfile
+    {
+        /// <summary>The number of lines.</summary>
+        int Lines = 10000;
+
+        /// <summary>The shortest line, in characters.</summary>
+        int MinLength = 1;
+
+        /// <summary>The longest line, in characters; the specification allows 100.</summary>
+        int MaxLength = 100;
+
+        /// <summary>How line lengths are distributed.</summary>
+        LengthDistribution Lengths = UniformLengths;
+
+        /// <summary>The chance of any one character being a space (each of which costs the pipeline a second).</summary>
+        double SpaceDensity = 0.0;
+
+        /// <summary>The chance of a line being an exact copy of an earlier line.</summary>
+        double DuplicateRatio = 0.0;
+
+        /// <summary>The chance of any one character of a new line being the same as in the line before it.</summary>
+        double Similarity = 0.0;
+
+        /// <summary>The random seed; the same profile and seed always produce the same file.</summary>
+        unsigned long long Seed = 1;
+    };
+
+
+    /// <summary>Generates the lines of a synthetic input file.</summary>
+    /// <remarks>
+    ///     Lines are made of digits and spaces, like the real input.  Only the raw std::mt19937_64 sequence is used,
+    ///     not the standard distributions, whose output differs between standard libraries; so a seed gives the same
+    ///     file on every platform.
+    /// </remarks>
+    class InputGenerator
+    {
+    private:
+        InputProfile             _profile;
+        std::mt19937_64          _random;
+        std::vector<std::string> _lines;   // Everything generated so far, for the duplicates.
+
+    public:
+
+        /// <summary>Initializes a new instance of the <see cref="InputGenerator"/> class.</summary>
+        /// <param name="profile">The shape of the input.</param>
+        explicit InputGenerator(const InputProfile &profile);
+
+        /// <summary>Generates the next line.</summary>
+        const std::string &NextLine();
+
+        /// <summary>Writes a whole input file.</summary>
+        int WriteFile(const std::string &path);
+
+    private:
+
+        /// <summary>A number in [0, 1).</summary>
+        double NextUniform();
+
+        /// <summary>A number in [low, high].</summary>
+        int NextInt(int low, int high);
+
+        /// <summary>The length of the next line.</summary>
+        int NextLength();
+
+        /// <summary>A digit, or a space.</summary>
+        char NextCharacter();
+    };
+}
+
+#endif  // _INPUT_GENERATOR_H
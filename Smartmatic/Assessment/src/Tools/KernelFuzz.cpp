@@ -0,0 +1,261 @@
+// =============================================================================================================================================
+// <copyright file="KernelFuzz.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: KernelFuzz
+//     File: KernelFuzz.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-20, 2:00 AM
+//  Purpose: Random comparison of the text kernels (CompactWhitespace, CountWhitespace, FormatItem, CountBytes), on every
+//           kernel set this processor has, against plain reference versions of what the pipeline did before them:
+//           isspace() in the "C" locale, "a,b,c\n" through a stream, and a byte-at-a-time histogram.
+//
+//           The items run up to three times MAX_CHARS, at every alignment, so that every vector block size, and every
+//           tail length, is covered; whitespace, bytes either side of it and bytes above 0x7F are over-represented.
+//           Nothing past the room each kernel is given may be written.  The generator is seeded: a failure reproduces.
+//
+//              1.  E.g.:
+//                  ./KernelFuzz --iterations=1000000 --seed=7
+// </summary>
+// =============================================================================================================================================
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Algorithms/TextKernels.h"
+#include "ProcessInputFile.h"
+
+
+static const size_t   MAX_ITEM_LENGTH = 3 * ProcessInputFile::MAX_CHARS;
+static const size_t   MAX_ALIGNMENT   = 32;
+static const size_t   GUARD_LENGTH    = 64;
+static const char     GUARD_BYTE      = '\xA5';
+static const uint64_t HISTOGRAM_START = 0x0123456789ULL;
+
+
+// Local/Static Method prototypes:
+static int         Fuzz(Algorithms::TextKernelSet kernelSet, long iterations, unsigned long seed);
+static bool        GuardIntact(const std::vector<char> &buffer, size_t from);
+static std::string KernelSetName(Algorithms::TextKernelSet kernelSet);
+static char        RandomByte(std::mt19937_64 &random);
+static void        Usage(char *argv[]);
+
+
+/// <summary>Main method.</summary>
+/// <param name="argc">The argument count.</param>
+/// <param name="argv">The argument vector.</param>
+/// <returns>Exit status</returns>
+int main(const int argc, char *argv[])
+{
+    long          iterations = 100000;
+    unsigned long seed       = 1;
+    for (auto i = 1; i < argc; ++i)
+    {
+        const std::string            argument = argv[i];
+        const std::string::size_type equals   = argument.find('=');
+        const std::string            name     = argument.substr(0, equals);
+        const std::string            value    = (equals != std::string::npos) ? argument.substr(equals + 1) : "";
+
+        if (name == "--iterations") {
+            iterations = strtol(value.c_str(), nullptr, 10);
+        }
+        else if (name == "--seed") {
+            seed = strtoul(value.c_str(), nullptr, 10);
+        }
+        else
+        {
+            Usage(argv);
+            exit(-1);
+        }
+
+        if ((name == "--iterations") && (iterations <= 0))
+        {
+            Usage(argv);
+            exit(-1);
+        }
+    }
+
+    int errorCode = 0;
+    for (const auto kernelSet : { Algorithms::ScalarKernels, Algorithms::Sse2Kernels, Algorithms::Avx2Kernels })
+    {
+        if (!Algorithms::SelectTextKernelSet(kernelSet))
+        {
+            std::cout << KernelSetName(kernelSet) << ": not available on this processor, skipped." << std::endl;
+            continue;
+        }
+
+        // Every kernel set sees the very same items.
+        const int result = Fuzz(kernelSet, iterations, seed);
+        if (result < 0) {
+            errorCode = result;
+        }
+        else {
+            std::cout << KernelSetName(kernelSet) << ": " << iterations << " items, no differences." << std::endl;
+        }
+    }
+
+    Algorithms::SelectTextKernelSet(Algorithms::BestTextKernelSet());
+    exit(errorCode);
+}
+
+
+/// <summary>Runs the kernels of the selected set over random items, and compares them with the reference versions.</summary>
+/// <param name="kernelSet">The kernel set selected; for the messages.</param>
+/// <param name="iterations">The number of items.</param>
+/// <param name="seed">The generator seed.</param>
+/// <returns>Error Code if less than 0: the first difference found.</returns>
+static int Fuzz(const Algorithms::TextKernelSet kernelSet, const long iterations, const unsigned long seed)
+{
+    std::mt19937_64   random(seed);
+    std::vector<char> source(MAX_ALIGNMENT + MAX_ITEM_LENGTH);
+    std::vector<char> output(Algorithms::FormattedItemLength(MAX_ITEM_LENGTH) + GUARD_LENGTH);
+
+    for (long n = 0; n < iterations; ++n)
+    {
+        const size_t alignment = static_cast<size_t>(random() % MAX_ALIGNMENT);
+        const size_t length    = static_cast<size_t>(random() % (MAX_ITEM_LENGTH + 1));
+        const char  *item      = source.data() + alignment;
+        for (size_t i = 0; i < length; ++i) {
+            source[alignment + i] = RandomByte(random);
+        }
+
+        // The reference versions.
+        std::string filtered;
+        size_t      whitespace = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (isspace(static_cast<unsigned char>(item[i]))) {
+                ++whitespace;
+            }
+            else {
+                filtered.push_back(item[i]);
+            }
+        }
+
+        std::ostringstream formatted;
+        for (size_t i = 0; i < length; ++i) {
+            formatted << ((i > 0) ? "," : "") << item[i];
+        }
+        formatted << '\n';
+
+        std::vector<uint64_t> histogram(256, HISTOGRAM_START);
+        for (size_t i = 0; i < length; ++i) {
+            ++histogram[static_cast<unsigned char>(item[i])];
+        }
+
+        // The kernels; each is given exactly the room it is documented to need, and the guard after it.
+        std::string failed;
+
+        std::fill(output.begin(), output.end(), GUARD_BYTE);
+        size_t       compactCount  = 0;
+        const size_t compactLength = Algorithms::CompactWhitespace(item, length, output.data(), compactCount);
+        if ((compactLength != filtered.size()) || (compactCount != whitespace) || (memcmp(output.data(), filtered.data(), compactLength) != 0) ||
+            !GuardIntact(output, length)) {
+            failed = "CompactWhitespace";
+        }
+        else if (Algorithms::CountWhitespace(item, length) != whitespace) {
+            failed = "CountWhitespace";
+        }
+
+        std::fill(output.begin(), output.end(), GUARD_BYTE);
+        const size_t formatLength = Algorithms::FormatItem(item, length, output.data());
+        if (failed.empty() && ((formatLength != formatted.str().size()) || (formatLength != Algorithms::FormattedItemLength(length)) ||
+                               (memcmp(output.data(), formatted.str().data(), formatLength) != 0) || !GuardIntact(output, formatLength))) {
+            failed = "FormatItem";
+        }
+
+        std::vector<uint64_t> counted(256, HISTOGRAM_START);
+        Algorithms::CountBytes(item, length, counted.data());
+        if (failed.empty() && (counted != histogram)) {
+            failed = "CountBytes";
+        }
+
+        if (!failed.empty())
+        {
+            std::cerr << "Error: " << KernelSetName(kernelSet) << " " << failed << " differs from the reference on item " << (n + 1)
+                      << " (length " << length << ", alignment " << alignment << ", seed " << seed << ")." << std::endl;
+            return -2;
+        }
+    }
+
+    return 0;
+}
+
+
+/// <summary>Whether nothing was written into the guard, from a given offset on.</summary>
+/// <param name="buffer">The output buffer.</param>
+/// <param name="from">Where the room given to the kernel ends.</param>
+/// <returns>true / false - as appropriate.</returns>
+static bool GuardIntact(const std::vector<char> &buffer, const size_t from)
+{
+    for (size_t i = from; i < buffer.size(); ++i)
+    {
+        if (buffer[i] != GUARD_BYTE) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/// <summary>The name of a kernel set, as "--kernels" takes it.</summary>
+/// <param name="kernelSet">The kernel set.</param>
+/// <returns>The name.</returns>
+static std::string KernelSetName(const Algorithms::TextKernelSet kernelSet)
+{
+    switch (kernelSet)
+    {
+        case Algorithms::Sse2Kernels:
+            return "sse2";
+
+        case Algorithms::Avx2Kernels:
+            return "avx2";
+
+        default:
+            return "scalar";
+    }
+}
+
+
+/// <summary>A random item byte; mostly printable, with the awkward ones over-represented.</summary>
+/// <param name="random">The generator.</param>
+/// <returns>The byte.</returns>
+static char RandomByte(std::mt19937_64 &random)
+{
+    // Whitespace, the bytes either side of '\t'..'\r' and of ' ', and NUL.
+    static const char AWKWARD[] = { ' ', '\t', '\n', '\v', '\f', '\r', '\x08', '\x0E', '\x1F', '!', '\0' };
+
+    const auto kind = random() % 8;
+    if (kind == 0) {
+        return AWKWARD[random() % sizeof(AWKWARD)];
+    }
+
+    if (kind == 1) {
+        return static_cast<char>(0x80 + (random() % 0x80));
+    }
+
+    return static_cast<char>(0x21 + (random() % 0x5E));
+}
+
+
+/// <summary>Output the progam usage information to stdout.</summary>
+/// <param name="argv">The argument vector.</param>
+static void Usage(char *argv[])
+{
+    std::cout << "Usage:" << std::endl
+              << argv[0] << " [--iterations=<n>] [--seed=<n>]" << std::endl
+              << "    Compares the text kernels of every kernel set this processor has with plain reference versions, on random items." << std::endl
+              << "    --iterations=<n>::= the number of random items (default 100000)" << std::endl
+              << "    --seed=<n>::= the generator seed (default 1)" << std::endl;
+}
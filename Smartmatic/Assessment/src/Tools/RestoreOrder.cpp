@@ -0,0 +1,152 @@
+// =============================================================================================================================================
+// <copyright file="RestoreOrder.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: RestoreOrder
+//     File: RestoreOrder.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 11:20 PM
+//  Purpose: Puts the records of an AssessmentMain "--unordered" output file back into input line order, and strips their
+//           line number tags: the result is what the same run would have written without "--unordered".
+//
+//              1.  E.g.:
+//                  ./RestoreOrder  /path/to/UnorderedOutputFile /path/to/OutputFile
+// </summary>
+// =============================================================================================================================================
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+/// <summary>Where a line's result is, within the unordered output.</summary>
+struct ResultSpan
+{
+    size_t Offset = 0;
+    size_t Length = 0;   // Including the line end; 0 for a line with no record.
+};
+
+
+// Local/Static Method prototypes:
+static int  PlaceRecords(const std::string &records, const std::string &unorderedFile, std::vector<ResultSpan> &spans);
+static void Usage(char *argv[]);
+
+
+/// <summary>Main method.</summary>
+/// <param name="argc">The argument count.</param>
+/// <param name="argv">The argument vector.</param>
+/// <returns>Exit status</returns>
+int main(const int argc, char *argv[])
+{
+    // Do we have a correctly formatted command line?
+    if ((argc != 3) || (argv[1][0] == '-'))
+    {
+        Usage(argv);
+        exit(-1);
+    }
+
+    const std::string unorderedFile = argv[1];
+    const std::string outputFile    = argv[2];
+
+    std::ifstream input(unorderedFile, std::ios::binary);
+    if (!input.is_open())
+    {
+        std::cerr << "Error opening input file '" << unorderedFile << "'." << std::endl;
+        exit(-11);
+    }
+
+    const std::string records((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    if (input.bad())
+    {
+        std::cerr << "Error reading input file '" << unorderedFile << "'." << std::endl;
+        exit(-11);
+    }
+
+    // The line numbers are dense: each record goes straight into its slot, no sort needed.
+    std::vector<ResultSpan> spans;
+    const int errorCode = PlaceRecords(records, unorderedFile, spans);
+    if (errorCode < 0) {
+        exit(errorCode);
+    }
+
+    std::ofstream output(outputFile, std::ios::binary | std::ios::trunc);
+    for (const auto &span : spans)
+    {
+        if (span.Length != 0) {
+            output.write(records.data() + span.Offset, static_cast<std::streamsize>(span.Length));
+        }
+    }
+
+    output.close();
+    if (output.fail())
+    {
+        std::cerr << "Error writing output file '" << outputFile << "'." << std::endl;
+        exit(-12);
+    }
+
+    exit(0);
+}
+
+
+/// <summary>Finds every "&lt;line number&gt;\t&lt;result&gt;\n" record, and puts it in its line's slot.</summary>
+/// <param name="records">The unordered output.</param>
+/// <param name="unorderedFile">The unordered output file name.</param>
+/// <param name="spans">The result of each line, by line number less 1.</param>
+/// <returns>Exit/Error Code if less than 0.</returns>
+static int PlaceRecords(const std::string &records, const std::string &unorderedFile, std::vector<ResultSpan> &spans)
+{
+    size_t position = 0;
+    while (position < records.size())
+    {
+        // The tag.
+        size_t lineNumber = 0;
+        size_t digits     = 0;
+        while ((position < records.size()) && (records[position] >= '0') && (records[position] <= '9') && (digits < 10))
+        {
+            lineNumber = lineNumber * 10 + static_cast<size_t>(records[position++] - '0');
+            ++digits;
+        }
+
+        const size_t lineEnd = records.find('\n', position);
+        if ((digits == 0) || (lineNumber == 0) || (position >= records.size()) || (records[position] != '\t') || (lineEnd == std::string::npos))
+        {
+            std::cerr << "Error: '" << unorderedFile << "' is not an unordered output file (at byte " << position << ")." << std::endl;
+            return -11;
+        }
+
+        // The result, line end included.
+        ++position;
+        if (lineNumber > spans.size()) {
+            spans.resize(lineNumber);
+        }
+
+        ResultSpan &span = spans[lineNumber - 1];
+        if (span.Length != 0)
+        {
+            std::cerr << "Error: '" << unorderedFile << "' has more than one record for line " << lineNumber << "." << std::endl;
+            return -11;
+        }
+
+        span.Offset = position;
+        span.Length = lineEnd + 1 - position;
+        position    = lineEnd + 1;
+    }
+
+    return 0;
+}
+
+
+/// <summary>Output the progam usage information to stdout.</summary>
+/// <param name="argv">The argument vector.</param>
+static void Usage(char *argv[])
+{
+    std::cout << "Usage:" << std::endl
+              << argv[0] << " <pathToUnorderedOutputFile> <pathToOutputFile>" << std::endl
+              << "    Writes the results of an output file written with \"--unordered\" in input line order, without their tags." << std::endl;
+}
@@ -0,0 +1,148 @@
+// =============================================================================================================================================
+// <copyright file="TraceRecorder.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: TraceRecorder.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 4:40 PM
+//   Purpose: Records the processing pipeline on a timeline, per thread, and writes it out in the Chrome trace event format ("--trace").
+// Reference: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU (Trace Event Format)
+// </summary>
+// =============================================================================================================================================
+
+#include "TraceRecorder.h"
+
+#include <fstream>
+#include <iomanip>
+
+
+/// <summary>Initializes a new instance of the <see cref="TraceBuffer"/> class.</summary>
+/// <param name="threadID">The thread's id in the trace.</param>
+/// <param name="threadName">The thread's name in the trace.</param>
+TraceBuffer::TraceBuffer(const int threadID, const std::string &threadName)
+    : _threadID(threadID),
+      _threadName(threadName),
+      _head(new Chunk())
+{
+    _tail = _head.get();
+}
+
+
+/// <summary>Finalizes an instance of the <see cref="TraceBuffer"/> class.</summary>
+TraceBuffer::~TraceBuffer()
+{
+    // _head owns the first chunk; the rest are only linked.
+    Chunk *chunk = _head->Next.load(std::memory_order_relaxed);
+    while (nullptr != chunk)
+    {
+        Chunk *next = chunk->Next.load(std::memory_order_relaxed);
+        delete chunk;
+        chunk = next;
+    }
+}
+
+
+/// <summary>Appends an event.  Owner only.</summary>
+/// <param name="event">The event.</param>
+void TraceBuffer::Append(const TraceEvent &event)
+{
+    int count = _tail->Count.load(std::memory_order_relaxed);
+    if (count == CHUNK_EVENTS)
+    {
+        auto chunk = new Chunk();
+        _tail->Next.store(chunk, std::memory_order_release);
+        _tail = chunk;
+        count = 0;
+    }
+
+    _tail->Events[count] = event;
+    _tail->Count.store(count + 1, std::memory_order_release);
+}
+
+
+/// <summary>Copies out every event published so far.  Any thread.</summary>
+/// <param name="events">Where to append the events.</param>
+void TraceBuffer::Snapshot(std::vector<TraceEvent> &events) const
+{
+    for (const Chunk *chunk = _head.get(); nullptr != chunk; chunk = chunk->Next.load(std::memory_order_acquire))
+    {
+        const int count = chunk->Count.load(std::memory_order_acquire);
+        events.insert(events.end(), chunk->Events, chunk->Events + count);
+    }
+}
+
+
+/// <summary>Registers a thread; the buffer lives as long as this recorder.</summary>
+/// <param name="threadName">The thread's name in the trace.</param>
+/// <returns>The thread's buffer.</returns>
+TraceBuffer *TraceRecorder::RegisterThread(const std::string &threadName)
+{
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+
+    _buffers.emplace_back(new TraceBuffer(static_cast<int>(_buffers.size()) + 1, threadName));
+    return _buffers.back().get();
+}
+
+
+/// <summary>Writes everything recorded so far to a file.</summary>
+/// <param name="fileName">The file name.</param>
+/// <returns>true / false - depending upon success.</returns>
+bool TraceRecorder::WriteChromeTrace(const std::string &fileName)
+{
+    std::ofstream stream(fileName);
+    if (!stream) {
+        return false;
+    }
+
+    // Microseconds since the start of the trace.
+    const auto timestamp = [this](const long long nanoseconds){ return static_cast<double>(nanoseconds - _startNanoseconds) / 1000.0; };
+
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+
+    stream << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+    stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"AssessmentMain\"}}";
+
+    std::vector<TraceEvent> events;
+    for (const auto &buffer : _buffers)
+    {
+        const int tid = buffer->ThreadID();
+        stream << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+               << ",\"args\":{\"name\":\"" << buffer->ThreadName() << "\"}}";
+
+        events.clear();
+        buffer->Snapshot(events);
+        for (const auto &event : events)
+        {
+            switch (event.Kind)
+            {
+            case TraceEvent::AsyncLineSpan:
+                // Begin and end are matched up by category and id; the category keeps the different waits of one line apart.
+                stream << "," << std::endl << "{\"name\":\"" << event.Name << "\",\"cat\":\"" << event.Name << "\",\"ph\":\"b\",\"id\":" << event.Line
+                       << ",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << timestamp(event.Begin) << ",\"args\":{\"line\":" << event.Line << "}}";
+                stream << "," << std::endl << "{\"name\":\"" << event.Name << "\",\"cat\":\"" << event.Name << "\",\"ph\":\"e\",\"id\":" << event.Line
+                       << ",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << timestamp(event.End) << "}";
+                break;
+
+            case TraceEvent::LineSpan:
+                stream << "," << std::endl << "{\"name\":\"" << event.Name << " " << event.Line << "\",\"cat\":\"line\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                       << tid << ",\"ts\":" << timestamp(event.Begin) << ",\"dur\":" << timestamp(event.End) - timestamp(event.Begin)
+                       << ",\"args\":{\"line\":" << event.Line << "}}";
+                break;
+
+            default:
+                stream << "," << std::endl << "{\"name\":\"" << event.Name << "\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                       << ",\"ts\":" << timestamp(event.Begin) << ",\"dur\":" << timestamp(event.End) - timestamp(event.Begin) << "}";
+                break;
+            }
+        }
+    }
+
+    stream << std::endl << "]}" << std::endl;
+    return !stream.fail();
+}
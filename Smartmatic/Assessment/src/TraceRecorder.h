@@ -0,0 +1,142 @@
+// =============================================================================================================================================
+// <copyright file="TraceRecorder.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: TraceRecorder.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 4:40 PM
+//   Purpose: Records the processing pipeline on a timeline, per thread, and writes it out in the Chrome trace event format ("--trace").
+// Reference: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU (Trace Event Format)
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _TRACE_RECORDER_H
+#define _TRACE_RECORDER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/// <summary>One recorded span.</summary>
+struct TraceEvent
+{
+    /// <summary>A span on the recording thread's own track, or a span of one line on that line's own (async) track.</summary>
+    enum EventKind : char { ThreadSpan = 'X', LineSpan = 'L', AsyncLineSpan = 'A' };
+
+    const char *Name;    // A string literal.
+    long long   Begin;   // PipelineStats::Now() nanoseconds.
+    long long   End;
+    int         Line;    // 0 when the span is not about one line.
+    EventKind   Kind;
+};
+
+
+/// <summary>The events recorded by one thread: an append-only list of chunks.</summary>
+/// <remarks>
+///     Only the owning thread appends, so appending takes no lock.  A chunk's event count is published with release
+///     semantics, and a new chunk is linked in the same way, so another thread may read everything published so far.
+/// </remarks>
+class TraceBuffer
+{
+public:
+    static const int CHUNK_EVENTS = 4096;
+
+private:
+
+    struct Chunk
+    {
+        TraceEvent           Events[CHUNK_EVENTS];
+        std::atomic<int>     Count;
+        std::atomic<Chunk *> Next;
+
+        Chunk() : Count(0), Next(nullptr) { }
+    };
+
+    const int              _threadID;
+    const std::string      _threadName;
+    std::unique_ptr<Chunk> _head;
+    Chunk                 *_tail;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="TraceBuffer"/> class.</summary>
+    TraceBuffer(int threadID, const std::string &threadName);
+
+    /// <summary>Finalizes an instance of the <see cref="TraceBuffer"/> class.</summary>
+    ~TraceBuffer();
+
+    int ThreadID() const { return _threadID; }
+
+    const std::string &ThreadName() const { return _threadName; }
+
+    /// <summary>Appends an event.  Owner only.</summary>
+    void Append(const TraceEvent &event);
+
+    /// <summary>Copies out every event published so far.  Any thread.</summary>
+    void Snapshot(std::vector<TraceEvent> &events) const;
+
+
+    /// Block the copy constructor.
+    TraceBuffer(TraceBuffer &) = delete;
+
+    /// Block the move constructor.
+    TraceBuffer(TraceBuffer &&) = delete;
+
+    /// Block the copy assignment operator.
+    TraceBuffer operator =(TraceBuffer &) = delete;
+
+    /// Block the move assignment operator.
+    TraceBuffer operator =(TraceBuffer &&) = delete;
+};
+
+
+/// <summary>Records the processing pipeline on a timeline, and writes it out in the Chrome trace event format.</summary>
+/// <remarks>
+///     Thread spans become complete ("X") events on their thread's track; line spans (time a line spent queued, or
+///     finished but waiting for its turn to be written, and time the output was held up behind a line) become async
+///     ("b"/"e") events with the line number as their id, so Perfetto shows each line's waits on a track of their own.
+/// </remarks>
+class TraceRecorder
+{
+private:
+    const long long                           _startNanoseconds;
+    std::mutex                                _buffersMutex;
+    std::vector<std::unique_ptr<TraceBuffer>> _buffers;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="TraceRecorder"/> class.</summary>
+    /// <param name="startNanoseconds">Time zero of the trace, in PipelineStats::Now() nanoseconds.</param>
+    explicit TraceRecorder(long long startNanoseconds)
+        : _startNanoseconds(startNanoseconds)
+    { }
+
+    /// <summary>Registers a thread; the buffer lives as long as this recorder.</summary>
+    TraceBuffer *RegisterThread(const std::string &threadName);
+
+    /// <summary>Writes everything recorded so far to a file.</summary>
+    /// <returns>true / false - depending upon success.</returns>
+    bool WriteChromeTrace(const std::string &fileName);
+
+
+    /// Block the copy constructor.
+    TraceRecorder(TraceRecorder &) = delete;
+
+    /// Block the move constructor.
+    TraceRecorder(TraceRecorder &&) = delete;
+
+    /// Block the copy assignment operator.
+    TraceRecorder operator =(TraceRecorder &) = delete;
+
+    /// Block the move assignment operator.
+    TraceRecorder operator =(TraceRecorder &&) = delete;
+};
+
+#endif  // _TRACE_RECORDER_H
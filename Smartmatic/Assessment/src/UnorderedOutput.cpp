@@ -0,0 +1,156 @@
+// =============================================================================================================================================
+// <copyright file="UnorderedOutput.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: UnorderedOutput.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 10:55 PM
+//  Purpose: "--unordered": writes per-line results, tagged with their line numbers, in whatever order they finish.
+// </summary>
+// =============================================================================================================================================
+
+#include "UnorderedOutput.h"
+
+#include <limits>
+
+
+const size_t UnorderedOutput::FLUSH_BYTES;
+
+
+// Every instance gets an ID of its own: a later one may well be allocated where an earlier one was.
+static std::atomic<uint64_t> s_nextOutputId(1);
+
+// The output (if any) that the current thread last completed a line for, and its buffer there.
+static thread_local uint64_t t_outputId = 0;
+static thread_local void    *t_buffer   = nullptr;
+
+
+/// <summary>Initializes a new instance of the <see cref="UnorderedOutput"/> class.</summary>
+/// <param name="stream">The output stream.</param>
+/// <param name="stats">Where to record the write stage; nullptr for none.</param>
+UnorderedOutput::UnorderedOutput(std::ostream &stream, PipelineStats *stats)
+    : _id(s_nextOutputId++),
+      _stream(stream),
+      _stats(stats),
+      _linesCompleted(0),
+      _linesAwaited(std::numeric_limits<int>::max())
+{
+    NameMutex(_streamMutex, "unordered output");
+}
+
+
+/// <summary>Completes a line: adds its record to the calling thread's buffer, and writes the buffer if it is full.</summary>
+/// <param name="lineNumber">The input line number.</param>
+/// <param name="text">The formatted result; empty for lines which produce no output.</param>
+/// <param name="readAt">When the line was read, for the end-to-end latency; 0 if unknown.</param>
+void UnorderedOutput::Complete(const int lineNumber, const std::string &text, const long long readAt)
+{
+    if (!text.empty())
+    {
+        ThreadBuffer *buffer = CurrentBuffer();
+        buffer->Records.append(std::to_string(lineNumber)).append(1, '\t').append(text);
+        if (buffer->Records.size() >= FLUSH_BYTES) {
+            WriteBuffer(*buffer);
+        }
+    }
+
+    if (nullptr != _stats) {
+        _stats->RecordLineLatency(readAt, PipelineStats::Now());
+    }
+
+    // The record is in its buffer before the line counts as completed.
+    const int linesCompleted = ++_linesCompleted;
+    if (linesCompleted >= _linesAwaited) {
+        _linesCompletedPublished.Store(linesCompleted);
+    }
+}
+
+
+/// <summary>Waits until <paramref name="lineCount" /> lines have been completed.</summary>
+/// <param name="lineCount">The line count.</param>
+void UnorderedOutput::WaitUntilCompleted(const int lineCount)
+{
+    // A line completed from here on either is seen by the check below, or sees the count awaited and wakes us.
+    _linesAwaited = lineCount;
+    if (_linesCompleted >= lineCount) {
+        return;
+    }
+
+    _linesCompletedPublished.WaitUntilAtLeast(lineCount);
+}
+
+
+/// <summary>Writes what is left in every buffer; once every line has been completed.</summary>
+void UnorderedOutput::Finish()
+{
+    // Lock will be released as soon as it goes out of scope.
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+
+    for (auto &buffer : _buffers)
+    {
+        if (!buffer->Records.empty()) {
+            WriteBuffer(*buffer);
+        }
+    }
+}
+
+
+/// <summary>The calling thread's buffer; registered on first use.</summary>
+/// <returns>The buffer.</returns>
+UnorderedOutput::ThreadBuffer *UnorderedOutput::CurrentBuffer()
+{
+    if (t_outputId == _id) {
+        return static_cast<ThreadBuffer *>(t_buffer);
+    }
+
+    // A thread of a pool shared between jobs may come back to us after working for another job.
+    const std::thread::id self = std::this_thread::get_id();
+    ThreadBuffer         *found = nullptr;
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_buffersMutex);
+
+        for (auto &buffer : _buffers)
+        {
+            if (buffer->Owner == self) {
+                found = buffer.get();
+            }
+        }
+
+        if (nullptr == found)
+        {
+            _buffers.emplace_back(new ThreadBuffer { self, std::string() });
+            found = _buffers.back().get();
+            found->Records.reserve(FLUSH_BYTES);
+        }
+    }
+
+    t_outputId = _id;
+    t_buffer = found;
+    return found;
+}
+
+
+/// <summary>Writes a buffer's records to the stream, and empties it.</summary>
+/// <param name="buffer">The buffer.</param>
+void UnorderedOutput::WriteBuffer(ThreadBuffer &buffer)
+{
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<pipeline_mutex_t> lock(_streamMutex);
+
+        StageScope writeScope(_stats, WriteStage);
+        _stream.write(buffer.Records.data(), static_cast<std::streamsize>(buffer.Records.size()));
+        _stream.flush();
+    }
+
+    if (nullptr != _stats) {
+        _stats->CountWritten(buffer.Records.size());
+    }
+
+    buffer.Records.clear();
+}
@@ -0,0 +1,113 @@
+// =============================================================================================================================================
+// <copyright file="UnorderedOutput.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: UnorderedOutput.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 10:55 PM
+//  Purpose: "--unordered": writes per-line results, tagged with their line numbers, in whatever order they finish.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _UNORDERED_OUTPUT_H
+#define _UNORDERED_OUTPUT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PipelineStats.h"
+#include "ProfiledMutex.h"
+#include "WaitWord.h"
+
+
+/// <summary>Writes per-line results, tagged with their line numbers, in whatever order they finish.</summary>
+/// <remarks>
+///     Every result goes out as a "&lt;line number&gt;\t&lt;result&gt;" record; lines which produce no output have no record.
+///     Each worker thread appends its records to a buffer of its own, and writes the whole buffer once it holds
+///     <see cref="FLUSH_BYTES"/>: no worker ever waits for another line, only (briefly) for another buffer's write.
+///     The RestoreOrder tool puts the records back into line order, when that is needed.
+/// </remarks>
+class UnorderedOutput
+{
+public:
+    static const size_t FLUSH_BYTES = 64 * 1024;
+
+private:
+
+    /// <summary>One worker thread's records, not yet written.</summary>
+    struct ThreadBuffer
+    {
+        std::thread::id Owner;
+        std::string     Records;
+    };
+
+    const uint64_t _id;
+    std::ostream  &_stream;
+    PipelineStats *_stats;
+
+    pipeline_mutex_t _streamMutex;
+
+    // Registered once per thread; only the owner touches a buffer's records until Finish().
+    std::mutex                                 _buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+
+    // Lines completed, with or without output; WaitUntilCompleted() is only woken once its count is reached.
+    std::atomic<int> _linesCompleted;
+    std::atomic<int> _linesAwaited;
+    WaitWord         _linesCompletedPublished;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="UnorderedOutput"/> class.</summary>
+    /// <param name="stream">The output stream.</param>
+    /// <param name="stats">Where to record the write stage; nullptr for none.</param>
+    explicit UnorderedOutput(std::ostream &stream, PipelineStats *stats = nullptr);
+
+    /// <summary>Completes a line: adds its record to the calling thread's buffer, and writes the buffer if it is full.</summary>
+    /// <param name="lineNumber">The input line number.</param>
+    /// <param name="text">The formatted result; empty for lines which produce no output.</param>
+    /// <param name="readAt">When the line was read, for the end-to-end latency; 0 if unknown.</param>
+    void Complete(int lineNumber, const std::string &text, long long readAt = 0);
+
+    /// <summary>Waits until <paramref name="lineCount" /> lines have been completed.</summary>
+    void WaitUntilCompleted(int lineCount);
+
+    /// <summary>Writes what is left in every buffer; once every line has been completed.</summary>
+    void Finish();
+
+    /// <summary>The number of lines completed.</summary>
+    int LinesCompleted() const { return _linesCompleted; }
+
+
+    /// Block the copy constructor.
+    UnorderedOutput(UnorderedOutput &) = delete;
+
+    /// Block the move constructor.
+    UnorderedOutput(UnorderedOutput &&) = delete;
+
+    /// Block the copy assignment operator.
+    UnorderedOutput operator =(UnorderedOutput &) = delete;
+
+    /// Block the move assignment operator.
+    UnorderedOutput operator =(UnorderedOutput &&) = delete;
+
+private:
+
+    /// <summary>The calling thread's buffer; registered on first use.</summary>
+    ThreadBuffer *CurrentBuffer();
+
+    /// <summary>Writes a buffer's records to the stream, and empties it.</summary>
+    void WriteBuffer(ThreadBuffer &buffer);
+};
+
+#endif  // _UNORDERED_OUTPUT_H
@@ -0,0 +1,110 @@
+// =============================================================================================================================================
+// <copyright file="WaitWord.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: WaitWord.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-20, 12:40 AM
+//  Purpose: A word that threads can wait on to change; a futex on Linux, a condition variable elsewhere.
+// </summary>
+// =============================================================================================================================================
+
+#ifdef __linux__
+#  include <climits>
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+#include "WaitWord.h"
+
+
+#ifdef __linux__
+/// <summary>The futex system call, on the word behind a std::atomic&lt;int&gt;; private to this process.</summary>
+static long Futex(std::atomic<int> &word, const int operation, const int value)
+{
+    static_assert(sizeof(std::atomic<int>) == sizeof(int), "A futex is a plain int.");
+    return syscall(SYS_futex, reinterpret_cast<int *>(&word), operation | FUTEX_PRIVATE_FLAG, value, nullptr, nullptr, 0);
+}
+#endif
+
+
+/// <summary>Sets the value, and wakes every waiter.</summary>
+/// <param name="value">The value.</param>
+void WaitWord::Store(const int value)
+{
+    _value.store(value, std::memory_order_seq_cst);
+    if (_waiters.load(std::memory_order_seq_cst) > 0) {
+        Wake(true);
+    }
+}
+
+
+/// <summary>Adds one to the value, and wakes one waiter, or all of them.</summary>
+/// <param name="wakeAll">Wake every waiter; otherwise, just one.</param>
+void WaitWord::Increment(const bool wakeAll)
+{
+    _value.fetch_add(1, std::memory_order_seq_cst);
+    if (_waiters.load(std::memory_order_seq_cst) > 0) {
+        Wake(wakeAll);
+    }
+}
+
+
+/// <summary>Waits for as long as the value is <paramref name="expected" />; may return early, so check again.</summary>
+/// <param name="expected">The value read before the caller's final check.</param>
+void WaitWord::WaitWhileEqual(const int expected)
+{
+    // Announce ourselves before the final look, so that a writer either sees us or we see its value.
+    _waiters.fetch_add(1, std::memory_order_seq_cst);
+
+#ifdef __linux__
+    // The kernel checks the word again, atomically with going to sleep; a change in between just returns.
+    if (_value.load(std::memory_order_seq_cst) == expected) {
+        Futex(_value, FUTEX_WAIT, expected);
+    }
+#else
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        _changedCV.wait(lock, [this, expected]{ return _value.load(std::memory_order_seq_cst) != expected; });
+    }
+#endif
+
+    _waiters.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+
+/// <summary>Waits until the value is at least <paramref name="target" />.</summary>
+/// <param name="target">The value to wait for.</param>
+void WaitWord::WaitUntilAtLeast(const int target)
+{
+    for (int value = Load(); value < target; value = Load()) {
+        WaitWhileEqual(value);
+    }
+}
+
+
+/// <summary>Wakes one waiter, or all of them; only called when somebody waits.</summary>
+/// <param name="wakeAll">Wake every waiter; otherwise, just one.</param>
+void WaitWord::Wake(const bool wakeAll)
+{
+#ifdef __linux__
+    Futex(_value, FUTEX_WAKE, wakeAll ? INT_MAX : 1);
+#else
+    // Taking the lock orders us after a waiter that is between its check and its wait.
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (wakeAll) {
+        _changedCV.notify_all();
+    }
+    else {
+        _changedCV.notify_one();
+    }
+#endif
+}
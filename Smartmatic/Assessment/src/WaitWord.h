@@ -0,0 +1,85 @@
+// =============================================================================================================================================
+// <copyright file="WaitWord.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: WaitWord.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-20, 12:40 AM
+//  Purpose: A word that threads can wait on to change; a futex on Linux, a condition variable elsewhere.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _WAIT_WORD_H
+#define _WAIT_WORD_H
+
+#include <atomic>
+
+#ifndef __linux__
+#  include <condition_variable>
+#  include <mutex>
+#endif
+
+
+/// <summary>A word that threads can wait on to change.</summary>
+/// <remarks>
+///     On Linux, a waiter sleeps in the kernel on the word itself (futex): no mutex is taken on either side, and a
+///     change nobody waits for costs no system call.  Elsewhere, a mutex and a condition variable stand in for the futex.
+///     Used two ways: as a counter that only goes up (lines written), waited on with <see cref="WaitUntilAtLeast"/>; and
+///     as an event count, whose value only says that something happened since it was read (an item pushed).
+/// </remarks>
+class WaitWord
+{
+private:
+    std::atomic<int> _value;
+    std::atomic<int> _waiters;
+
+#ifndef __linux__
+    std::mutex              _mutex;
+    std::condition_variable _changedCV;
+#endif
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="WaitWord"/> class.</summary>
+    /// <param name="value">The initial value.</param>
+    explicit WaitWord(const int value = 0) : _value(value), _waiters(0) { }
+
+    /// <summary>The value.</summary>
+    int Load() const { return _value.load(std::memory_order_acquire); }
+
+    /// <summary>Sets the value, and wakes every waiter.</summary>
+    void Store(int value);
+
+    /// <summary>Adds one to the value, and wakes one waiter, or all of them.</summary>
+    void Increment(bool wakeAll = true);
+
+    /// <summary>Waits for as long as the value is <paramref name="expected" />; may return early, so check again.</summary>
+    void WaitWhileEqual(int expected);
+
+    /// <summary>Waits until the value is at least <paramref name="target" />.</summary>
+    void WaitUntilAtLeast(int target);
+
+
+    /// Block the copy constructor.
+    WaitWord(WaitWord &) = delete;
+
+    /// Block the move constructor.
+    WaitWord(WaitWord &&) = delete;
+
+    /// Block the copy assignment operator.
+    WaitWord operator =(WaitWord &) = delete;
+
+    /// Block the move assignment operator.
+    WaitWord operator =(WaitWord &&) = delete;
+
+private:
+
+    /// <summary>Wakes one waiter, or all of them; only called when somebody waits.</summary>
+    void Wake(bool wakeAll);
+};
+
+#endif  // _WAIT_WORD_H
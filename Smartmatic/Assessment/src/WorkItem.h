@@ -17,9 +17,10 @@
 #define _WORK_ITEM_H
 
 #include <atomic>
-#include <memory>
+#include <cstring>
 #include <utility>
-#include <vector>
+
+#include "SlabArena.h"
 
 // Type prototypes:
 class ProcessInputFile;
@@ -29,21 +30,35 @@ class ProcessInputFile;
 ///     A work item tracker, including data, producer and consumer.
 ///     Single/unique possession of the item data is enforced.
 /// </summary>
+/// <remarks>
+///     Item data up to <see cref="INLINE_CAPACITY"/> bytes is stored inside the work item itself, so that an ordinary
+///     line needs no allocation at all; anything longer goes to the job's <see cref="SlabArena"/>.
+///     The serial number is assigned once, when the item is created for its line, and travels with the item.
+/// </remarks>
 class WorkItem
 {
 public:
     using consumer_t = void (*)(WorkItem&&);
-    using item_t     = std::vector<char>;
+
+    // Matches ProcessInputFile::MAX_CHARS, the longest line that is ever processed.
+    static const size_t INLINE_CAPACITY = 100;
 
 private:
 
     static std::atomic_int _serialNumberGenerator;
 
-    const int               _serialNumber;
-    int                     _inputID;
-    ProcessInputFile       *_producer;
-    consumer_t              _consumer;
-    std::unique_ptr<item_t> _itemData;
+    int               _serialNumber;
+    int               _inputID;
+    long long         _priority;
+    long long         _enqueuedAt;
+    long long         _outputOffset;
+    ProcessInputFile *_producer;
+    consumer_t        _consumer;
+
+    size_t     _length;
+    char      *_overflow;   // Item data too long for _inline, from _arena.
+    SlabArena *_arena;
+    char       _inline[INLINE_CAPACITY];
 
     static WorkItem *_empty;
 
@@ -54,11 +69,18 @@ public:
 
 
     /// <summary>Initializes a new instance of the <see cref="WorkItem"/> class.</summary>
+    /// <remarks>An empty placeholder, to be moved into; it does not use up a serial number.</remarks>
     WorkItem()
-      : _serialNumber(++_serialNumberGenerator),
+      : _serialNumber(0),
         _inputID(-1),
+        _priority(0),
+        _enqueuedAt(0),
+        _outputOffset(0),
         _producer(nullptr),
-        _consumer(nullptr)
+        _consumer(nullptr),
+        _length(0),
+        _overflow(nullptr),
+        _arena(nullptr)
     { }
 
 
@@ -66,14 +88,29 @@ public:
     /// <param name="inputID">The input identifier.</param>
     /// <param name="producer">The producer.</param>
     /// <param name="consumer">The consumer.</param>
-    /// <param name="itemData">The item.</param>
-    WorkItem(const int inputID, ProcessInputFile* producer, consumer_t consumer, item_t *itemData)
+    /// <param name="itemData">The item data; copied.</param>
+    /// <param name="length">The item data length.</param>
+    /// <param name="arena">Where to keep item data longer than <see cref="INLINE_CAPACITY"/>.</param>
+    WorkItem(const int inputID, ProcessInputFile* producer, consumer_t consumer, const char *itemData, const size_t length, SlabArena &arena)
         : _serialNumber(++_serialNumberGenerator),
           _inputID(inputID),
+          _priority(0),
+          _enqueuedAt(0),
+          _outputOffset(0),
           _producer(producer),
           _consumer(consumer),
-          _itemData(itemData)
-    { }
+          _length(length),
+          _overflow(nullptr),
+          _arena(nullptr)
+    {
+        if (_length > INLINE_CAPACITY)
+        {
+            _arena    = &arena;
+            _overflow = static_cast<char *>(_arena->Allocate(_length));
+        }
+
+        std::memcpy(MutableData(), itemData, _length);
+    }
 
 
     /// <summary>Copy constructor initializes a new instance of the <see cref="WorkItem"/> class.</summary>
@@ -84,12 +121,18 @@ public:
     /// <summary>Move constructor initializes a new instance of the <see cref="WorkItem"/> class.</summary>
     /// <param name="other">The other.</param>
     WorkItem(WorkItem && other) noexcept
-        : _serialNumber(++_serialNumberGenerator),
+        : _serialNumber(other._serialNumber),
           _inputID(other._inputID),
+          _priority(other._priority),
+          _enqueuedAt(other._enqueuedAt),
+          _outputOffset(other._outputOffset),
           _producer(other._producer),
           _consumer(other._consumer),
-          _itemData(std::move(other._itemData))
+          _length(0),
+          _overflow(nullptr),
+          _arena(nullptr)
     {
+        TakeItemData(other);
         other._inputID = -1;
     }
 
@@ -109,26 +152,36 @@ public:
             return *this;
         }
 
+        _serialNumber = other._serialNumber;
+
         _inputID  = other._inputID;
         other._inputID = -1;
 
-        _producer = other._producer;
-        _consumer = other._consumer;
+        _priority     = other._priority;
+        _enqueuedAt   = other._enqueuedAt;
+        _outputOffset = other._outputOffset;
+        _producer     = other._producer;
+        _consumer     = other._consumer;
 
-        _itemData = std::move(other._itemData);
+        ReleaseOverflow();
+        TakeItemData(other);
         return *this;
     }
 
     
     /// <summary>Finalizes an instance of the <see cref="WorkItem"/> class.</summary>
-    ~WorkItem() = default;
+    ~WorkItem()
+    {
+        ReleaseOverflow();
+    }
 
 
     /// <summary>Clears the item data.</summary>
     void ClearItemData()
     {
-        _inputID  = -1;
-        _itemData = nullptr;
+        _inputID = -1;
+        ReleaseOverflow();
+        _length = 0;
     }
 
     /// <summary>Returns the serial number of this instance.</summary>
@@ -147,6 +200,25 @@ public:
         return oldID;
     }
 
+    /// <summary>The scheduling priority; lower is more urgent.  See <see cref="PriorityBackend"/>.</summary>
+    long long Priority() const { return _priority; }
+
+    /// <summary>Sets the scheduling priority.</summary>
+    /// <param name="priority">The new priority; lower is more urgent.</param>
+    void Priority(const long long priority) { _priority = priority; }
+
+    /// <summary>When this instance was queued, for the statistics; see <see cref="PipelineStats::Now"/>.</summary>
+    long long EnqueuedAt() const { return _enqueuedAt; }
+
+    /// <summary>Sets when this instance was queued.</summary>
+    void EnqueuedAt(const long long enqueuedAt) { _enqueuedAt = enqueuedAt; }
+
+    /// <summary>Where the result goes in the output file; positional mode only, see <see cref="PositionalOutput"/>.</summary>
+    long long OutputOffset() const { return _outputOffset; }
+
+    /// <summary>Sets where the result goes in the output file.</summary>
+    void OutputOffset(const long long outputOffset) { _outputOffset = outputOffset; }
+
     /// <summary>The producer associated with this instance.</summary>
     ProcessInputFile *Producer() const { return _producer; }
 
@@ -155,12 +227,48 @@ public:
 
 
     /// <summary>Returns the item data associated with this instance.</summary>
-    /// <returns>Read-only instance yields read-only item.</returns>
-    const item_t &Item() const { return *_itemData; }
+    const char *Data() const { return (nullptr != _overflow) ? _overflow : _inline; }
+
+    /// <summary>Returns the length of the item data.</summary>
+    size_t Length() const { return _length; }
+
+private:
+
+    /// <summary>Returns the writable item data.</summary>
+    char *MutableData() { return (nullptr != _overflow) ? _overflow : _inline; }
+
+    /// <summary>Returns overflow item data to its arena.</summary>
+    void ReleaseOverflow()
+    {
+        if (nullptr != _overflow)
+        {
+            _arena->Deallocate(_overflow, _length);
+            _overflow = nullptr;
+            _arena    = nullptr;
+        }
+    }
+
+    /// <summary>Takes the item data of another instance, which must not hold any itself.</summary>
+    void TakeItemData(WorkItem &other)
+    {
+        _length   = other._length;
+        _overflow = other._overflow;
+        _arena    = other._arena;
+        if (nullptr == _overflow) {
+            std::memcpy(_inline, other._inline, _length);
+        }
 
-    ///// <summary>Returns the item data associated with this instance.</summary>
-    ///// <returns>Writable instance yields writable item.</returns>
-    //std::shared_ptr<item_t> Item() { return _itemData; }
+        other._length   = 0;
+        other._overflow = nullptr;
+        other._arena    = nullptr;
+    }
 };
 
+
+/// <summary>The priority of a work item in a <see cref="PriorityBackend"/> queue.</summary>
+inline long long QueuePriority(const WorkItem &workItem)
+{
+    return workItem.Priority();
+}
+
 #endif  // _WORK_ITEM_H
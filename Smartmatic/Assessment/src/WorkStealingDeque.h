@@ -0,0 +1,190 @@
+// =============================================================================================================================================
+// <copyright file="WorkStealingDeque.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: WorkStealingDeque.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 11:05 AM
+//   Purpose: The per-worker deque of a work-stealing scheduler.
+// Reference: Le, Pop, Cohen, Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _WORK_STEALING_DEQUE_H
+#define _WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+/// <summary>The per-worker deque of a work-stealing scheduler (Chase-Lev).</summary>
+/// <remarks>
+///     The owning worker pushes and pops at the bottom without taking any lock; other workers steal from the top with a
+///     single CAS.  Only the owner and a thief racing for the very last element ever contend.
+///     <typeparamref name="TElement" /> must be a pointer (or other lock-free atomic) type.  The circular array grows on
+///     demand; retired arrays are kept until the deque is destroyed, because a thief may still be reading one.
+/// </remarks>
+template<typename TElement> class WorkStealingDeque
+{
+public:
+    static const size_t INITIAL_CAPACITY = 64;
+    static const size_t CACHE_LINE_SIZE  = 64;
+
+private:
+
+    /// <summary>A power-of-two circular array of elements.</summary>
+    class CircularArray
+    {
+    private:
+        const size_t                           _mask;
+        std::unique_ptr<std::atomic<TElement>[]> _elements;
+
+    public:
+        explicit CircularArray(const size_t capacity)
+            : _mask(capacity - 1),
+              _elements(new std::atomic<TElement>[capacity])
+        { }
+
+        size_t Capacity() const { return _mask + 1; }
+
+        TElement Get(const int64_t index) const { return _elements[index & _mask].load(std::memory_order_relaxed); }
+
+        void Put(const int64_t index, TElement element) { _elements[index & _mask].store(element, std::memory_order_relaxed); }
+
+        /// <summary>A copy of the live range [top, bottom) into an array twice the size.</summary>
+        CircularArray *Grow(const int64_t top, const int64_t bottom) const
+        {
+            auto grown = new CircularArray(2 * Capacity());
+            for (auto i = top; i != bottom; ++i) {
+                grown->Put(i, Get(i));
+            }
+
+            return grown;
+        }
+    };
+
+    using pad_t = char[CACHE_LINE_SIZE];
+
+    pad_t                                        _pad0;
+    std::atomic<int64_t>                         _top;
+    pad_t                                        _pad1;
+    std::atomic<int64_t>                         _bottom;
+    std::atomic<CircularArray *>                 _array;
+    std::vector<std::unique_ptr<CircularArray>>  _arrays;   // Owns the current array and every retired one.
+    pad_t                                        _pad2;
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="WorkStealingDeque"/> class.</summary>
+    WorkStealingDeque()
+        : _pad0(),
+          _top(0),
+          _pad1(),
+          _bottom(0),
+          _array(nullptr),
+          _pad2()
+    {
+        _arrays.emplace_back(new CircularArray(INITIAL_CAPACITY));
+        _array.store(_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+
+    /// <summary>Determines whether this deque is empty.</summary>
+    /// <returns> true or false as appropriate; only a snapshot while other threads are active.</returns>
+    bool IsEmpty() const
+    {
+        return _bottom.load(std::memory_order_acquire) <= _top.load(std::memory_order_acquire);
+    }
+
+
+    /// <summary>Pushes an element at the bottom.  Owner only.</summary>
+    /// <param name="element">The element.</param>
+    void Push(TElement element)
+    {
+        const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        const int64_t top    = _top.load(std::memory_order_acquire);
+        CircularArray *array = _array.load(std::memory_order_relaxed);
+
+        if (bottom - top > static_cast<int64_t>(array->Capacity()) - 1)
+        {
+            _arrays.emplace_back(array->Grow(top, bottom));
+            array = _arrays.back().get();
+            _array.store(array, std::memory_order_release);
+        }
+
+        array->Put(bottom, element);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+
+    /// <summary>Pops the most recently pushed element from the bottom.  Owner only.</summary>
+    /// <param name="element">The element.</param>
+    /// <returns>true / false - depending upon success.</returns>
+    bool Pop(TElement &element)
+    {
+        const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        CircularArray *array = _array.load(std::memory_order_relaxed);
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            // Empty.
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        element = array->Get(bottom);
+        if (top == bottom)
+        {
+            // The last element; race any thief for it.
+            const bool won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        return true;
+    }
+
+
+    /// <summary>Steals the oldest element from the top.  Any thread.</summary>
+    /// <param name="element">The element.</param>
+    /// <returns>true / false - false when empty or when another thread won the race.</returns>
+    bool Steal(TElement &element)
+    {
+        int64_t top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return false;
+        }
+
+        const CircularArray *array = _array.load(std::memory_order_acquire);
+        element = array->Get(top);
+        return _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+
+    /// Block the copy constructor.
+    WorkStealingDeque(WorkStealingDeque &) = delete;
+
+    /// Block the move constructor.
+    WorkStealingDeque(WorkStealingDeque &&) = delete;
+
+    /// Block the copy assignment operator.
+    WorkStealingDeque operator =(WorkStealingDeque &) = delete;
+
+    /// Block the move assignment operator.
+    WorkStealingDeque operator =(WorkStealingDeque &&) = delete;
+};
+
+#endif  // _WORK_STEALING_DEQUE_H
@@ -0,0 +1,288 @@
+// =============================================================================================================================================
+// <copyright file="WorkStealingPool.cpp" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: WorkStealingPool.cpp
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 11:30 AM
+//  Purpose: A work-stealing thread pool; an alternative to a fixed set of ItemConsumer threads on one shared queue.
+// </summary>
+// =============================================================================================================================================
+
+#include "WorkStealingPool.h"
+
+#include <new>
+#include <utility>
+
+
+// The pool (if any) that the current thread works for, its index within that pool, and the group of the task it runs.
+static thread_local const WorkStealingPool      *t_pool        = nullptr;
+static thread_local int                          t_workerIndex = -1;
+static thread_local WorkStealingPool::TaskGroup *t_group       = nullptr;
+
+
+/// <summary>Initializes a new instance of the <see cref="WorkStealingPool"/> class.</summary>
+/// <param name="workerCount">The worker thread count.</param>
+WorkStealingPool::WorkStealingPool(const int workerCount)
+    : _sleepers(0),
+      _workEpoch(0),
+      _pendingTasks(0),
+      _runningTasks(0)
+{
+    _injected.ProfileAs("pool injection queue");
+
+    const int count = (workerCount > 0) ? workerCount : 1;
+    for (auto i = 0; i < count; ++i) {
+        _deques.emplace_back(new WorkStealingDeque<Task *>());
+    }
+
+    // The deques must all exist before the first worker starts looking for something to steal.
+    for (auto i = 0; i < count; ++i) {
+        _threads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+    }
+}
+
+
+/// <summary>Finalizes an instance of the <see cref="WorkStealingPool"/> class.</summary>
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_parkMutex);
+
+        _isRunning = false;
+        _parkCV.notify_all();
+    }
+
+    for (auto &thread : _threads) {
+        thread.join();
+    }
+
+    // Abandoned tasks.
+    Task *task;
+    while (_injected.TryPop(task)) {
+        DeleteTask(task);
+    }
+
+    for (auto &deque : _deques)
+    {
+        while (deque->Pop(task)) {
+            DeleteTask(task);
+        }
+    }
+}
+
+
+/// <summary>Submits a task from outside the pool (or from any thread).</summary>
+/// <param name="function">The task function.</param>
+/// <param name="context">The task context.</param>
+/// <param name="begin">The beginning of the task's index range.</param>
+/// <param name="end">The end (exclusive) of the task's index range.</param>
+/// <param name="group">The group to count the task in; nullptr for none.</param>
+void WorkStealingPool::Submit(const task_function_t function, void *context, const int begin, const int end, TaskGroup *group)
+{
+    Enqueue(NewTask(function, context, begin, end, group), -1);
+}
+
+
+/// <summary>Spawns a task onto the calling worker's own deque; from outside the pool, same as <see cref="Submit"/>.</summary>
+/// <param name="function">The task function.</param>
+/// <param name="context">The task context.</param>
+/// <param name="begin">The beginning of the task's index range.</param>
+/// <param name="end">The end (exclusive) of the task's index range.</param>
+void WorkStealingPool::Spawn(const task_function_t function, void *context, const int begin, const int end)
+{
+    const int workerIndex = CurrentWorkerIndex();
+    Enqueue(NewTask(function, context, begin, end, (workerIndex >= 0) ? t_group : nullptr), workerIndex);
+}
+
+
+/// <summary>Waits until every submitted and spawned task has finished.</summary>
+void WorkStealingPool::WaitForIdle()
+{
+    // Lock will be released as soon as it goes out of scope.
+    std::unique_lock<std::mutex> lock(_idleMutex);
+
+    _idleCV.wait(lock, [this]{ return _pendingTasks == 0; });
+}
+
+
+/// <summary>Waits until every task of a group has finished.</summary>
+/// <param name="group">The group.</param>
+void WorkStealingPool::Wait(TaskGroup &group)
+{
+    // Lock will be released as soon as it goes out of scope.
+    std::unique_lock<std::mutex> lock(group._idleMutex);
+
+    group._idleCV.wait(lock, [&group]{ return group._pendingTasks == 0; });
+}
+
+
+/// <summary>The index of the calling thread in this pool, or -1 for a thread outside the pool.</summary>
+int WorkStealingPool::CurrentWorkerIndex() const
+{
+    return (t_pool == this) ? t_workerIndex : -1;
+}
+
+
+/// <summary>Returns a task to the arena.</summary>
+/// <param name="task">The task; run, or abandoned.</param>
+void WorkStealingPool::DeleteTask(Task *task)
+{
+    task->~Task();
+    _taskArena.Deallocate(task, sizeof(Task));
+}
+
+
+/// <summary>Queues a task: on the calling worker's own deque, or on the injection queue.</summary>
+/// <param name="task">The task.</param>
+/// <param name="workerIndex">The calling worker's index, or -1 for the injection queue.</param>
+void WorkStealingPool::Enqueue(Task *task, const int workerIndex)
+{
+    ++_pendingTasks;
+    if (nullptr != task->Group) {
+        ++task->Group->_pendingTasks;
+    }
+
+    if (workerIndex < 0) {
+        _injected.Push(std::move(task));
+    }
+    else {
+        _deques[workerIndex]->Push(task);
+    }
+
+    NotifyWork();
+}
+
+
+/// <summary>Finds the next task for a worker: own deque, then the injection queue, then steal.</summary>
+/// <param name="workerIndex">The worker index.</param>
+/// <returns>The task, or nullptr if there is nothing to do.</returns>
+WorkStealingPool::Task *WorkStealingPool::FindTask(const int workerIndex)
+{
+    Task *task;
+    if (_deques[workerIndex]->Pop(task)) {
+        return task;
+    }
+
+    if (_injected.TryPop(task)) {
+        return task;
+    }
+
+    // Start with the next worker over, so that the thieves spread out.
+    const int count = WorkerCount();
+    for (auto offset = 1; offset < count; ++offset)
+    {
+        if (_deques[(workerIndex + offset) % count]->Steal(task)) {
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+
+/// <summary>Makes a task, from the arena.</summary>
+/// <param name="function">The task function.</param>
+/// <param name="context">The task context.</param>
+/// <param name="begin">The beginning of the task's index range.</param>
+/// <param name="end">The end (exclusive) of the task's index range.</param>
+/// <param name="group">The group to count the task in; nullptr for none.</param>
+/// <returns>The task.</returns>
+WorkStealingPool::Task *WorkStealingPool::NewTask(const task_function_t function, void *context, const int begin, const int end,
+                                                  TaskGroup *group)
+{
+    return new (_taskArena.Allocate(sizeof(Task))) Task { function, context, begin, end, group };
+}
+
+
+/// <summary>Announces new work to parked workers.</summary>
+void WorkStealingPool::NotifyWork()
+{
+    ++_workEpoch;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleepers > 0)
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_parkMutex);
+
+        _parkCV.notify_one();
+    }
+}
+
+
+/// <summary>Runs and retires a task.</summary>
+/// <param name="task">The task.</param>
+void WorkStealingPool::RunTask(Task *task)
+{
+    TaskGroup *group = task->Group;
+
+    ++_runningTasks;
+    t_group = group;
+    task->Function(*this, task->Context, task->Begin, task->End);
+    t_group = nullptr;
+    --_runningTasks;
+    DeleteTask(task);
+
+    // The group's owner may be gone as soon as it sees the group finished; it is not touched again after that.
+    if (nullptr != group)
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(group->_idleMutex);
+
+        if (--group->_pendingTasks == 0) {
+            group->_idleCV.notify_all();
+        }
+    }
+
+    if (--_pendingTasks == 0)
+    {
+        // Lock will be released as soon as it goes out of scope.
+        std::lock_guard<std::mutex> lock(_idleMutex);
+
+        _idleCV.notify_all();
+    }
+}
+
+
+/// <summary>The worker thread main loop.</summary>
+/// <param name="workerIndex">The worker index.</param>
+void WorkStealingPool::WorkerLoop(const int workerIndex)
+{
+    t_pool        = this;
+    t_workerIndex = workerIndex;
+
+    while (_isRunning)
+    {
+        Task *task = FindTask(workerIndex);
+        if (nullptr != task)
+        {
+            RunTask(task);
+            continue;
+        }
+
+        // Nothing to do; park until somebody announces new work.
+        // Announce ourselves before the final look, so that a spawner either sees us or we see its task.
+        std::unique_lock<std::mutex> lock(_parkMutex);
+
+        const unsigned epoch = _workEpoch;
+        ++_sleepers;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        task = FindTask(workerIndex);
+        if (nullptr == task) {
+            _parkCV.wait(lock, [this, epoch]{ return !_isRunning || (_workEpoch != epoch); });
+        }
+
+        --_sleepers;
+        lock.unlock();
+
+        if (nullptr != task) {
+            RunTask(task);
+        }
+    }
+}
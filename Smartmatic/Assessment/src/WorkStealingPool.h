@@ -0,0 +1,172 @@
+// =============================================================================================================================================
+// <copyright file="WorkStealingPool.h" company="Lake Manor Consulting">
+//    Copyright  2018-2026 Lake Manor Consulting
+//    All Rights Reserved.
+// </copyright>
+// <summary>
+// Solution: Smartmatic Assessment
+//  Project: AssessmentMain
+//     File: WorkStealingPool.h
+//   Author: Ron W Moore (webbtrail@gmail.com)
+//  Created: 2026-10-19, 11:30 AM
+//  Purpose: A work-stealing thread pool; an alternative to a fixed set of ItemConsumer threads on one shared queue.
+// </summary>
+// =============================================================================================================================================
+
+#ifndef _WORK_STEALING_POOL_H
+#define _WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentQueue.h"
+#include "SlabArena.h"
+#include "WorkStealingDeque.h"
+
+
+/// <summary>A work-stealing thread pool.</summary>
+/// <remarks>
+///     Every worker owns a <see cref="WorkStealingDeque"/>.  A task spawned from inside a worker goes onto that worker's
+///     own deque, where the worker will pop it next (LIFO, cache-warm); idle workers steal the oldest task (FIFO) from
+///     somebody else's deque.  Tasks submitted from outside the pool go through a shared injection queue.
+///     A task is a function pointer plus a context and an index range, so that a task can split itself: spawn the upper
+///     half of its range for the thieves, and carry on with the lower half.  Tasks come from a slab arena of the pool's
+///     own, so that spawning one allocates nothing in steady state.
+///     Several jobs can share one pool: each submits its tasks in a <see cref="TaskGroup"/> of its own, and waits for
+///     that, rather than for the whole pool.
+/// </remarks>
+class WorkStealingPool
+{
+public:
+    using task_function_t = void (*)(WorkStealingPool &pool, void *context, int begin, int end);
+
+    /// <summary>A set of tasks that can be waited for on its own; one job's tasks, on a pool shared between jobs.</summary>
+    /// <remarks>A spawned task joins the group of the task that spawned it.</remarks>
+    class TaskGroup
+    {
+    private:
+        friend class WorkStealingPool;
+
+        std::atomic<int>        _pendingTasks;
+        std::mutex              _idleMutex;
+        std::condition_variable _idleCV;
+
+    public:
+        TaskGroup() : _pendingTasks(0) { }
+
+        /// Block the copy constructor.
+        TaskGroup(TaskGroup &) = delete;
+
+        /// Block the copy assignment operator.
+        TaskGroup operator =(TaskGroup &) = delete;
+    };
+
+private:
+
+    /// <summary>A unit of work.</summary>
+    struct Task
+    {
+        task_function_t Function;
+        void           *Context;
+        int             Begin;
+        int             End;
+        TaskGroup      *Group;
+    };
+
+    std::atomic<bool> _isRunning = ATOMIC_VAR_INIT(true);
+
+    SlabArena _taskArena;   // Every Task comes from here, and goes back here once run.
+
+    std::vector<std::unique_ptr<WorkStealingDeque<Task *>>> _deques;
+    ConcurrentQueue<Task *>                                 _injected;
+
+    // Parking of idle workers.
+    std::mutex              _parkMutex;
+    std::condition_variable _parkCV;
+    std::atomic<int>        _sleepers;
+    std::atomic<unsigned>   _workEpoch;
+
+    // Tracking of outstanding tasks, for WaitForIdle(); and of running ones, for progress reports.
+    std::atomic<int>        _pendingTasks;
+    std::atomic<int>        _runningTasks;
+    std::mutex              _idleMutex;
+    std::condition_variable _idleCV;
+
+    std::vector<std::thread> _threads;  // Has to be initialized last.
+
+public:
+
+    /// <summary>Initializes a new instance of the <see cref="WorkStealingPool"/> class.</summary>
+    /// <param name="workerCount">The worker thread count.</param>
+    explicit WorkStealingPool(int workerCount);
+
+    /// <summary>Finalizes an instance of the <see cref="WorkStealingPool"/> class.</summary>
+    /// <remarks>Tasks that have not started yet are abandoned; call <see cref="WaitForIdle"/> first to finish them.</remarks>
+    ~WorkStealingPool();
+
+    /// <summary>The worker thread count.</summary>
+    int WorkerCount() const { return static_cast<int>(_deques.size()); }
+
+    /// <summary>The tasks submitted or spawned, and not yet finished.</summary>
+    int PendingTasks() const { return _pendingTasks; }
+
+    /// <summary>The tasks running right now; that is, the busy workers.</summary>
+    int RunningTasks() const { return _runningTasks; }
+
+    /// <summary>Submits a task from outside the pool (or from any thread).</summary>
+    void Submit(task_function_t function, void *context, int begin, int end, TaskGroup *group = nullptr);
+
+    /// <summary>Spawns a task onto the calling worker's own deque; from outside the pool, same as <see cref="Submit"/>.</summary>
+    void Spawn(task_function_t function, void *context, int begin, int end);
+
+    /// <summary>Waits until every submitted and spawned task has finished.</summary>
+    void WaitForIdle();
+
+    /// <summary>Waits until every task of a group has finished.</summary>
+    void Wait(TaskGroup &group);
+
+    /// <summary>The index of the calling thread in this pool, or -1 for a thread outside the pool.</summary>
+    int CurrentWorkerIndex() const;
+
+
+    /// Block the copy constructor.
+    WorkStealingPool(WorkStealingPool &) = delete;
+
+    /// Block the move constructor.
+    WorkStealingPool(WorkStealingPool &&) = delete;
+
+    /// Block the copy assignment operator.
+    WorkStealingPool operator =(WorkStealingPool &) = delete;
+
+    /// Block the move assignment operator.
+    WorkStealingPool operator =(WorkStealingPool &&) = delete;
+
+private:
+
+    /// <summary>Returns a task to the arena.</summary>
+    void DeleteTask(Task *task);
+
+    /// <summary>Queues a task: on the calling worker's own deque, or on the injection queue.</summary>
+    void Enqueue(Task *task, int workerIndex);
+
+    /// <summary>Finds the next task for a worker: own deque, then the injection queue, then steal.</summary>
+    Task *FindTask(int workerIndex);
+
+    /// <summary>Makes a task, from the arena.</summary>
+    Task *NewTask(task_function_t function, void *context, int begin, int end, TaskGroup *group);
+
+    /// <summary>Announces new work to parked workers.</summary>
+    void NotifyWork();
+
+    /// <summary>Runs and retires a task.</summary>
+    void RunTask(Task *task);
+
+    /// <summary>The worker thread main loop.</summary>
+    void WorkerLoop(int workerIndex);
+};
+
+#endif  // _WORK_STEALING_POOL_H